@@ -0,0 +1,33 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/**
+ * @brief Counting replacement for the global operator new/delete
+ *
+ * Include from exactly one translation unit of a benchmark program (each
+ * file in bench/ is its own program); the replacements apply process-wide.
+ * Read heap_allocations before and after the code under test.
+ */
+static std::atomic<uint64_t> heap_allocations{0};
+
+void* operator new(size_t size) {
+    heap_allocations++;
+    if (void* p = malloc(size > 0 ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) {
+    heap_allocations++;
+    if (void* p = malloc(size > 0 ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+#endif // ALLOC_COUNTER_H
@@ -0,0 +1,215 @@
+/**
+ * @file bench_capture_spool.cpp
+ * @brief Capture spool append and replay-read throughput, no MongoDB needed
+ *
+ * Usage: bench_capture_spool [documents] [sync batches] [spool path] [formats]
+ *
+ * Appends the same capture document (two faces, built by
+ * MongoDBHandler::buildFaceDocument) to a fresh spool file (default
+ * /tmp/facemesh_bench.spool) once per fsync batch size (default
+ * "1,8,32,128"; 1 syncs after every record) and reports appends/second,
+ * append latency, fsync count and fsync latency. Each run then reads the
+ * spool back in batches of 64, as the replayer does before insert_many,
+ * and commits it, which truncates the file.
+ *
+ * A recovery pass then damages a spool on purpose: it commits part of it,
+ * flips a byte inside one later record and appends a torn record, and
+ * checks that reopening resumes at the saved offset, keeps the records
+ * behind the damaged one, cuts only the torn tail, and that the replay
+ * moves the damaged record to ".corrupt" and a refused one to ".rejected".
+ * Exits 1 if a run did not read back every document it appended or a
+ * recovery check failed.
+ */
+
+#include "bench_common.h"
+#include "../src/headers/capture_spool.h"
+#include "../src/headers/mongodb_handler.h"
+#include <cstdio>
+
+static void removeSpool(const string& path) {
+    for (const char* suffix : {"", ".offset", ".rejected", ".corrupt"}) {
+        remove((path + suffix).c_str());
+    }
+}
+
+static long fileSize(const string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return -1;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+static bool recoveryPass(const string& path, bsoncxx::document::view document) {
+    const size_t records = 20;
+    const size_t committed = 5;      // Replayed before the "crash"
+    const size_t damaged = 12;       // Record whose document gets a flipped byte
+    const char torn[] = "torn-record";
+    long record_size = 8 + static_cast<long>(document.length());
+    bool passed = true;
+    auto check = [&passed](const string& label, bool ok) {
+        cout << "  " << (ok ? "✅ " : "❌ ") << label << endl;
+        passed = passed && ok;
+    };
+    
+    removeSpool(path);
+    SpoolConfig config;
+    config.path = path;
+    {
+        CaptureSpool spool(config);
+        if (!spool.open()) return false;
+        for (size_t i = 0; i < records; i++) spool.append(document);
+        vector<bsoncxx::document::value> batch;
+        uint64_t next_offset = 0;
+        spool.readBatch(committed, batch, next_offset);
+        spool.commit(next_offset, batch.size());
+    }
+    
+    // Damage the closed file the way a bad sector and a crash mid-append would
+    FILE* file = fopen(path.c_str(), "r+b");
+    if (!file) return false;
+    fseek(file, record_size * static_cast<long>(damaged) + 8 + record_size / 2, SEEK_SET);
+    int byte = fgetc(file);
+    fseek(file, -1, SEEK_CUR);
+    fputc(byte ^ 0xff, file);
+    fseek(file, 0, SEEK_END);
+    fwrite(torn, 1, sizeof(torn) - 1, file);
+    fclose(file);
+    
+    CaptureSpool spool(config);
+    check("reopens the damaged spool", spool.open());
+    SpoolStats opened = spool.getStats();
+    check("resumes at the saved offset, skipping the damaged record (" + to_string(opened.recovered) + " pending)",
+          opened.recovered == records - committed - 1);
+    check("cuts only the torn tail (" + to_string(opened.truncated_bytes) + " bytes)",
+          opened.truncated_bytes == sizeof(torn) - 1);
+    
+    // Replay as SpoolReplayer::drain does, refusing the first document of the first batch
+    vector<bsoncxx::document::value> batch;
+    uint64_t next_offset = 0;
+    size_t read_back = 0;
+    bool rejected = false;
+    while (true) {
+        bool intact = spool.readBatch(4, batch, next_offset);
+        if (batch.empty()) {
+            uint64_t skipped = 0;
+            if (intact || !spool.skipCorrupt(skipped)) break;
+            continue;
+        }
+        if (!rejected) rejected = spool.reject(batch[0].view());
+        read_back += batch.size();
+        spool.commit(next_offset, batch.size());
+    }
+    SpoolStats replayed = spool.getStats();
+    check("replays every intact record (" + to_string(read_back) + ")", read_back == records - committed - 1);
+    check("moves the damaged record to .corrupt", replayed.corrupt_bytes == static_cast<uint64_t>(record_size) &&
+          fileSize(path + ".corrupt") == record_size);
+    check("copies the refused document to .rejected", replayed.rejected == 1 &&
+          fileSize(path + ".rejected") == record_size);
+    check("truncates the spool once it is replayed", spool.getPendingRecords() == 0 && fileSize(path) == 0);
+    
+    spool.close();
+    removeSpool(path);
+    return passed;
+}
+
+int main(int argc, char** argv) {
+    int documents = argc > 1 ? max(1, atoi(argv[1])) : 5000;
+    vector<size_t> sync_batches;
+    for (const auto& item : Bench::splitList(argc > 2 ? argv[2] : "1,8,32,128")) {
+        if (atoi(item.c_str()) > 0) sync_batches.push_back(static_cast<size_t>(atoi(item.c_str())));
+    }
+    string path = argc > 3 ? argv[3] : "/tmp/facemesh_bench.spool";
+    
+    vector<FaceDocumentFormat> formats;
+    for (const auto& name : Bench::splitList(argc > 4 ? argv[4] : "expanded,compact")) {
+        FaceDocumentFormat format;
+        if (!faceDocumentFormatFromName(name, format)) {
+            cerr << "❌ Unknown face format: " << name << endl;
+            return 1;
+        }
+        formats.push_back(format);
+    }
+    
+    // Only builds documents; the connection is never used, so no server is contacted
+    MongoDBHandler database("mongodb://localhost:27017");
+    FaceList faces = Bench::sampleFaces();
+    bool complete = true;
+    
+    cout << "💾 Capture spool: " << documents << " documents per run | " << path << endl;
+    
+    for (FaceDocumentFormat format : formats) {
+        database.setFaceFormat(format);
+        auto document = database.buildFaceDocument(faces, "facemesh_bench.jpg", "Pikachu", "pikachu_mask.png");
+        size_t bytes = document.view().length();
+        cout << "\n  ── " << faceDocumentFormatName(format) << " (" << bytes << " bytes) ──" << endl;
+        
+        for (size_t sync_batch : sync_batches) {
+            removeSpool(path);
+            
+            SpoolConfig config;
+            config.path = path;
+            config.sync_records = sync_batch;
+            config.sync_interval = chrono::hours(1);   // Only the record count triggers fsync
+            CaptureSpool spool(config);
+            if (!spool.open()) {
+                cerr << "❌ Cannot create spool " << path << endl;
+                return 1;
+            }
+            
+            vector<double> append_ms;
+            append_ms.reserve(documents);
+            size_t appended = 0;
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < documents; i++) {
+                auto begin = chrono::steady_clock::now();
+                if (spool.append(document.view())) appended++;
+                append_ms.push_back(Bench::elapsedMs(begin));
+            }
+            spool.sync();
+            double append_wall_ms = Bench::elapsedMs(start);
+            SpoolStats stats = spool.getStats();
+            
+            // Read back the way the replayer does, committing each batch
+            vector<bsoncxx::document::value> batch;
+            uint64_t next_offset = 0;
+            size_t read_back = 0;
+            start = chrono::steady_clock::now();
+            while (spool.readBatch(64, batch, next_offset) && !batch.empty()) {
+                read_back += batch.size();
+                spool.commit(next_offset, batch.size());
+            }
+            double read_wall_ms = Bench::elapsedMs(start);
+            
+            cout << "\n  fsync every " << sync_batch << " record(s)" << endl;
+            cout << "  " << left << setw(22) << "append" << right << fixed << setprecision(1)
+                 << setw(10) << appended * 1000.0 / append_wall_ms << " docs/s"
+                 << setw(10) << appended * bytes * 1000.0 / (1024.0 * 1024.0) / append_wall_ms << " MB/s" << endl;
+            Bench::printLatency("append (caller)", append_ms);
+            cout << "  " << left << setw(22) << "fsync" << right << setprecision(3)
+                 << stats.syncs << " calls, mean " << stats.average_sync_ms
+                 << " ms  max " << stats.max_sync_ms << " ms" << endl;
+            cout << "  " << left << setw(22) << "replay read" << right << setprecision(1)
+                 << setw(10) << read_back * 1000.0 / read_wall_ms << " docs/s" << endl;
+            cout.unsetf(ios::floatfield);
+            
+            if (appended != static_cast<size_t>(documents) || read_back != appended ||
+                spool.getPendingRecords() != 0) {
+                cout << "  ❌ " << appended << " appended, " << read_back << " read back, "
+                     << spool.getPendingRecords() << " left" << endl;
+                complete = false;
+            }
+        }
+    }
+    
+    removeSpool(path);
+    cout << "\n" << (complete ? "✅ Every run read back all documents" : "❌ Some runs lost documents") << endl;
+    
+    cout << "\n  ── recovery ──" << endl;
+    database.setFaceFormat(formats.empty() ? FaceDocumentFormat::Expanded : formats[0]);
+    auto document = database.buildFaceDocument(faces, "facemesh_bench.jpg", "Pikachu", "pikachu_mask.png");
+    bool recovered = recoveryPass(path, document.view());
+    if (!recovered) cout << "❌ Spool recovery lost or kept the wrong records" << endl;
+    return complete && recovered ? 0 : 1;
+}
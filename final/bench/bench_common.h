@@ -0,0 +1,145 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../src/headers/face_analyzer.h"
+#include "../src/headers/face_detector.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Small helpers shared by the benchmark programs in bench/
+ */
+namespace Bench {
+
+    /**
+     * @brief Load frames from an image directory or a video file
+     * @param source Directory of images or path to a video file
+     * @param max_frames Stop after this many frames (0 = no limit)
+     * @return Decoded BGR frames
+     */
+    inline vector<Mat> loadFrames(const string& source, size_t max_frames = 0) {
+        vector<Mat> frames;
+        
+        // Image directory first
+        vector<string> files;
+        try {
+            glob(source, files, false);
+        } catch (const cv::Exception&) {
+            files.clear();
+        }
+        sort(files.begin(), files.end());
+        for (const auto& file : files) {
+            Mat image = imread(file, IMREAD_COLOR);
+            if (image.empty()) continue;
+            frames.push_back(image);
+            if (max_frames > 0 && frames.size() >= max_frames) return frames;
+        }
+        if (!frames.empty()) return frames;
+        
+        // Otherwise treat it as a video
+        VideoCapture video(source);
+        Mat frame;
+        while (video.isOpened() && video.read(frame)) {
+            frames.push_back(frame.clone());
+            if (max_frames > 0 && frames.size() >= max_frames) break;
+        }
+        return frames;
+    }
+    
+    /**
+     * @brief Milliseconds elapsed since start
+     */
+    inline double elapsedMs(chrono::steady_clock::time_point start) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+    
+    /**
+     * @brief Nearest-rank percentile of a set of samples
+     */
+    inline double percentile(vector<double> samples, double p) {
+        if (samples.empty()) return 0.0;
+        sort(samples.begin(), samples.end());
+        size_t rank = static_cast<size_t>(p / 100.0 * (samples.size() - 1) + 0.5);
+        return samples[min(rank, samples.size() - 1)];
+    }
+    
+    /**
+     * @brief Print mean and p50/p95/p99 for a set of millisecond samples
+     */
+    inline void printLatency(const string& label, const vector<double>& samples_ms) {
+        double total = 0.0;
+        for (double s : samples_ms) total += s;
+        double mean = samples_ms.empty() ? 0.0 : total / samples_ms.size();
+        
+        cout << "  " << left << setw(22) << label << right << fixed << setprecision(3)
+             << " mean " << setw(8) << mean << " ms"
+             << " | p50 " << setw(8) << percentile(samples_ms, 50) << " ms"
+             << " | p95 " << setw(8) << percentile(samples_ms, 95) << " ms"
+             << " | p99 " << setw(8) << percentile(samples_ms, 99) << " ms"
+             << " | fps " << setw(8) << (mean > 0.0 ? 1000.0 / mean : 0.0) << endl;
+        cout.unsetf(ios::floatfield);
+    }
+    
+    /**
+     * @brief Candidate locations of the frontal face Haar cascade (same as the app's)
+     */
+    inline vector<string> cascadePaths() {
+        return defaultCascadePaths();
+    }
+    
+    /**
+     * @brief Largest rectangle of a detection result (empty if there is none)
+     */
+    inline Rect largestFace(const vector<Rect>& faces) {
+        Rect best;
+        for (const auto& r : faces) {
+            if (r.area() > best.area()) best = r;
+        }
+        return best;
+    }
+    
+    /**
+     * @brief Two synthetic faces with landmarks and mesh, as a capture would save them
+     */
+    inline FaceList sampleFaces() {
+        FaceList faces;
+        vector<Rect> rects = {Rect(200, 120, 220, 220), Rect(720, 160, 180, 180)};
+        for (size_t i = 0; i < rects.size(); i++) {
+            DetectedFace* face = faces.add();
+            face->face_id = static_cast<int>(i);
+            face->rect = rects[i];
+            face->confidence = 1.0;
+            face->center = Point2f(rects[i].x + rects[i].width / 2.0f, rects[i].y + rects[i].height / 2.0f);
+            FaceAnalyzer::generateFacialLandmarks(rects[i], face->landmarks);
+            face->has_landmarks = true;
+            FaceAnalyzer::createFaceMesh(face->landmarks, face->face_mesh);
+            face->face_angle = FaceAnalyzer::calculateFaceAngle(face->landmarks);
+            face->mouth_center = FaceAnalyzer::getMouthCenter(face->landmarks);
+        }
+        return faces;
+    }
+    
+    /**
+     * @brief Split a comma-separated argument, skipping empty items
+     */
+    inline vector<string> splitList(const string& list) {
+        vector<string> items;
+        stringstream stream(list);
+        string item;
+        while (getline(stream, item, ',')) {
+            if (!item.empty()) items.push_back(item);
+        }
+        return items;
+    }
+}
+
+#endif // BENCH_COMMON_H
@@ -0,0 +1,89 @@
+/**
+ * @file bench_detection.cpp
+ * @brief Compare full-frame and ROI/downscaled Haar cascade search
+ *
+ * Usage: bench_detection <video file | image directory> [downscale] [max frames]
+ *
+ * Both strategies see the same frames in order. The ROI strategy is fed
+ * the largest face it found on the previous frame, like FaceMeshApp does.
+ */
+
+#include "bench_common.h"
+#include "../src/headers/cascade_face_detector.h"
+
+static double overlap(const Rect& a, const Rect& b) {
+    double inter = (a & b).area();
+    double uni = a.area() + b.area() - inter;
+    return uni > 0 ? inter / uni : 0.0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <video file | image directory> [downscale] [max frames]" << endl;
+        return 1;
+    }
+    
+    double downscale = argc > 2 ? atof(argv[2]) : 0.5;
+    size_t max_frames = argc > 3 ? static_cast<size_t>(atoi(argv[3])) : 300;
+    
+    vector<Mat> frames = Bench::loadFrames(argv[1], max_frames);
+    if (frames.empty()) {
+        cerr << "❌ No frames could be read from " << argv[1] << endl;
+        return 1;
+    }
+    
+    // Preprocess once, exactly like detectFacesWithMesh
+    vector<Mat> grays(frames.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        cvtColor(frames[i], grays[i], COLOR_BGR2GRAY);
+        equalizeHist(grays[i], grays[i]);
+    }
+    
+    cout << "🔎 Cascade search benchmark: " << frames.size() << " frames ("
+         << frames[0].cols << "x" << frames[0].rows << "), downscale " << downscale << endl;
+    
+    vector<Rect> reference(frames.size());
+    
+    for (auto strategy : {DetectionStrategy::FullFrame, DetectionStrategy::RoiPyramid}) {
+        CascadeFaceDetector detector(strategy);
+        CascadeSearchConfig config;
+        config.downscale = downscale;
+        detector.setConfig(config);
+        if (detector.load(Bench::cascadePaths()).empty()) {
+            cerr << "❌ Haar cascade not found" << endl;
+            return 1;
+        }
+        
+        vector<double> samples;
+        vector<Rect> faces;
+        Rect previous;
+        size_t frames_with_face = 0;
+        double iou_total = 0.0;
+        size_t iou_count = 0;
+        
+        for (size_t i = 0; i < grays.size(); i++) {
+            auto start = chrono::steady_clock::now();
+            detector.detect(grays[i], faces, previous.empty() ? nullptr : &previous);
+            samples.push_back(Bench::elapsedMs(start));
+            
+            previous = Bench::largestFace(faces);
+            if (!previous.empty()) frames_with_face++;
+            
+            if (strategy == DetectionStrategy::FullFrame) {
+                reference[i] = previous;
+            } else if (!reference[i].empty() && !previous.empty()) {
+                iou_total += overlap(reference[i], previous);
+                iou_count++;
+            }
+        }
+        
+        Bench::printLatency(CascadeFaceDetector::strategyName(strategy), samples);
+        cout << "    frames with a face: " << frames_with_face << "/" << frames.size();
+        if (strategy == DetectionStrategy::RoiPyramid) {
+            cout << " | mean IoU vs full-frame: " << (iou_count > 0 ? iou_total / iou_count : 0.0);
+        }
+        cout << endl;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file bench_detectors.cpp
+ * @brief Compare face detector backends on recorded frames
+ *
+ * Usage: bench_detectors <video file | image directory> [dnn model] [dnn config] [input sizes] [max frames]
+ *
+ * Runs the Haar cascade (full-frame and ROI/downscaled) and the DNN backend
+ * at each requested input size (comma separated, e.g. 300x300,200x200) over
+ * the same frames, through the FaceDetector interface FaceAnalyzer uses.
+ * The DNN model defaults to the ResNet-SSD files in models/; pass an .onnx
+ * file to benchmark YuNet instead. Detection time excludes grayscale
+ * conversion, which the analyzer does once per frame for every backend.
+ */
+
+#include "bench_common.h"
+#include "../src/headers/cascade_face_detector.h"
+#include "../src/headers/dnn_face_detector.h"
+#include "../src/headers/face_detector.h"
+#include <memory>
+#include <sstream>
+
+static vector<Size> parseSizes(const string& list) {
+    vector<Size> sizes;
+    stringstream stream(list);
+    string item;
+    while (getline(stream, item, ',')) {
+        int width = atoi(item.c_str());
+        size_t separator = item.find_first_of("xX");
+        int height = separator != string::npos ? atoi(item.c_str() + separator + 1) : width;
+        if (width > 0 && height > 0) sizes.push_back(Size(width, height));
+    }
+    return sizes;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0]
+             << " <video file | image directory> [dnn model] [dnn config] [input sizes] [max frames]" << endl;
+        return 1;
+    }
+    
+    DnnDetectorConfig dnn_config;
+    if (argc > 2) dnn_config.model_path = argv[2];
+    if (argc > 3) dnn_config.config_path = argv[3];
+    vector<Size> input_sizes = parseSizes(argc > 4 ? argv[4] : "300x300");
+    size_t max_frames = argc > 5 ? static_cast<size_t>(atoi(argv[5])) : 300;
+    
+    vector<Mat> frames = Bench::loadFrames(argv[1], max_frames);
+    if (frames.empty()) {
+        cerr << "❌ No frames could be read from " << argv[1] << endl;
+        return 1;
+    }
+    
+    // Preprocess once, exactly like FaceAnalyzer::analyze
+    vector<Mat> grays(frames.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        cvtColor(frames[i], grays[i], COLOR_BGR2GRAY);
+        equalizeHist(grays[i], grays[i]);
+    }
+    
+    vector<unique_ptr<FaceDetector>> detectors;
+    for (auto strategy : {DetectionStrategy::FullFrame, DetectionStrategy::RoiPyramid}) {
+        auto cascade = make_unique<CascadeFaceDetector>(strategy);
+        if (cascade->load(Bench::cascadePaths()).empty()) {
+            cerr << "⚠️  Haar cascade not found, skipping " << CascadeFaceDetector::strategyName(strategy) << endl;
+            continue;
+        }
+        detectors.push_back(std::move(cascade));
+    }
+    for (const auto& size : input_sizes) {
+        DnnDetectorConfig config = dnn_config;
+        config.input_size = size;
+        auto dnn = make_unique<DnnFaceDetector>(config);
+        if (!dnn->load()) {
+            cerr << "⚠️  DNN model " << config.model_path << " could not be loaded, skipping" << endl;
+            break;
+        }
+        detectors.push_back(std::move(dnn));
+    }
+    if (detectors.empty()) {
+        cerr << "❌ No detector could be loaded" << endl;
+        return 1;
+    }
+    
+    cout << "🔎 Face detector benchmark: " << frames.size() << " frames ("
+         << frames[0].cols << "x" << frames[0].rows << ")" << endl;
+    
+    for (auto& detector : detectors) {
+        vector<double> samples;
+        vector<Rect> faces;
+        Rect previous;
+        size_t frames_with_face = 0;
+        size_t detections = 0;
+        
+        // One untimed call so model initialization is not counted
+        detector->detect(frames[0], grays[0], faces, nullptr);
+        
+        for (size_t i = 0; i < frames.size(); i++) {
+            auto start = chrono::steady_clock::now();
+            detector->detect(frames[i], grays[i], faces, previous.empty() ? nullptr : &previous);
+            samples.push_back(Bench::elapsedMs(start));
+            
+            previous = Bench::largestFace(faces);
+            detections += faces.size();
+            if (!faces.empty()) frames_with_face++;
+        }
+        
+        Bench::printLatency(detector->name(), samples);
+        cout << "    frames with a face: " << frames_with_face << "/" << frames.size()
+             << " | detections: " << detections << endl;
+    }
+    
+    return 0;
+}
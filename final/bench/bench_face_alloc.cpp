@@ -0,0 +1,172 @@
+/**
+ * @file bench_face_alloc.cpp
+ * @brief Heap allocations per frame for describing faces and queueing the result
+ *
+ * Usage: bench_face_alloc [frames]
+ *
+ * Replaces the global operator new with a counting version and runs the
+ * detection-to-render hand-off for 1, 4 and 8 faces in two layouts:
+ *   - legacy: the old vector<DetectedFace> with per-landmark name strings,
+ *     a vector mesh and a Mat, returned by value and moved through the queue
+ *   - fixed:  the trivially copyable DetectedFace filled in a reused
+ *     FaceList (described on the thread pool) and copied through the queue
+ * The target for the fixed layout is zero allocations per frame.
+ */
+
+#include "alloc_counter.h"
+#include "bench_common.h"
+#include "../src/headers/face_analyzer.h"
+#include "../src/headers/frame_pipeline.h"
+#include "../src/headers/landmark_template.h"
+#include "../src/headers/thread_pool.h"
+#include <atomic>
+
+// The face record as it was before the fixed layout
+struct LegacyLandmark {
+    Point2f point;
+    int landmark_id;
+    string landmark_name;
+};
+
+struct LegacyFace {
+    Rect rect;
+    double confidence;
+    Point2f center;
+    vector<LegacyLandmark> landmarks;
+    vector<Point2f> face_mesh;
+    Mat mask_overlay;
+    double face_angle;
+    bool mouth_open;
+    Point2f mouth_center;
+};
+
+struct LegacyPacket {
+    vector<LegacyFace> faces;
+    uint64_t sequence = 0;
+};
+
+static vector<LegacyFace> legacyDescribe(const vector<Rect>& rects, const vector<string>& names) {
+    vector<LegacyFace> faces;
+    for (const auto& rect : rects) {
+        LegacyFace face;
+        face.rect = rect;
+        face.confidence = 1.0;
+        face.center = Point2f(rect.x + rect.width / 2.0f, rect.y + rect.height / 2.0f);
+        
+        // Same points as before, one named struct at a time
+        FaceLandmarks points;
+        FaceAnalyzer::generateFacialLandmarks(rect, points);
+        for (int id = 0; id < FACE_LANDMARK_COUNT; id++) {
+            LegacyLandmark landmark;
+            landmark.point = points[id];
+            landmark.landmark_id = id;
+            landmark.landmark_name = names[id];
+            face.landmarks.push_back(landmark);
+        }
+        for (const auto& landmark : face.landmarks) {
+            face.face_mesh.push_back(landmark.point);
+        }
+        for (size_t i = 0; i < 16; i++) {
+            face.face_mesh.push_back((face.landmarks[i].point + face.landmarks[i + 1].point) * 0.5f);
+        }
+        face.face_angle = FaceAnalyzer::calculateFaceAngle(points);
+        face.mouth_open = false;
+        face.mouth_center = face.landmarks[LANDMARK_MOUTH_CENTER].point;
+        faces.push_back(face);
+    }
+    return faces;
+}
+
+static void fixedDescribe(ThreadPool& pool, const vector<Rect>& rects, FaceList& faces) {
+    faces.count = rects.size();
+    pool.parallelFor(rects.size(), [&](size_t i) {
+        DetectedFace& face = faces[i];
+        const Rect& rect = rects[i];
+        face = DetectedFace();
+        face.face_id = static_cast<int>(i);
+        face.rect = rect;
+        face.confidence = 1.0;
+        face.center = Point2f(rect.x + rect.width / 2.0f, rect.y + rect.height / 2.0f);
+        FaceAnalyzer::generateFacialLandmarks(rect, face.landmarks);
+        face.has_landmarks = true;
+        FaceAnalyzer::createFaceMesh(face.landmarks, face.face_mesh);
+        face.face_angle = FaceAnalyzer::calculateFaceAngle(face.landmarks);
+        face.mouth_center = FaceAnalyzer::getMouthCenter(face.landmarks);
+    });
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 2000;
+    const int warmup = 50;
+    
+    vector<string> names;
+    for (int id = 0; id < FACE_LANDMARK_COUNT; id++) {
+        names.push_back(landmarkName(id));
+    }
+    ThreadPool pool;
+    
+    cout << "🧮 Face record allocations (" << frames << " frames after " << warmup
+         << " warm-up frames, " << pool.size() << " workers)" << endl;
+    
+    for (int face_count : {1, 4, 8}) {
+        vector<Rect> rects;
+        for (int f = 0; f < face_count; f++) {
+            rects.push_back(Rect(40 + (f % 4) * 300, 60 + (f / 4) * 340, 220, 240));
+        }
+        
+        // Legacy: build by value, move through the queue, move into "latest"
+        FrameQueue<LegacyPacket> legacy_queue(2);
+        LegacyPacket legacy_latest;
+        LegacyPacket legacy_incoming;
+        uint64_t legacy_heap = 0;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < warmup + frames; i++) {
+            if (i == warmup) {
+                legacy_heap = heap_allocations.load();
+                start = chrono::steady_clock::now();
+            }
+            LegacyPacket packet;
+            packet.faces = legacyDescribe(rects, names);
+            packet.sequence = i;
+            legacy_queue.push(std::move(packet));
+            while (legacy_queue.tryPop(legacy_incoming)) {
+                legacy_latest = std::move(legacy_incoming);
+            }
+        }
+        legacy_heap = heap_allocations.load() - legacy_heap;
+        double legacy_ms = Bench::elapsedMs(start);
+        
+        // Fixed: fill the reused packet, copy through the queue
+        FrameQueue<DetectionPacket> queue(2);
+        DetectionPacket result;
+        DetectionPacket latest;
+        DetectionPacket incoming;
+        uint64_t fixed_heap = 0;
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < warmup + frames; i++) {
+            if (i == warmup) {
+                fixed_heap = heap_allocations.load();
+                start = chrono::steady_clock::now();
+            }
+            fixedDescribe(pool, rects, result.faces);
+            result.sequence = i;
+            queue.push(result);
+            while (queue.tryPop(incoming)) {
+                latest = incoming;
+            }
+        }
+        fixed_heap = heap_allocations.load() - fixed_heap;
+        double fixed_ms = Bench::elapsedMs(start);
+        
+        cout << "  " << face_count << (face_count == 1 ? " face " : " faces") << fixed << setprecision(3)
+             << " | legacy heap/frame " << setw(8) << static_cast<double>(legacy_heap) / frames
+             << " (" << legacy_ms / frames << " ms)"
+             << " | fixed heap/frame " << setw(6) << static_cast<double>(fixed_heap) / frames
+             << " (" << fixed_ms / frames << " ms)" << endl;
+        cout.unsetf(ios::floatfield);
+    }
+    
+    cout << "  sizeof(DetectedFace) " << sizeof(DetectedFace)
+         << " bytes, sizeof(DetectionPacket) " << sizeof(DetectionPacket) << " bytes" << endl;
+    return 0;
+}
@@ -0,0 +1,195 @@
+/**
+ * @file bench_mongo_write.cpp
+ * @brief Capture document size and insert throughput per face format and batching
+ *
+ * Usage: bench_mongo_write [connection string] [documents] [batch sizes] [write concern] [formats]
+ *
+ * Every run writes the same capture document (two faces with landmarks and
+ * mesh, built by MongoDBHandler::buildFaceDocument). For each face format
+ * (default "expanded,compact") it first reports the BSON size, the time to
+ * build one document and, after reading the geometry back with
+ * readFaceGeometry, the largest coordinate error. This part needs no server.
+ *
+ * Then, against a running mongod (default mongodb://localhost:27017), it
+ * writes into a scratch collection, facemesh_bench.face_analysis_bench,
+ * which is dropped before each run and at the end:
+ *   - single: saveFaceData, one insert_one round trip per document
+ *   - batched: MongoWriteBehind with each batch size (e.g. 1,16,64,256),
+ *     unordered insert_many and the given write concern ("1", "majority", "0")
+ * For each run it reports documents/second, the caller-side cost of one
+ * save/enqueue, and the insert_many latency. Exits 1 if MongoDB cannot be
+ * reached, a run did not write every document, or geometry did not read back.
+ */
+
+#include "bench_common.h"
+#include "../src/headers/mongo_write_behind.h"
+#include "../src/headers/mongodb_handler.h"
+#include <mongocxx/instance.hpp>
+
+static vector<size_t> parseSizes(const string& list) {
+    vector<size_t> sizes;
+    for (const auto& item : Bench::splitList(list)) {
+        long size = atol(item.c_str());
+        if (size > 0) sizes.push_back(static_cast<size_t>(size));
+    }
+    return sizes;
+}
+
+// Largest distance between the original and read-back landmarks and mesh (-1 if unreadable)
+static double roundTripError(const bsoncxx::document::value& document, const FaceList& faces) {
+    double error = 0.0;
+    size_t index = 0;
+    for (auto&& element : document.view()["faces"].get_array().value) {
+        if (index >= faces.size()) return -1.0;
+        DetectedFace decoded;
+        if (!MongoDBHandler::readFaceGeometry(element.get_document().value, decoded)) return -1.0;
+        const DetectedFace& face = faces[index++];
+        if (decoded.has_landmarks != face.has_landmarks) return -1.0;
+        if (!face.has_landmarks) continue;
+        for (int i = 0; i < FACE_LANDMARK_COUNT; i++) {
+            error = max(error, static_cast<double>(norm(decoded.landmarks[i] - face.landmarks[i])));
+        }
+        for (int i = 0; i < FACE_MESH_POINT_COUNT; i++) {
+            error = max(error, static_cast<double>(norm(decoded.face_mesh[i] - face.face_mesh[i])));
+        }
+    }
+    return index == faces.size() ? error : -1.0;
+}
+
+static void printRate(const string& label, size_t documents, double wall_ms) {
+    cout << "  " << left << setw(22) << label << right << fixed << setprecision(1)
+         << setw(10) << documents * 1000.0 / wall_ms << " docs/s"
+         << setw(10) << wall_ms << " ms total" << endl;
+    cout.unsetf(ios::floatfield);
+}
+
+int main(int argc, char** argv) {
+    string connection_string = argc > 1 ? argv[1] : "mongodb://localhost:27017";
+    int documents = argc > 2 ? max(1, atoi(argv[2])) : 2000;
+    vector<size_t> batch_sizes = parseSizes(argc > 3 ? argv[3] : "1,16,64,256");
+    string write_concern = argc > 4 ? argv[4] : "1";
+    
+    vector<FaceDocumentFormat> formats;
+    for (const auto& name : Bench::splitList(argc > 5 ? argv[5] : "expanded,compact")) {
+        FaceDocumentFormat format;
+        if (!faceDocumentFormatFromName(name, format)) {
+            cerr << "❌ Unknown face format: " << name << endl;
+            return 1;
+        }
+        formats.push_back(format);
+    }
+    
+    mongocxx::instance instance{};
+    MongoDBHandler database(connection_string, "facemesh_bench", "face_analysis_bench");
+    
+    FaceList faces = Bench::sampleFaces();
+    const string filename = "facemesh_bench.jpg";
+    const string pokemon_name = "Pikachu";
+    const string mask_file = "pikachu_mask.png";
+    bool complete = true;
+    
+    // Size, build cost and read-back accuracy (no server needed)
+    cout << "📦 Capture document with " << faces.size() << " faces" << endl;
+    for (FaceDocumentFormat format : formats) {
+        database.setFaceFormat(format);
+        const int builds = 2000;
+        size_t bytes = 0;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < builds; i++) {
+            bytes = database.buildFaceDocument(faces, filename, pokemon_name, mask_file).view().length();
+        }
+        double build_us = Bench::elapsedMs(start) * 1000.0 / builds;
+        double error = roundTripError(database.buildFaceDocument(faces, filename, pokemon_name, mask_file), faces);
+        
+        cout << "  " << left << setw(10) << faceDocumentFormatName(format) << right
+             << setw(8) << bytes << " bytes" << fixed << setprecision(1)
+             << setw(9) << build_us << " us/build";
+        if (error < 0.0) {
+            cout << "   ❌ geometry did not read back" << endl;
+            complete = false;
+        } else {
+            cout << setprecision(4) << "   max error " << error << " px" << endl;
+        }
+        cout.unsetf(ios::floatfield);
+    }
+    
+    if (!database.testConnection()) {
+        cerr << "❌ Cannot reach MongoDB at " << connection_string << endl;
+        return 1;
+    }
+    
+    cout << "\n🗄️  MongoDB writes: " << documents << " documents per run | write concern "
+         << write_concern << endl;
+    
+    for (FaceDocumentFormat format : formats) {
+        database.setFaceFormat(format);
+        cout << "\n  ── " << faceDocumentFormatName(format) << " ──" << endl;
+        
+        // One round trip per document, as saveFaceData did on the UI thread
+        {
+            database.dropCollection();
+            vector<double> save_ms;
+            size_t saved = 0;
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < documents; i++) {
+                auto begin = chrono::steady_clock::now();
+                if (database.saveFaceData(faces, filename, pokemon_name, mask_file)) saved++;
+                save_ms.push_back(Bench::elapsedMs(begin));
+            }
+            double wall_ms = Bench::elapsedMs(start);
+            
+            cout << "\n  single insert_one (default write concern)" << endl;
+            printRate("throughput", saved, wall_ms);
+            Bench::printLatency("save (caller)", save_ms);
+            if (saved != static_cast<size_t>(documents)) {
+                cout << "  ❌ only " << saved << " of " << documents << " documents written" << endl;
+                complete = false;
+            }
+        }
+        
+        for (size_t batch_size : batch_sizes) {
+            database.dropCollection();
+            
+            WriteBehindConfig config;
+            config.batch_size = batch_size;
+            config.queue_capacity = max<size_t>(1024, batch_size * 4);
+            config.enqueue_timeout = chrono::milliseconds(10000);
+            config.write_concern = write_concern;
+            
+            vector<double> enqueue_ms;
+            WriteBehindStats stats;
+            double wall_ms = 0.0;
+            {
+                MongoWriteBehind writes(database, config);
+                auto start = chrono::steady_clock::now();
+                for (int i = 0; i < documents; i++) {
+                    auto begin = chrono::steady_clock::now();
+                    writes.enqueue(database.buildFaceDocument(faces, filename, pokemon_name, mask_file));
+                    enqueue_ms.push_back(Bench::elapsedMs(begin));
+                }
+                writes.flush(chrono::minutes(10));
+                wall_ms = Bench::elapsedMs(start);
+                stats = writes.getStats();
+            }
+            
+            cout << "\n  write-behind, batch " << batch_size << " (" << stats.batches << " insert_many, "
+                 << fixed << setprecision(1) << stats.average_batch << " docs each)" << endl;
+            cout.unsetf(ios::floatfield);
+            printRate("throughput", static_cast<size_t>(stats.written), wall_ms);
+            Bench::printLatency("build + enqueue", enqueue_ms);
+            cout << "  " << left << setw(22) << "insert_many" << right << fixed << setprecision(3)
+                 << "mean " << stats.average_flush_ms << " ms  max " << stats.max_flush_ms << " ms" << endl;
+            cout.unsetf(ios::floatfield);
+            
+            if (stats.written != static_cast<uint64_t>(documents)) {
+                cout << "  ❌ " << stats.written << " written, " << stats.failed << " failed, "
+                     << stats.rejected << " rejected" << endl;
+                complete = false;
+            }
+        }
+    }
+    
+    database.dropCollection();
+    cout << "\n" << (complete ? "✅ Every run wrote all documents" : "❌ Some runs failed") << endl;
+    return complete ? 0 : 1;
+}
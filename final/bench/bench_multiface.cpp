@@ -0,0 +1,147 @@
+/**
+ * @file bench_multiface.cpp
+ * @brief Frames per second of the multi-face path as the face count grows
+ *
+ * Usage: bench_multiface <face image> [mask png] [frames per step]
+ *
+ * The face found in the input image is tiled into a 1280x720 frame 1 to 8
+ * times (4x2 grid) and drifts a few pixels per frame. Every frame runs what
+ * FaceMeshApp does: FaceAnalyzer::analyze (cascade/tracking, landmarks,
+ * mouth), per-face mask placement on the pool, then blending and particles.
+ * Each face count is run with a single worker and with the default pool.
+ */
+
+#include "bench_common.h"
+#include "../src/headers/face_analyzer.h"
+#include "../src/headers/mask_renderer.h"
+#include "../src/headers/particle_system.h"
+#include "../src/headers/thread_pool.h"
+#include <memory>
+
+struct BenchFaceEffects {
+    MaskRenderer mask;
+    ParticleSystem particles;
+    MaskRenderer::Placement placement;
+};
+
+static Mat tiledFrame(const Mat& face_patch, int faces, int frame_index) {
+    const Size frame_size(1280, 720);
+    const int columns = 4;
+    Size cell(frame_size.width / columns, frame_size.height / 2);
+    
+    Mat frame(frame_size, CV_8UC3, Scalar(90, 110, 120));
+    for (int f = 0; f < faces; f++) {
+        int dx = static_cast<int>(6 * sin(frame_index * 0.07 + f));
+        int dy = static_cast<int>(4 * cos(frame_index * 0.05 + f));
+        Rect slot((f % columns) * cell.width + (cell.width - face_patch.cols) / 2 + dx,
+                  (f / columns) * cell.height + (cell.height - face_patch.rows) / 2 + dy,
+                  face_patch.cols, face_patch.rows);
+        slot &= Rect(Point(0, 0), frame_size);
+        face_patch(Rect(0, 0, slot.width, slot.height)).copyTo(frame(slot));
+    }
+    return frame;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <face image> [mask png] [frames per step]" << endl;
+        return 1;
+    }
+    
+    string mask_path = argc > 2 ? argv[2] : "images/pikachu_mask.png";
+    int frames = argc > 3 ? atoi(argv[3]) : 120;
+    
+    Mat image = imread(argv[1], IMREAD_COLOR);
+    Mat mask = imread(mask_path, IMREAD_UNCHANGED);
+    if (image.empty() || mask.empty()) {
+        cerr << "❌ Could not load " << (image.empty() ? argv[1] : mask_path) << endl;
+        return 1;
+    }
+    
+    // Cut the face (with some context) out of the input once
+    CascadeFaceDetector detector;
+    if (detector.load(Bench::cascadePaths()).empty()) {
+        cerr << "❌ Face cascade not found" << endl;
+        return 1;
+    }
+    Mat gray;
+    cvtColor(image, gray, COLOR_BGR2GRAY);
+    equalizeHist(gray, gray);
+    vector<Rect> found;
+    detector.detect(gray, found, nullptr);
+    if (found.empty()) {
+        cerr << "❌ No face found in " << argv[1] << endl;
+        return 1;
+    }
+    Rect face = found[0];
+    for (const auto& r : found) {
+        if (r.area() > face.area()) face = r;
+    }
+    Rect context(face.x - face.width / 4, face.y - face.height / 4, face.width * 3 / 2, face.height * 3 / 2);
+    context &= Rect(0, 0, image.cols, image.rows);
+    
+    // Fit the patch into one grid cell with room to drift
+    Mat face_patch;
+    double fit = min(300.0 / context.width, 340.0 / context.height);
+    resize(image(context), face_patch, Size(), fit, fit, INTER_AREA);
+    
+    cout << "👥 Multi-face benchmark: " << frames << " frames per step, 1280x720, face patch "
+         << face_patch.cols << "x" << face_patch.rows << endl;
+    
+    for (size_t workers : {static_cast<size_t>(1), static_cast<size_t>(0)}) {
+        ThreadPool pool(workers);
+        cout << "\n  workers: " << pool.size() << " (+ calling thread)" << endl;
+        
+        for (int faces = 1; faces <= 8; faces++) {
+            FaceAnalyzer analyzer(pool);
+            analyzer.loadCascade(Bench::cascadePaths());
+            vector<unique_ptr<BenchFaceEffects>> effects;
+            vector<double> samples;
+            size_t faces_seen = 0;
+            Mat display;
+            FaceList detected;
+            
+            const int warmup = 10;
+            for (int i = 0; i < warmup + frames; i++) {
+                Mat frame = tiledFrame(face_patch, faces, i);
+                auto start = chrono::steady_clock::now();
+                
+                analyzer.analyze(frame, detected);
+                
+                // Effects by position in the result; IDs are stable for this synthetic input
+                while (effects.size() < detected.size()) {
+                    effects.push_back(make_unique<BenchFaceEffects>());
+                    effects.back()->mask.setMask(mask);
+                    effects.back()->particles.setParticleKind(ParticleKind::Water);
+                }
+                pool.parallelFor(detected.size(), [&](size_t f) {
+                    effects[f]->placement = effects[f]->mask.place(detected[f]);
+                });
+                
+                frame.copyTo(display);
+                for (size_t f = 0; f < detected.size(); f++) {
+                    effects[f]->mask.blend(display, effects[f]->placement);
+                    ParticleSystem& particles = effects[f]->particles;
+                    particles.setEmitPosition(detected[f].mouth_center);
+                    particles.startEmission();
+                    particles.update();
+                    particles.draw(display);
+                }
+                
+                if (i >= warmup) {
+                    samples.push_back(Bench::elapsedMs(start));
+                    faces_seen += detected.size();
+                }
+            }
+            
+            Bench::printLatency(to_string(faces) + (faces == 1 ? " face" : " faces"), samples);
+            cout << "  " << setw(22) << "" << " faces found/frame "
+                 << fixed << setprecision(2) << static_cast<double>(faces_seen) / frames
+                 << " | cascade runs " << analyzer.getCascadeRuns()
+                 << " | tracked frames " << analyzer.getTrackedFrames() << endl;
+            cout.unsetf(ios::floatfield);
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file bench_particle_dispatch.cpp
+ * @brief Dispatch cost of the old string/virtual particle design vs the kind registry
+ *
+ * Usage: bench_particle_dispatch [particles] [frames]
+ *
+ * "before" is a copy of the original design kept here for comparison:
+ * particle_type is compared against each name on every emission, every
+ * particle is a make_unique'd object with virtual update(), and dead
+ * particles are compacted with remove_if. "after" is ParticleSystem with
+ * the kind resolved once in setParticleType.
+ */
+
+#include "bench_common.h"
+#include "../src/headers/particle_kinds.h"
+#include <memory>
+
+namespace Legacy {
+    struct Particle {
+        Point2f position, velocity;
+        float life = 1.0f;
+        virtual ~Particle() = default;
+        virtual void update() = 0;
+    };
+    
+    template <ParticleKind K>
+    struct KindParticle : Particle {
+        float rotation = 0.0f;
+        explicit KindParticle(Point2f pos) {
+            position = pos;
+            velocity = Point2f((rand() % 40 - 20) / 10.0f, (rand() % 20 - 40) / 10.0f);
+        }
+        void update() override {
+            velocity.y += ParticleTraits<K>::gravity;
+            position += velocity;
+            rotation += ParticleTraits<K>::spin;
+            life -= ParticleTraits<K>::decay;
+            if (life < 0) life = 0;
+        }
+    };
+    
+    unique_ptr<Particle> emit(const string& type, Point2f pos) {
+        if (type == "water") return make_unique<KindParticle<ParticleKind::Water>>(pos);
+        if (type == "coin") return make_unique<KindParticle<ParticleKind::Coin>>(pos);
+        if (type == "gem") return make_unique<KindParticle<ParticleKind::Gem>>(pos);
+        if (type == "heart") return make_unique<KindParticle<ParticleKind::Heart>>(pos);
+        if (type == "lightning") return make_unique<KindParticle<ParticleKind::Lightning>>(pos);
+        return nullptr;
+    }
+    
+    void update(vector<unique_ptr<Particle>>& particles) {
+        for (auto& particle : particles) particle->update();
+        particles.erase(remove_if(particles.begin(), particles.end(),
+                                  [](const unique_ptr<Particle>& p) { return p->life <= 0; }),
+                        particles.end());
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t target = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 10000;
+    int frames = argc > 2 ? atoi(argv[2]) : 200;
+    srand(7);
+    
+    cout << "🧭 Particle dispatch benchmark (" << target << " particles, " << frames << " frames)" << endl;
+    
+    // Emission: name lookup per particle vs kind resolved up front
+    const int lookups = 1000000;
+    volatile int sink = 0;
+    string type = "lightning";   // last in the chain, as in the worst case of the old code
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) {
+        int kind = type == "water" ? 0 : type == "coin" ? 1 : type == "gem" ? 2 : type == "heart" ? 3 : type == "lightning" ? 4 : -1;
+        sink = sink + kind;
+    }
+    double string_ms = Bench::elapsedMs(start);
+    
+    ParticleKind resolved;
+    particleKindFromName(type, resolved);
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) {
+        sink = sink + particleKindOps(resolved).emit_frequency;
+    }
+    double resolved_ms = Bench::elapsedMs(start);
+    
+    cout << fixed << setprecision(2);
+    cout << "\n  kind lookup per emission: string compare " << string_ms * 1e6 / lookups << " ns"
+         << " | resolved kind " << resolved_ms * 1e6 / lookups << " ns" << endl;
+    
+    for (const char* kind : {"water", "coin", "lightning"}) {
+        vector<unique_ptr<Legacy::Particle>> legacy;
+        ParticleSystem system(target);
+        system.setParticleType(kind);
+        
+        vector<double> before, after;
+        for (int f = 0; f < frames; f++) {
+            Point2f origin(640.0f, 600.0f);
+            
+            // Emission is timed together with the update, as in the app's update()
+            start = chrono::steady_clock::now();
+            while (legacy.size() < target) legacy.push_back(Legacy::emit(kind, origin));
+            Legacy::update(legacy);
+            before.push_back(Bench::elapsedMs(start));
+            
+            start = chrono::steady_clock::now();
+            system.burst(origin, target - system.getParticleCount());
+            system.update();
+            after.push_back(Bench::elapsedMs(start));
+        }
+        
+        cout << "\n  " << kind << endl;
+        Bench::printLatency("before (string + virtual)", before);
+        Bench::printLatency("after (kind registry)", after);
+        cout << "    speedup (p50): " << Bench::percentile(before, 50) / max(1e-6, Bench::percentile(after, 50)) << "x" << endl;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file bench_particle_raster.cpp
+ * @brief Per-primitive particle drawing vs atlas sprite stamping
+ *
+ * Usage: bench_particle_raster [frames]
+ *
+ * Draws the same particle population with OpenCV primitives and with the
+ * batched sprite stamper for several particle counts and reports draw
+ * time plus the share of pixels that differ between the two.
+ */
+
+#include "bench_common.h"
+#include "../src/headers/particle_atlas.h"
+
+static double differingPixels(const Mat& a, const Mat& b) {
+    size_t differing = 0;
+    for (int y = 0; y < a.rows; y++) {
+        const Vec3b* pa = a.ptr<Vec3b>(y);
+        const Vec3b* pb = b.ptr<Vec3b>(y);
+        for (int x = 0; x < a.cols; x++) {
+            if (pa[x] != pb[x]) differing++;
+        }
+    }
+    return 100.0 * differing / a.total();
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 50;
+    
+    Mat base(720, 1280, CV_8UC3, Scalar(40, 40, 40));
+    Mat primitive_frame, stamped_frame;
+    
+    auto atlas_start = chrono::steady_clock::now();
+    size_t sprites = ParticleAtlas::shared().getSpriteCount();
+    cout << "🖌️  Particle rasterizer benchmark (" << frames << " frames, atlas of " << sprites
+         << " sprites built in " << fixed << setprecision(2) << Bench::elapsedMs(atlas_start) << " ms)" << endl;
+    cout.unsetf(ios::floatfield);
+    
+    for (const char* kind : {"water", "coin", "gem", "heart"}) {
+        for (size_t count : {1000, 5000, 20000}) {
+            ParticleSystem system(count);
+            system.setParticleType(kind);
+            srand(99);
+            while (system.getParticleCount() < count) {
+                Point2f origin(static_cast<float>(rand() % base.cols), static_cast<float>(rand() % base.rows));
+                system.burst(origin, min<size_t>(50, count - system.getParticleCount()));
+            }
+            // A few steps so rotation, color and life spread out
+            for (int i = 0; i < 10; i++) system.update();
+            
+            vector<double> primitive, stamped;
+            for (int i = 0; i < frames; i++) {
+                base.copyTo(primitive_frame);
+                system.setBatchedDrawing(false);
+                auto start = chrono::steady_clock::now();
+                system.draw(primitive_frame);
+                primitive.push_back(Bench::elapsedMs(start));
+                
+                base.copyTo(stamped_frame);
+                system.setBatchedDrawing(true);
+                start = chrono::steady_clock::now();
+                system.draw(stamped_frame);
+                stamped.push_back(Bench::elapsedMs(start));
+            }
+            
+            cout << "\n  " << kind << " x " << system.getParticleCount() << endl;
+            Bench::printLatency("primitives", primitive);
+            Bench::printLatency("atlas stamping", stamped);
+            cout << fixed << setprecision(2) << "    speedup (p50): "
+                 << Bench::percentile(primitive, 50) / max(1e-6, Bench::percentile(stamped, 50)) << "x"
+                 << " | differing pixels: " << differingPixels(primitive_frame, stamped_frame) << "%" << endl;
+            cout.unsetf(ios::floatfield);
+        }
+    }
+    
+    return 0;
+}
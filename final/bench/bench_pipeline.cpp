@@ -0,0 +1,165 @@
+/**
+ * @file bench_pipeline.cpp
+ * @brief Replay a recorded session through the full pipeline
+ *
+ * Usage: bench_pipeline <recording.fmrec | video | image directory> [mask png] [particle kind] [seed] [runs]
+ *
+ * Every frame goes through what the live app does: JPEG decode, detection
+ * and tracking (FaceAnalyzer::analyze with the recorded capture time),
+ * then masks and particles (FaceEffectsCompositor). Each stage's latency is
+ * reported as p50/p95/p99 together with end-to-end FPS.
+ *
+ * Each run starts from fresh analyzer and effects state with the same
+ * particle seed and hashes every composed frame. With more than one run
+ * the hashes must match, so the exit code doubles as a regression gate:
+ * 0 = replay is deterministic, 1 = it is not (or the input is unusable).
+ * Videos and image directories are JPEG-encoded up front at 30 fps so they
+ * replay exactly like a recording.
+ */
+
+#include "bench_common.h"
+#include "../src/headers/face_analyzer.h"
+#include "../src/headers/face_effects.h"
+#include "../src/headers/mask_asset.h"
+#include "../src/headers/particle_kinds.h"
+#include "../src/headers/session_recording.h"
+#include "../src/headers/thread_pool.h"
+
+struct RecordedFrame {
+    vector<uchar> jpeg;
+    double time_s;
+};
+
+static vector<RecordedFrame> loadRecording(const string& source) {
+    vector<RecordedFrame> frames;
+    
+    if (SessionReader::isRecording(source)) {
+        SessionReader reader;
+        if (!reader.open(source)) return frames;
+        RecordedFrame frame;
+        while (reader.readEncoded(frame.jpeg, frame.time_s)) {
+            frames.push_back(frame);
+        }
+        return frames;
+    }
+    
+    vector<Mat> decoded = Bench::loadFrames(source);
+    vector<int> params = {IMWRITE_JPEG_QUALITY, 90};
+    for (size_t i = 0; i < decoded.size(); i++) {
+        RecordedFrame frame;
+        imencode(".jpg", decoded[i], frame.jpeg, params);
+        frame.time_s = i / 30.0;
+        frames.push_back(std::move(frame));
+    }
+    return frames;
+}
+
+// FNV-1a over the pixels; enough to tell whether two replays drew the same thing
+static uint64_t hashFrame(const Mat& frame, uint64_t hash) {
+    for (int y = 0; y < frame.rows; y++) {
+        const uchar* row = frame.ptr<uchar>(y);
+        for (size_t x = 0; x < frame.cols * frame.elemSize(); x++) {
+            hash = (hash ^ row[x]) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0]
+             << " <recording.fmrec | video | image directory> [mask png] [particle kind] [seed] [runs]" << endl;
+        return 1;
+    }
+    
+    string mask_file = argc > 2 ? argv[2] : "pikachu_mask.png";
+    ParticleKind kind = ParticleKind::Lightning;
+    if (argc > 3 && !particleKindFromName(argv[3], kind)) {
+        cerr << "❌ Unknown particle kind: " << argv[3] << endl;
+        return 1;
+    }
+    uint64_t seed = argc > 4 ? strtoull(argv[4], nullptr, 10) : 1;
+    int runs = argc > 5 ? max(1, atoi(argv[5])) : 2;
+    
+    vector<RecordedFrame> recording = loadRecording(argv[1]);
+    if (recording.empty()) {
+        cerr << "❌ No frames could be read from " << argv[1] << endl;
+        return 1;
+    }
+    
+    MaskAsset mask;
+    string mask_source;
+    if (!MaskAssets::load(mask_file, mask, mask_source)) {
+        cerr << "❌ Mask not found: " << mask_file << endl;
+        return 1;
+    }
+    
+    ThreadPool pool;
+    cout << "🎞️  Pipeline replay: " << recording.size() << " frames, "
+         << recording.back().time_s << " s recorded | mask " << mask_source
+         << " | particles " << particleKindOps(kind).name << " | seed " << seed
+         << " | " << pool.size() + 1 << " threads" << endl;
+    
+    vector<uint64_t> hashes;
+    for (int run = 0; run < runs; run++) {
+        // Fresh state every run: face IDs, tracks, filters and particle streams
+        FaceAnalyzer analyzer(pool);
+        if (analyzer.loadCascade(Bench::cascadePaths()).empty()) {
+            cerr << "❌ Haar cascade not found" << endl;
+            return 1;
+        }
+        FaceEffectsCompositor effects(pool);
+        effects.setMask(mask);
+        effects.setParticleKind(kind);
+        effects.setSeed(seed);
+        
+        vector<double> decode_ms, analyze_ms, compose_ms, total_ms;
+        Mat frame, display;
+        FaceList faces;
+        vector<Rect> dirty;
+        uint64_t hash = 1469598103934665603ull;
+        size_t face_count = 0;
+        
+        auto run_start = chrono::steady_clock::now();
+        for (const auto& recorded : recording) {
+            auto start = chrono::steady_clock::now();
+            imdecode(recorded.jpeg, IMREAD_COLOR, &frame);
+            auto decoded = chrono::steady_clock::now();
+            
+            analyzer.analyze(frame, recorded.time_s, faces);
+            auto analyzed = chrono::steady_clock::now();
+            
+            frame.copyTo(display);
+            effects.compose(display, faces, dirty);
+            auto composed = chrono::steady_clock::now();
+            
+            decode_ms.push_back(chrono::duration<double, milli>(decoded - start).count());
+            analyze_ms.push_back(chrono::duration<double, milli>(analyzed - decoded).count());
+            compose_ms.push_back(chrono::duration<double, milli>(composed - analyzed).count());
+            total_ms.push_back(chrono::duration<double, milli>(composed - start).count());
+            
+            face_count += faces.size();
+            hash = hashFrame(display, hash);
+        }
+        double wall_ms = Bench::elapsedMs(run_start);
+        hashes.push_back(hash);
+        
+        cout << "\n  run " << run + 1 << ": " << face_count << " faces"
+             << " | frame hash " << hex << hash << dec
+             << " | throughput " << fixed << setprecision(1)
+             << recording.size() * 1000.0 / wall_ms << " fps (incl. hashing)" << endl;
+        cout.unsetf(ios::floatfield);
+        Bench::printLatency("decode", decode_ms);
+        Bench::printLatency("detect + track", analyze_ms);
+        Bench::printLatency("masks + particles", compose_ms);
+        Bench::printLatency("frame total", total_ms);
+    }
+    
+    bool deterministic = all_of(hashes.begin(), hashes.end(),
+                                [&](uint64_t hash) { return hash == hashes[0]; });
+    if (runs > 1) {
+        cout << "\n" << (deterministic ? "✅ Replays produced identical frames"
+                                       : "❌ Replays differ: output is not deterministic") << endl;
+    }
+    return deterministic ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file bench_render_alloc.cpp
+ * @brief Count heap allocations per frame in the capture/compose/render path
+ *
+ * Usage: bench_render_alloc [mask png] [frames]
+ *
+ * Replaces the global operator new and OpenCV's default Mat allocator with
+ * counting versions, warms the render path up, then reports allocations per
+ * frame for each stage. The target for steady state is zero.
+ */
+
+#include "alloc_counter.h"
+#include "bench_common.h"
+#include "../src/headers/frame_pool.h"
+#include "../src/headers/mask_renderer.h"
+#include "../src/headers/particle_system.h"
+#include <atomic>
+
+/**
+ * @brief Mat allocator that counts buffer allocations and forwards to OpenCV's
+ */
+class CountingMatAllocator : public MatAllocator {
+public:
+    const MatAllocator* inner = Mat::getStdAllocator();
+    mutable atomic<uint64_t> count{0};
+    
+    UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                       AccessFlag flags, UMatUsageFlags usage) const override {
+        if (data == nullptr) count++;
+        return inner->allocate(dims, sizes, type, data, step, flags, usage);
+    }
+    bool allocate(UMatData* data, AccessFlag flags, UMatUsageFlags usage) const override {
+        return inner->allocate(data, flags, usage);
+    }
+    void deallocate(UMatData* data) const override {
+        inner->deallocate(data);
+    }
+};
+
+struct StageCounter {
+    string name;
+    uint64_t heap = 0;
+    uint64_t mats = 0;
+    double ms = 0.0;
+};
+
+int main(int argc, char** argv) {
+    string mask_path = argc > 1 ? argv[1] : "images/pikachu_mask.png";
+    int frames = argc > 2 ? atoi(argv[2]) : 600;
+    const int warmup = 120;
+    
+    static CountingMatAllocator mat_counter;
+    Mat::setDefaultAllocator(&mat_counter);
+    
+    Mat mask = imread(mask_path, IMREAD_UNCHANGED);
+    if (mask.empty()) {
+        cerr << "❌ Could not load mask: " << mask_path << endl;
+        return 1;
+    }
+    
+    // Synthetic 720p "camera" frame
+    Mat camera_frame(720, 1280, CV_8UC3);
+    for (int y = 0; y < camera_frame.rows; y++) {
+        Vec3b* row = camera_frame.ptr<Vec3b>(y);
+        for (int x = 0; x < camera_frame.cols; x++) {
+            row[x] = Vec3b(static_cast<uchar>(x), static_cast<uchar>(y), static_cast<uchar>(x + y));
+        }
+    }
+    
+    FramePool pool(4);
+    MaskRenderer renderer;
+    renderer.setMask(mask);
+    ParticleSystem particles;
+    particles.setParticleType("water");
+    Mat display;
+    
+    vector<StageCounter> stages = {{"capture (pool)"}, {"display copy"}, {"mask"}, {"particles"}, {"overlay text"}};
+    
+    auto measure = [&](StageCounter& stage, bool record, auto&& body) {
+        uint64_t heap_before = heap_allocations.load();
+        uint64_t mats_before = mat_counter.count.load();
+        auto start = chrono::steady_clock::now();
+        body();
+        if (record) {
+            stage.ms += Bench::elapsedMs(start);
+            stage.heap += heap_allocations.load() - heap_before;
+            stage.mats += mat_counter.count.load() - mats_before;
+        }
+    };
+    
+    for (int i = 0; i < warmup + frames; i++) {
+        bool record = i >= warmup;
+        
+        // Face drifts and breathes a little, like a live subject
+        DetectedFace face;
+        int size = 220 + (i % 9) - 4;
+        face.rect = Rect(520 + static_cast<int>(40 * sin(i * 0.05)), 200 + (i % 7), size, size);
+        face.center = Point2f(face.rect.x + size / 2.0f, face.rect.y + size / 2.0f);
+        face.face_angle = 5.0 * sin(i * 0.03);
+        face.mouth_open = (i / 60) % 2 == 0;
+        face.mouth_center = Point2f(face.center.x, face.center.y + size * 0.42f);
+        
+        Mat frame;
+        measure(stages[0], record, [&] {
+            frame = pool.acquire(camera_frame.size(), CV_8UC3);
+            camera_frame.copyTo(frame);
+        });
+        measure(stages[1], record, [&] { frame.copyTo(display); });
+        measure(stages[2], record, [&] { renderer.apply(display, face); });
+        measure(stages[3], record, [&] {
+            particles.setEmitPosition(face.mouth_center);
+            if (face.mouth_open) particles.startEmission(); else particles.stopEmission();
+            particles.update();
+            particles.draw(display);
+            particles.getBounds();
+        });
+        measure(stages[4], record, [&] {
+            putText(display, "SPACE: Photo | Q: Quit", Point(10, 30), FONT_HERSHEY_SIMPLEX, 0.7, Scalar(0, 255, 0), 2);
+        });
+    }
+    
+    cout << "🧮 Render path allocations (" << frames << " frames after " << warmup << " warm-up frames)" << endl;
+    uint64_t total_heap = 0, total_mats = 0;
+    for (const auto& stage : stages) {
+        total_heap += stage.heap;
+        total_mats += stage.mats;
+        cout << "  " << left << setw(16) << stage.name << right << fixed << setprecision(3)
+             << " heap/frame " << setw(8) << static_cast<double>(stage.heap) / frames
+             << " | Mat buffers/frame " << setw(8) << static_cast<double>(stage.mats) / frames
+             << " | " << stage.ms / frames << " ms" << endl;
+    }
+    cout << "  total heap allocations: " << total_heap << ", Mat buffer allocations: " << total_mats << endl;
+    cout << "  frame pool buffers: " << pool.size() << ", pool allocations: " << pool.getAllocationCount() << endl;
+    ParticleAllocatorStats particle_stats = particles.getAllocatorStats();
+    cout << "  particle arena blocks: " << particle_stats.arena_blocks
+         << ", spawned: " << particle_stats.spawned
+         << ", recycled: " << particle_stats.recycled << endl;
+    
+    Mat::setDefaultAllocator(nullptr);
+    return 0;
+}
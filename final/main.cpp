@@ -12,11 +12,35 @@
 #include "src/headers/cli_interface.h"
 #include "src/headers/face_mesh_app.h"
 #include "src/headers/env_loader.h"
+#include "src/headers/face_detector.h"
+#include "src/headers/batch_processor.h"
 
 using namespace std;
 
-int main() {
+/**
+ * @brief Process a recorded session without camera, window or MongoDB
+ */
+static int runBatch(int argc, char** argv) {
+    BatchConfig config;
+    config.detector = FaceDetectorSettings::fromEnv(EnvLoader::loadEnv());
+    if (!CLIInterface::parseBatchArguments(argc, argv, config)) {
+        CLIInterface::displayBatchUsage(argv[0]);
+        return 1;
+    }
+    
+    BatchProcessor processor(config);
+    bool completed = processor.run();
+    processor.printStats();
+    return completed ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
     try {
+        // Headless batch mode: ./face_mesh_app --batch <input> --output <path>
+        if (argc > 1) {
+            return runBatch(argc, argv);
+        }
+        
         // Display welcome banner
         CLIInterface::displayWelcomeBanner();
         
@@ -39,16 +63,34 @@ int main() {
             return 1;
         }
         
-        // Test MongoDB connection
-        bool mongo_connected = CLIInterface::testMongoDBConnection(connection_string);
+        // One pool for the whole app; the startup ping's connection is reused later
+        MongoConnection mongo_connection(connection_string);
+        bool mongo_connected = CLIInterface::testMongoDBConnection(mongo_connection);
         
         // Get user's Pokémon selection
         auto pokemon_selection = CLIInterface::getPokemonSelection();
         string mask_file = pokemon_selection.first;
         string pokemon_name = pokemon_selection.second;
         
+        // Face detection backend (FACE_DETECTOR=cascade|dnn, cascade by default)
+        FaceDetectorSettings detector_settings = FaceDetectorSettings::fromEnv(env);
+        
+        // Batched capture inserts (MONGODB_BATCH_SIZE, MONGODB_FLUSH_MS, MONGODB_WRITE_CONCERN, ...)
+        WriteBehindConfig write_config = WriteBehindConfig::fromEnv(env);
+        
+        // Landmark storage (MONGODB_FACE_FORMAT=expanded|compact, expanded by default)
+        FaceDocumentFormat face_format = FaceDocumentFormat::Expanded;
+        string format_name = env.count("MONGODB_FACE_FORMAT") ? env["MONGODB_FACE_FORMAT"] : "";
+        if (!format_name.empty() && !faceDocumentFormatFromName(format_name, face_format)) {
+            cerr << "⚠️  Unknown MONGODB_FACE_FORMAT '" << format_name << "', using expanded" << endl;
+        }
+        
+        // Local capture spool (MONGODB_SPOOL_PATH, "off" to write to MongoDB directly)
+        SpoolConfig spool_config = SpoolConfig::fromEnv(env);
+        
         // Create and run the face mesh application
-        FaceMeshApp app(connection_string, mask_file, pokemon_name);
+        FaceMeshApp app(mongo_connection, mask_file, pokemon_name, detector_settings, write_config,
+                        face_format, spool_config, mongo_connected);
         app.run();
         
         // Display goodbye message
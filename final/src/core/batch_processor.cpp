@@ -0,0 +1,335 @@
+#include "../headers/batch_processor.h"
+#include "../headers/mask_asset.h"
+#include "../headers/particle_kinds.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+    bool hasVideoExtension(const string& path) {
+        string extension = filesystem::path(path).extension().string();
+        transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        return extension == ".mp4" || extension == ".avi" || extension == ".mkv" || extension == ".mov";
+    }
+}
+
+BatchProcessor::BatchProcessor(const BatchConfig& config)
+    : config(config),
+      pool(config.workers),
+      analyzer(pool),
+      effects(pool),
+      read_recording(false),
+      next_image(0),
+      input_fps(30.0),
+      write_video(false),
+      frame_count(0),
+      face_count(0),
+      resized_count(0),
+      wall_ms(0.0) {
+    size_t window = config.window > 0 ? config.window : (pool.size() + 1) * 4;
+    frames.resize(window);
+    times.resize(window);
+    grays.resize(window);
+    detections.resize(window);
+    dirty.reserve(16);
+}
+
+bool BatchProcessor::run() {
+    auto start = chrono::steady_clock::now();
+    
+    if (!openInput() || !loadDetectors()) return false;
+    
+    if (!config.mask_file.empty()) {
+        MaskAsset mask;
+        string loaded_from;
+        if (!MaskAssets::load(config.mask_file, mask, loaded_from)) {
+            cerr << "❌ Mask not found: " << config.mask_file << endl;
+            return false;
+        }
+        effects.setMask(mask);
+    }
+    effects.setParticleKind(config.particle_kind);
+    effects.setSeed(config.seed);
+    
+    if (!config.faces_csv.empty()) {
+        faces_out.open(config.faces_csv);
+        if (!faces_out) {
+            cerr << "❌ Could not write " << config.faces_csv << endl;
+            return false;
+        }
+        faces_out << "frame,time_s,face_id,x,y,width,height,angle,mouth_open" << endl;
+    }
+    
+    cout << "🎞️  Batch processing " << config.input << " -> " << config.output
+         << " (" << pool.size() + 1 << " threads, window " << frames.size()
+         << " frames, seed " << config.seed << ")" << endl;
+    
+    uint64_t first_frame = 0;
+    size_t count;
+    while ((count = readWindow()) > 0) {
+        if (first_frame == 0 && !openOutput(frames[0].size())) return false;
+        
+        detectWindow(count);
+        composeWindow(count, first_frame);
+        writeWindow(count, first_frame);
+        
+        first_frame += count;
+        if (first_frame % 300 < count) {
+            cout << "   ⏳ " << first_frame << " frames" << endl;
+        }
+    }
+    
+    writer.release();
+    faces_out.close();
+    wall_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return frame_count > 0;
+}
+
+bool BatchProcessor::openInput() {
+    // An image directory first, otherwise a video file
+    if (filesystem::is_directory(config.input)) {
+        for (const auto& entry : filesystem::directory_iterator(config.input)) {
+            string extension = entry.path().extension().string();
+            transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+            if (extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".bmp") {
+                image_files.push_back(entry.path().string());
+            }
+        }
+        sort(image_files.begin(), image_files.end());
+        input_fps = config.fps > 0.0 ? config.fps : 30.0;
+        if (image_files.empty()) {
+            cerr << "❌ No images in " << config.input << endl;
+            return false;
+        }
+        return true;
+    }
+    
+    // Recordings keep the live capture times; the rate is only for the output video
+    if (SessionReader::isRecording(config.input)) {
+        if (!recording.open(config.input)) {
+            cerr << "❌ Not a readable recording: " << config.input << endl;
+            return false;
+        }
+        read_recording = true;
+        input_fps = config.fps > 0.0 ? config.fps : 30.0;
+        return true;
+    }
+    
+    if (!video.open(config.input)) {
+        cerr << "❌ Could not open " << config.input << endl;
+        return false;
+    }
+    double video_fps = video.get(CAP_PROP_FPS);
+    input_fps = config.fps > 0.0 ? config.fps : (video_fps > 0.0 ? video_fps : 30.0);
+    return true;
+}
+
+bool BatchProcessor::openOutput(Size frame_size) {
+    write_video = hasVideoExtension(config.output);
+    if (!write_video) {
+        error_code error;
+        filesystem::create_directories(config.output, error);
+        if (!filesystem::is_directory(config.output)) {
+            cerr << "❌ Could not create output directory " << config.output << endl;
+            return false;
+        }
+        return true;
+    }
+    
+    string extension = filesystem::path(config.output).extension().string();
+    int fourcc = extension == ".avi" ? VideoWriter::fourcc('M', 'J', 'P', 'G')
+                                     : VideoWriter::fourcc('m', 'p', '4', 'v');
+    if (!writer.open(config.output, fourcc, input_fps, frame_size)) {
+        cerr << "❌ Could not write video " << config.output << endl;
+        return false;
+    }
+    return true;
+}
+
+bool BatchProcessor::loadDetectors() {
+    // Every thread that can run a detect item at once gets its own detector
+    size_t count = pool.size() + 1;
+    string loaded_from;
+    for (size_t i = 0; i < count; i++) {
+        unique_ptr<FaceDetector> detector = createFaceDetector(config.detector, defaultCascadePaths(), loaded_from);
+        if (!detector) {
+            cerr << "❌ Could not load the " << backendName(config.detector.backend) << " face detector" << endl;
+            return false;
+        }
+        idle_detectors.push_back(detector.get());
+        detectors.push_back(std::move(detector));
+    }
+    cout << "🔎 Detector: " << detectors[0]->name() << " (" << loaded_from << ")" << endl;
+    return true;
+}
+
+size_t BatchProcessor::readWindow() {
+    size_t limit = frames.size();
+    if (config.max_frames > 0) {
+        limit = min<uint64_t>(limit, config.max_frames - min<uint64_t>(config.max_frames, frame_count));
+    }
+    if (limit == 0) return 0;
+    
+    auto start = chrono::steady_clock::now();
+    size_t count = 0;
+    
+    if (!image_files.empty()) {
+        count = min(limit, image_files.size() - next_image);
+        pool.parallelFor(count, [&](size_t i) {
+            frames[i] = imread(image_files[next_image + i], IMREAD_COLOR);
+        });
+        next_image += count;
+        
+        // Unreadable files are skipped so frame numbers stay contiguous
+        size_t kept = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (frames[i].empty()) continue;
+            if (kept != i) swap(frames[kept], frames[i]);
+            kept++;
+        }
+        count = kept;
+        if (count == 0 && next_image < image_files.size()) return readWindow();
+        
+        // VideoWriter silently drops frames of any other size than the one it was opened with
+        if (count > 0 && image_size.empty()) image_size = frames[0].size();
+        if (hasVideoExtension(config.output)) {
+            for (size_t i = 0; i < count; i++) {
+                if (frames[i].size() == image_size) continue;
+                if (resized_count++ == 0) {
+                    cerr << "⚠️  Images differ in size; scaling them to " << image_size.width << "x"
+                         << image_size.height << " for " << config.output << endl;
+                }
+                Mat scaled;
+                resize(frames[i], scaled, image_size, 0, 0, INTER_AREA);
+                frames[i] = scaled;
+            }
+        }
+    } else if (read_recording) {
+        while (count < limit && recording.read(frames[count], times[count])) {
+            count++;
+        }
+    } else {
+        // Decoding into the same Mats reuses their buffers
+        while (count < limit && video.read(frames[count]) && !frames[count].empty()) {
+            count++;
+        }
+    }
+    
+    if (!read_recording) {
+        for (size_t i = 0; i < count; i++) {
+            times[i] = (frame_count + i) / input_fps;
+        }
+    }
+    
+    if (count > 0) {
+        auto elapsed = chrono::steady_clock::now() - start;
+        decode.record(elapsed / static_cast<int>(count));
+    }
+    return count;
+}
+
+void BatchProcessor::detectWindow(size_t count) {
+    pool.parallelFor(count, [&](size_t i) {
+        auto start = chrono::steady_clock::now();
+        FaceDetector* detector = acquireDetector();
+        
+        cvtColor(frames[i], grays[i], COLOR_BGR2GRAY);
+        equalizeHist(grays[i], grays[i]);
+        detector->detect(frames[i], grays[i], detections[i], nullptr);
+        
+        releaseDetector(detector);
+        detect.record(chrono::steady_clock::now() - start);
+    });
+}
+
+void BatchProcessor::composeWindow(size_t count, uint64_t first_frame) {
+    for (size_t i = 0; i < count; i++) {
+        auto start = chrono::steady_clock::now();
+        uint64_t frame_index = first_frame + i;
+        double time_s = times[i];
+        
+        analyzer.analyze(frames[i], detections[i], time_s, faces);
+        effects.compose(frames[i], faces, dirty);
+        
+        frame_count++;
+        face_count += faces.size();
+        compose.record(chrono::steady_clock::now() - start);
+        
+        if (faces_out.is_open()) {
+            for (const auto& face : faces) {
+                faces_out << frame_index << "," << fixed << setprecision(3) << time_s << ","
+                          << face.face_id << "," << face.rect.x << "," << face.rect.y << ","
+                          << face.rect.width << "," << face.rect.height << ","
+                          << setprecision(2) << face.face_angle << "," << (face.mouth_open ? 1 : 0) << "\n";
+            }
+        }
+    }
+}
+
+void BatchProcessor::writeWindow(size_t count, uint64_t first_frame) {
+    auto start = chrono::steady_clock::now();
+    
+    if (write_video) {
+        for (size_t i = 0; i < count; i++) {
+            writer.write(frames[i]);
+        }
+    } else {
+        vector<int> params = {IMWRITE_JPEG_QUALITY, config.jpeg_quality};
+        pool.parallelFor(count, [&](size_t i) {
+            char name[32];
+            snprintf(name, sizeof(name), "frame_%06llu.jpg", static_cast<unsigned long long>(first_frame + i));
+            imwrite((filesystem::path(config.output) / name).string(), frames[i], params);
+        });
+    }
+    
+    encode.record((chrono::steady_clock::now() - start) / static_cast<int>(count));
+}
+
+FaceDetector* BatchProcessor::acquireDetector() {
+    lock_guard<mutex> guard(detector_lock);
+    FaceDetector* detector = idle_detectors.back();
+    idle_detectors.pop_back();
+    return detector;
+}
+
+void BatchProcessor::releaseDetector(FaceDetector* detector) {
+    lock_guard<mutex> guard(detector_lock);
+    idle_detectors.push_back(detector);
+}
+
+void BatchProcessor::printStats() const {
+    auto printStage = [](const string& name, const StageStats& stage) {
+        cout << "  " << left << setw(12) << name << right
+             << " avg: " << fixed << setprecision(2) << stage.averageMs() << " ms/frame"
+             << " | max: " << stage.maxMs() << " ms" << endl;
+    };
+    
+    double seconds = wall_ms / 1000.0;
+    cout << "\n🎞️  BATCH STATISTICS:" << endl;
+    cout << "  frames: " << frame_count << " | faces: " << face_count
+         << " | wall time: " << fixed << setprecision(2) << seconds << " s"
+         << " | throughput: " << (seconds > 0.0 ? frame_count / seconds : 0.0) << " fps" << endl;
+    printStage("decode", decode);
+    printStage("detect", detect);
+    printStage("compose", compose);
+    printStage("encode", encode);
+    
+    FaceEffectsStats effect_stats = effects.getStats();
+    cout << "  faces created: " << analyzer.getFacesCreated()
+         << " | particles spawned: " << effect_stats.particle_alloc.spawned << endl;
+    if (resized_count > 0) {
+        cout << "  images scaled to the video size: " << resized_count << endl;
+    }
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+}
+
+uint64_t BatchProcessor::getFrameCount() const {
+    return frame_count;
+}
+
+uint64_t BatchProcessor::getFaceCount() const {
+    return face_count;
+}
@@ -0,0 +1,259 @@
+#include "../headers/blend_kernels.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+
+namespace BlendKernels {
+    
+    namespace {
+        
+        /**
+         * @brief 8.8 fixed-point multiplier so that (alpha * K) >> 8 ~= alpha / 255 * scale * 256
+         */
+        int alphaMultiplier(float alpha_scale) {
+            float clamped = min(1.0f, max(0.0f, alpha_scale));
+            return min(257, static_cast<int>(clamped * 65536.0f / 255.0f + 0.5f));
+        }
+        
+        /**
+         * @brief Blend one row of pixels: out = (img * (256 - a) + spr * a) >> 8
+         *
+         * The weighted sum is a convex combination scaled by 256, so it never
+         * exceeds 65280 and fits an unsigned 16-bit lane without saturating.
+         */
+        void blendRow(uchar* dst, const uchar* src, int width, int multiplier,
+                      int dark_threshold, bool use_simd) {
+            int x = 0;
+            
+#if CV_SIMD128
+            if (use_simd) {
+                const int lanes = v_uint8x16::nlanes;
+                const v_uint16x8 k = v_setall_u16(static_cast<ushort>(multiplier));
+                const v_uint16x8 full = v_setall_u16(256);
+                const v_uint16x8 threshold = v_setall_u16(static_cast<ushort>(dark_threshold));
+                
+                for (; x <= width - lanes; x += lanes) {
+                    v_uint8x16 fb, fg, fr, sb, sg, sr, sa;
+                    v_load_deinterleave(dst + x * 3, fb, fg, fr);
+                    v_load_deinterleave(src + x * 4, sb, sg, sr, sa);
+                    
+                    v_uint16x8 fb0, fb1, fg0, fg1, fr0, fr1;
+                    v_uint16x8 sb0, sb1, sg0, sg1, sr0, sr1, sa0, sa1;
+                    v_expand(fb, fb0, fb1); v_expand(fg, fg0, fg1); v_expand(fr, fr0, fr1);
+                    v_expand(sb, sb0, sb1); v_expand(sg, sg0, sg1); v_expand(sr, sr0, sr1);
+                    v_expand(sa, sa0, sa1);
+                    
+                    // Effective alpha in 0..256, zeroed for dark sprite pixels
+                    v_uint16x8 a0 = v_shr<8>(v_mul_wrap(sa0, k));
+                    v_uint16x8 a1 = v_shr<8>(v_mul_wrap(sa1, k));
+                    a0 = v_and(a0, v_gt(v_add(v_add(sb0, sg0), sr0), threshold));
+                    a1 = v_and(a1, v_gt(v_add(v_add(sb1, sg1), sr1), threshold));
+                    v_uint16x8 i0 = v_sub(full, a0);
+                    v_uint16x8 i1 = v_sub(full, a1);
+                    
+                    auto mix = [&](const v_uint16x8& img, const v_uint16x8& spr,
+                                   const v_uint16x8& a, const v_uint16x8& inv) {
+                        return v_shr<8>(v_add(v_mul_wrap(img, inv), v_mul_wrap(spr, a)));
+                    };
+                    
+                    v_store_interleave(dst + x * 3,
+                                       v_pack(mix(fb0, sb0, a0, i0), mix(fb1, sb1, a1, i1)),
+                                       v_pack(mix(fg0, sg0, a0, i0), mix(fg1, sg1, a1, i1)),
+                                       v_pack(mix(fr0, sr0, a0, i0), mix(fr1, sr1, a1, i1)));
+                }
+            }
+#else
+            (void)use_simd;
+#endif
+            
+            // Scalar tail (and fallback)
+            for (; x < width; x++) {
+                const uchar* s = src + x * 4;
+                uchar* d = dst + x * 3;
+                if (s[0] + s[1] + s[2] <= dark_threshold) continue;
+                int a = (s[3] * multiplier) >> 8;
+                if (a == 0) continue;
+                int inv = 256 - a;
+                d[0] = static_cast<uchar>((d[0] * inv + s[0] * a) >> 8);
+                d[1] = static_cast<uchar>((d[1] * inv + s[1] * a) >> 8);
+                d[2] = static_cast<uchar>((d[2] * inv + s[2] * a) >> 8);
+            }
+        }
+        
+        /**
+         * @brief Blend one row of premultiplied pixels: out = ((img * (256 - a) + 128) >> 8) + color
+         *
+         * The 8-bit alpha is widened to 0..256 with a + (a >> 7) so that 255
+         * maps to a full replacement.
+         */
+        void blendPremultipliedRow(uchar* dst, const uchar* src, int width, bool use_simd) {
+            int x = 0;
+            
+#if CV_SIMD128
+            if (use_simd) {
+                const int lanes = v_uint8x16::nlanes;
+                const v_uint16x8 full = v_setall_u16(256);
+                const v_uint16x8 half = v_setall_u16(128);
+                
+                for (; x <= width - lanes; x += lanes) {
+                    v_uint8x16 fb, fg, fr, sb, sg, sr, sa;
+                    v_load_deinterleave(dst + x * 3, fb, fg, fr);
+                    v_load_deinterleave(src + x * 4, sb, sg, sr, sa);
+                    
+                    v_uint16x8 fb0, fb1, fg0, fg1, fr0, fr1;
+                    v_uint16x8 sb0, sb1, sg0, sg1, sr0, sr1, sa0, sa1;
+                    v_expand(fb, fb0, fb1); v_expand(fg, fg0, fg1); v_expand(fr, fr0, fr1);
+                    v_expand(sb, sb0, sb1); v_expand(sg, sg0, sg1); v_expand(sr, sr0, sr1);
+                    v_expand(sa, sa0, sa1);
+                    
+                    v_uint16x8 i0 = v_sub(full, v_add(sa0, v_shr<7>(sa0)));
+                    v_uint16x8 i1 = v_sub(full, v_add(sa1, v_shr<7>(sa1)));
+                    
+                    auto mix = [&](const v_uint16x8& img, const v_uint16x8& color, const v_uint16x8& inv) {
+                        return v_add(v_shr<8>(v_add(v_mul_wrap(img, inv), half)), color);
+                    };
+                    
+                    // v_pack saturates, which absorbs the rounding in the premultiplied colors
+                    v_store_interleave(dst + x * 3,
+                                       v_pack(mix(fb0, sb0, i0), mix(fb1, sb1, i1)),
+                                       v_pack(mix(fg0, sg0, i0), mix(fg1, sg1, i1)),
+                                       v_pack(mix(fr0, sr0, i0), mix(fr1, sr1, i1)));
+                }
+            }
+#else
+            (void)use_simd;
+#endif
+            
+            for (; x < width; x++) {
+                const uchar* s = src + x * 4;
+                if (s[3] == 0) continue;
+                uchar* d = dst + x * 3;
+                int inv = 256 - (s[3] + (s[3] >> 7));
+                d[0] = static_cast<uchar>(min(255, ((d[0] * inv + 128) >> 8) + s[0]));
+                d[1] = static_cast<uchar>(min(255, ((d[1] * inv + 128) >> 8) + s[1]));
+                d[2] = static_cast<uchar>(min(255, ((d[2] * inv + 128) >> 8) + s[2]));
+            }
+        }
+        
+        /**
+         * @brief Clip the sprite rectangle against the frame once
+         * @param src_offset Sprite pixel that lands on the clipped rectangle's corner
+         */
+        Rect clipToFrame(const Mat& frame, const Mat& sprite, Point origin, Point& src_offset) {
+            Rect placed(origin.x, origin.y, sprite.cols, sprite.rows);
+            Rect clipped = placed & Rect(0, 0, frame.cols, frame.rows);
+            src_offset = Point(clipped.x - origin.x, clipped.y - origin.y);
+            return clipped;
+        }
+    }
+    
+    Rect blendBGRA(Mat& frame, const Mat& sprite, Point origin, float alpha_scale,
+                   int dark_threshold, bool use_simd) {
+        CV_Assert(frame.type() == CV_8UC3 && sprite.type() == CV_8UC4);
+        
+        Point src_offset;
+        Rect area = clipToFrame(frame, sprite, origin, src_offset);
+        if (area.empty()) return Rect();
+        
+        int multiplier = alphaMultiplier(alpha_scale);
+        for (int y = 0; y < area.height; y++) {
+            uchar* dst = frame.ptr<uchar>(area.y + y) + area.x * 3;
+            const uchar* src = sprite.ptr<uchar>(src_offset.y + y) + src_offset.x * 4;
+            blendRow(dst, src, area.width, multiplier, dark_threshold, use_simd);
+        }
+        return area;
+    }
+    
+    Rect blendBGRAReference(Mat& frame, const Mat& sprite, Point origin, float alpha_scale,
+                            int dark_threshold) {
+        for (int y = 0; y < sprite.rows; y++) {
+            for (int x = 0; x < sprite.cols; x++) {
+                int img_x = origin.x + x;
+                int img_y = origin.y + y;
+                
+                if (img_x >= 0 && img_x < frame.cols && img_y >= 0 && img_y < frame.rows) {
+                    Vec4b mask_pixel = sprite.at<Vec4b>(y, x);
+                    Vec3b img_pixel = frame.at<Vec3b>(img_y, img_x);
+                    float alpha = mask_pixel[3] / 255.0f * alpha_scale;
+                    
+                    if (mask_pixel[0] + mask_pixel[1] + mask_pixel[2] > dark_threshold) {
+                        frame.at<Vec3b>(img_y, img_x) = Vec3b(
+                            static_cast<uchar>(img_pixel[0] * (1 - alpha) + mask_pixel[0] * alpha),
+                            static_cast<uchar>(img_pixel[1] * (1 - alpha) + mask_pixel[1] * alpha),
+                            static_cast<uchar>(img_pixel[2] * (1 - alpha) + mask_pixel[2] * alpha)
+                        );
+                    }
+                }
+            }
+        }
+        return Rect(origin.x, origin.y, sprite.cols, sprite.rows) & Rect(0, 0, frame.cols, frame.rows);
+    }
+    
+    Rect blendPremultiplied(Mat& frame, const Mat& sprite, Point origin,
+                            const vector<OpaqueSpan>* spans, bool use_simd) {
+        CV_Assert(frame.type() == CV_8UC3 && sprite.type() == CV_8UC4);
+        
+        Point src_offset;
+        Rect area = clipToFrame(frame, sprite, origin, src_offset);
+        if (area.empty()) return Rect();
+        
+        if (spans == nullptr) {
+            for (int y = 0; y < area.height; y++) {
+                uchar* dst = frame.ptr<uchar>(area.y + y) + area.x * 3;
+                const uchar* src = sprite.ptr<uchar>(src_offset.y + y) + src_offset.x * 4;
+                blendPremultipliedRow(dst, src, area.width, use_simd);
+            }
+            return area;
+        }
+        
+        // Only walk the runs that actually carry coverage, clipped to the frame
+        int row_begin = src_offset.y;
+        int row_end = src_offset.y + area.height;
+        int col_begin = src_offset.x;
+        int col_end = src_offset.x + area.width;
+        for (const auto& span : *spans) {
+            if (span.y < row_begin || span.y >= row_end) continue;
+            int x0 = max(span.x_begin, col_begin);
+            int x1 = min(span.x_end, col_end);
+            if (x0 >= x1) continue;
+            
+            uchar* dst = frame.ptr<uchar>(origin.y + span.y) + (origin.x + x0) * 3;
+            const uchar* src = sprite.ptr<uchar>(span.y) + x0 * 4;
+            blendPremultipliedRow(dst, src, x1 - x0, use_simd);
+        }
+        return area;
+    }
+    
+    Rect findOpaqueSpans(const Mat& sprite, vector<OpaqueSpan>& spans) {
+        CV_Assert(sprite.type() == CV_8UC4);
+        spans.clear();
+        
+        int min_x = sprite.cols, min_y = sprite.rows, max_x = -1, max_y = -1;
+        for (int y = 0; y < sprite.rows; y++) {
+            const uchar* row = sprite.ptr<uchar>(y);
+            int x = 0;
+            while (x < sprite.cols) {
+                while (x < sprite.cols && row[x * 4 + 3] == 0) x++;
+                if (x >= sprite.cols) break;
+                int begin = x;
+                while (x < sprite.cols && row[x * 4 + 3] != 0) x++;
+                spans.push_back({y, begin, x});
+                
+                min_x = min(min_x, begin);
+                max_x = max(max_x, x - 1);
+                min_y = min(min_y, y);
+                max_y = max(max_y, y);
+            }
+        }
+        
+        if (max_x < 0) return Rect();
+        return Rect(min_x, min_y, max_x - min_x + 1, max_y - min_y + 1);
+    }
+    
+    bool simdAvailable() {
+#if CV_SIMD128
+        return true;
+#else
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,122 @@
+#include "../headers/cascade_face_detector.h"
+#include <algorithm>
+#include <cmath>
+
+CascadeFaceDetector::CascadeFaceDetector(DetectionStrategy initial)
+    : strategy(initial), loaded(false) {
+}
+
+string CascadeFaceDetector::load(const vector<string>& paths) {
+    for (const auto& path : paths) {
+        if (cascade.load(path)) {
+            loaded = true;
+            return path;
+        }
+    }
+    return "";
+}
+
+void CascadeFaceDetector::detect(const Mat& gray, vector<Rect>& faces, const Rect* previous) {
+    faces.clear();
+    if (!loaded || gray.empty()) return;
+    
+    if (strategy == DetectionStrategy::FullFrame) {
+        detectFullFrame(gray, faces);
+    } else {
+        detectRoiPyramid(gray, faces, previous);
+    }
+}
+
+void CascadeFaceDetector::detect(const Mat& image, const Mat& gray, vector<Rect>& faces, const Rect* previous) {
+    (void)image;
+    detect(gray, faces, previous);
+}
+
+void CascadeFaceDetector::detectFullFrame(const Mat& gray, vector<Rect>& faces) {
+    cascade.detectMultiScale(gray, faces, config.scale_factor, config.min_neighbors, 0, config.min_size);
+}
+
+void CascadeFaceDetector::detectRoiPyramid(const Mat& gray, vector<Rect>& faces, const Rect* previous) {
+    Rect frame_rect(0, 0, gray.cols, gray.rows);
+    Rect search = frame_rect;
+    double scale = config.downscale > 0.0 && config.downscale <= 1.0 ? config.downscale : 1.0;
+    
+    // The cascade window is 20x20: downscale no further than keeps the smallest face
+    // at 20 px, so this strategy finds faces as small as FullFrame does
+    int min_full = min(config.min_size.width, config.min_size.height);
+    scale = min_full > 20 ? max(scale, 20.0 / min_full) : 1.0;
+    int min_side = max(20, static_cast<int>(lround(min_full * scale)));
+    Size min_face(min_side, min_side);
+    Size max_face;
+    
+    if (previous != nullptr && !previous->empty()) {
+        int grow_x = static_cast<int>(previous->width * config.roi_expand);
+        int grow_y = static_cast<int>(previous->height * config.roi_expand);
+        search = Rect(previous->x - grow_x, previous->y - grow_y,
+                      previous->width + 2 * grow_x, previous->height + 2 * grow_y) & frame_rect;
+        
+        int lo = max(min_side, static_cast<int>(previous->width * config.min_size_ratio * scale));
+        int hi = max(lo + 1, static_cast<int>(previous->width * config.max_size_ratio * scale));
+        min_face = Size(lo, lo);
+        max_face = Size(hi, hi);
+    }
+    
+    if (search.width < min_side || search.height < min_side) return;
+    
+    // small_gray is only ever written by resize so it never aliases the caller's frame
+    Mat search_image;
+    if (scale < 1.0) {
+        resize(gray(search), small_gray, Size(), scale, scale, INTER_AREA);
+        search_image = small_gray;
+    } else {
+        search_image = gray(search);
+    }
+    
+    // Region too small for the requested face size
+    if (search_image.cols < min_face.width || search_image.rows < min_face.height) return;
+    
+    cascade.detectMultiScale(search_image, small_faces, config.scale_factor, config.min_neighbors,
+                             0, min_face, max_face);
+    
+    // Map back to full-resolution frame coordinates
+    for (const auto& r : small_faces) {
+        Rect mapped(search.x + static_cast<int>(r.x / scale),
+                    search.y + static_cast<int>(r.y / scale),
+                    static_cast<int>(r.width / scale),
+                    static_cast<int>(r.height / scale));
+        mapped &= frame_rect;
+        if (!mapped.empty()) faces.push_back(mapped);
+    }
+}
+
+bool CascadeFaceDetector::isLoaded() const {
+    return loaded;
+}
+
+string CascadeFaceDetector::name() const {
+    return "cascade (" + strategyName(strategy) + ")";
+}
+
+void CascadeFaceDetector::setStrategy(DetectionStrategy new_strategy) {
+    strategy = new_strategy;
+}
+
+DetectionStrategy CascadeFaceDetector::getStrategy() const {
+    return strategy;
+}
+
+void CascadeFaceDetector::setConfig(const CascadeSearchConfig& new_config) {
+    config = new_config;
+}
+
+const CascadeSearchConfig& CascadeFaceDetector::getConfig() const {
+    return config;
+}
+
+string CascadeFaceDetector::strategyName(DetectionStrategy value) {
+    switch (value) {
+        case DetectionStrategy::FullFrame: return "full-frame";
+        case DetectionStrategy::RoiPyramid: return "roi-pyramid";
+    }
+    return "unknown";
+}
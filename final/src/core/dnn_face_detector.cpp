@@ -0,0 +1,102 @@
+#include "../headers/dnn_face_detector.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    bool endsWith(const string& value, const string& suffix) {
+        return value.size() >= suffix.size() &&
+               value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+DnnFaceDetector::DnnFaceDetector(const DnnDetectorConfig& config)
+    : config(config), model(Model::ResNetSsd), loaded(false) {
+    if (this->config.input_size.width <= 0 || this->config.input_size.height <= 0) {
+        this->config.input_size = Size(300, 300);
+    }
+}
+
+bool DnnFaceDetector::load() {
+    loaded = false;
+    model = endsWith(config.model_path, ".onnx") ? Model::YuNet : Model::ResNetSsd;
+    
+    try {
+        if (model == Model::YuNet) {
+            yunet = FaceDetectorYN::create(config.model_path, "", config.input_size, config.confidence);
+            loaded = yunet != nullptr;
+        } else {
+            net = dnn::readNetFromCaffe(config.config_path, config.model_path);
+            net.setPreferableBackend(dnn::DNN_BACKEND_OPENCV);
+            net.setPreferableTarget(dnn::DNN_TARGET_CPU);
+            loaded = !net.empty();
+        }
+    } catch (const cv::Exception& e) {
+        cerr << "❌ Could not load DNN face model " << config.model_path << ": " << e.what() << endl;
+        loaded = false;
+    }
+    return loaded;
+}
+
+void DnnFaceDetector::detect(const Mat& image, const Mat& gray, vector<Rect>& faces, const Rect* previous) {
+    (void)gray;
+    (void)previous;
+    faces.clear();
+    if (!loaded || image.empty()) return;
+    
+    // resize keeps writing into the same buffer while the frame size is stable
+    resize(image, resized, config.input_size, 0, 0, INTER_LINEAR);
+    
+    if (model == Model::YuNet) {
+        detectYuNet(image, faces);
+    } else {
+        detectSsd(image, faces);
+    }
+}
+
+void DnnFaceDetector::detectSsd(const Mat& image, vector<Rect>& faces) {
+    // Mean values the ResNet-SSD face model was trained with
+    dnn::blobFromImage(resized, blob, 1.0, Size(), Scalar(104.0, 177.0, 123.0), false, false);
+    net.setInput(blob);
+    net.forward(output);
+    
+    // Output is 1x1xNx7: [image id, class, score, x1, y1, x2, y2] in 0..1
+    Rect frame_rect(0, 0, image.cols, image.rows);
+    int count = output.size[2];
+    const float* row = output.ptr<float>();
+    for (int i = 0; i < count; i++, row += 7) {
+        if (row[2] < config.confidence) continue;
+        Rect face(Point(cvRound(row[3] * image.cols), cvRound(row[4] * image.rows)),
+                  Point(cvRound(row[5] * image.cols), cvRound(row[6] * image.rows)));
+        face &= frame_rect;
+        if (!face.empty()) faces.push_back(face);
+    }
+}
+
+void DnnFaceDetector::detectYuNet(const Mat& image, vector<Rect>& faces) {
+    yunet->detect(resized, output);
+    
+    // One row per face: x, y, w, h, 5 landmarks, score (network coordinates)
+    Rect frame_rect(0, 0, image.cols, image.rows);
+    float sx = static_cast<float>(image.cols) / config.input_size.width;
+    float sy = static_cast<float>(image.rows) / config.input_size.height;
+    for (int i = 0; i < output.rows; i++) {
+        const float* row = output.ptr<float>(i);
+        Rect face(cvRound(row[0] * sx), cvRound(row[1] * sy), cvRound(row[2] * sx), cvRound(row[3] * sy));
+        face &= frame_rect;
+        if (!face.empty()) faces.push_back(face);
+    }
+}
+
+bool DnnFaceDetector::isLoaded() const {
+    return loaded;
+}
+
+string DnnFaceDetector::name() const {
+    string network = model == Model::YuNet ? "yunet" : "resnet-ssd";
+    return "dnn (" + network + " " + to_string(config.input_size.width) + "x" +
+           to_string(config.input_size.height) + ")";
+}
+
+const DnnDetectorConfig& DnnFaceDetector::getConfig() const {
+    return config;
+}
@@ -0,0 +1,321 @@
+#include "../headers/face_analyzer.h"
+#include "../headers/landmark_template.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+FaceAnalyzer::FaceAnalyzer(ThreadPool& pool, size_t max_faces)
+    : pool(pool),
+      next_face_id(1),
+      tracking_enabled(true),
+      smoothing_enabled(true),
+      frame_time(0.0),
+      max_faces(min(max(static_cast<size_t>(1), max_faces), static_cast<size_t>(MAX_FACES))),
+      match_iou(0.3f),
+      max_missed_detections(1),
+      full_scan_interval(4),
+      cascade_runs(0),
+      tracked_frames(0),
+      lost_count(0),
+      faces_created(0) {
+    tracks.reserve(this->max_faces);
+    visible_tracks.reserve(this->max_faces);
+}
+
+string FaceAnalyzer::loadCascade(const vector<string>& paths) {
+    auto cascade = make_unique<CascadeFaceDetector>();
+    string loaded_path = cascade->load(paths);
+    if (!loaded_path.empty()) setDetector(std::move(cascade));
+    return loaded_path;
+}
+
+void FaceAnalyzer::setDetector(unique_ptr<FaceDetector> new_detector) {
+    detector = std::move(new_detector);
+    reset();
+}
+
+bool FaceAnalyzer::isReady() const {
+    return detector && detector->isLoaded();
+}
+
+void FaceAnalyzer::analyze(const Mat& image, FaceList& faces) {
+    analyze(image, chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count(), faces);
+}
+
+void FaceAnalyzer::analyze(const Mat& image, double time_s, FaceList& faces) {
+    faces.clear();
+    if (!isReady() || image.empty()) return;
+    prepareFrame(image, time_s);
+    
+    // Between detector runs follow every face with a cheap local search;
+    // any lost face (or the detect interval) brings the detector back
+    bool need_detection = !tracking_enabled || tracks.empty();
+    for (const auto& track : tracks) {
+        if (track.tracker.needsDetection()) need_detection = true;
+    }
+    if (!need_detection && trackAll()) {
+        tracked_frames++;
+    } else {
+        detectAndMatch(image);
+    }
+    
+    describeVisible(image, faces);
+}
+
+void FaceAnalyzer::analyze(const Mat& image, const vector<Rect>& found, double time_s, FaceList& faces) {
+    faces.clear();
+    if (image.empty()) return;
+    prepareFrame(image, time_s);
+    
+    detections.assign(found.begin(), found.end());
+    cascade_runs++;
+    matchDetections();
+    
+    describeVisible(image, faces);
+}
+
+void FaceAnalyzer::prepareFrame(const Mat& image, double time_s) {
+    frame_time = time_s;
+    
+    // The cascade backend and tracker use the equalized frame; mouth checks use
+    // the plain one, where the cheek/mouth brightness ratios hold
+    cvtColor(image, luma, COLOR_BGR2GRAY);
+    equalizeHist(luma, gray);
+}
+
+void FaceAnalyzer::describeVisible(const Mat& image, FaceList& faces) {
+    // Describe the faces in parallel; each item only reads the frame
+    visible_tracks.clear();
+    for (auto& track : tracks) {
+        if (track.tracked) visible_tracks.push_back(&track);
+    }
+    if (visible_tracks.empty()) return;
+    
+    integral(luma, luma_sum, CV_32S);
+    faces.count = visible_tracks.size();
+    pool.parallelFor(visible_tracks.size(), [&](size_t i) {
+        describeFace(image, *visible_tracks[i], faces[i]);
+    });
+}
+
+bool FaceAnalyzer::trackAll() {
+    track_ok.assign(tracks.size(), 0);
+    pool.parallelFor(tracks.size(), [&](size_t i) {
+        Rect rect;
+        if (tracks[i].tracker.track(gray, rect)) {
+            tracks[i].rect = rect;
+            track_ok[i] = 1;
+        }
+    });
+    
+    bool all_tracked = true;
+    for (size_t i = 0; i < tracks.size(); i++) {
+        if (!track_ok[i]) {
+            lost_count++;
+            all_tracked = false;
+        }
+    }
+    return all_tracked;
+}
+
+void FaceAnalyzer::detectAndMatch(const Mat& image) {
+    // With a single face the detector may search around it, but every few
+    // runs the whole frame is scanned so newcomers are picked up
+    const Rect* hint = nullptr;
+    if (tracks.size() == 1 && cascade_runs % full_scan_interval != 0) {
+        hint = &tracks[0].rect;
+    }
+    detections.clear();
+    detector->detect(image, gray, detections, hint);
+    cascade_runs++;
+    matchDetections();
+}
+
+void FaceAnalyzer::matchDetections() {
+    // Largest faces claim their best-overlapping track first
+    sort(detections.begin(), detections.end(),
+         [](const Rect& a, const Rect& b) { return a.area() > b.area(); });
+    
+    for (auto& track : tracks) track.tracked = false;
+    
+    for (const auto& detection : detections) {
+        FaceTrack* best = nullptr;
+        float best_iou = match_iou;
+        for (auto& track : tracks) {
+            if (track.tracked) continue;
+            float iou = intersectionOverUnion(track.rect, detection);
+            if (iou >= best_iou) {
+                best_iou = iou;
+                best = &track;
+            }
+        }
+        
+        if (best == nullptr) {
+            if (tracks.size() >= max_faces) continue;
+            tracks.emplace_back();
+            best = &tracks.back();
+            best->id = next_face_id++;
+            faces_created++;
+        }
+        best->rect = detection;
+        best->missed_detections = 0;
+        best->tracked = true;
+        best->tracker.reset(gray, detection);
+    }
+    
+    // Faces the detector missed keep their ID for a little while but are not reported
+    for (auto& track : tracks) {
+        if (!track.tracked) {
+            track.missed_detections++;
+            track.tracker.lose();
+        }
+        if (track.missed_detections > max_missed_detections) {
+            retired_smoothing.add(track.smoother.getStats());
+        }
+    }
+    tracks.erase(remove_if(tracks.begin(), tracks.end(),
+                           [this](const FaceTrack& t) { return t.missed_detections > max_missed_detections; }),
+                 tracks.end());
+}
+
+void FaceAnalyzer::describeFace(const Mat& image, FaceTrack& track, DetectedFace& face) const {
+    Rect face_rect = smoothing_enabled ? track.smoother.filterRect(track.rect, frame_time, smoothing)
+                                       : track.rect;
+    face_rect &= Rect(0, 0, image.cols, image.rows);
+    
+    face = DetectedFace();
+    face.face_id = track.id;
+    face.rect = face_rect;
+    face.center = Point2f(face_rect.x + face_rect.width/2.0f, 
+                             face_rect.y + face_rect.height/2.0f);
+    face.confidence = track.tracker.getConfidence();
+    generateFacialLandmarks(face_rect, face.landmarks);
+    face.has_landmarks = true;
+    createFaceMesh(face.landmarks, face.face_mesh);
+    face.face_angle = calculateFaceAngle(face.landmarks);
+    if (smoothing_enabled) {
+        face.face_angle = track.smoother.filterAngle(face.face_angle, smoothing);
+    }
+    face.mouth_open = mouth_detector.update(luma_sum, face_rect, track.mouth);
+    face.mouth_center = getMouthCenter(face.landmarks);
+}
+
+float FaceAnalyzer::intersectionOverUnion(const Rect& a, const Rect& b) {
+    int overlap = (a & b).area();
+    int combined = a.area() + b.area() - overlap;
+    return combined > 0 ? static_cast<float>(overlap) / combined : 0.0f;
+}
+
+void FaceAnalyzer::reset() {
+    for (const auto& track : tracks) {
+        retired_smoothing.add(track.smoother.getStats());
+    }
+    tracks.clear();
+}
+
+void FaceAnalyzer::setTrackingEnabled(bool enabled) {
+    tracking_enabled = enabled;
+    for (auto& track : tracks) {
+        track.tracker.lose();
+    }
+}
+
+bool FaceAnalyzer::isTrackingEnabled() const {
+    return tracking_enabled;
+}
+
+int FaceAnalyzer::getDetectInterval() const {
+    return tracks.empty() ? FaceTracker::DEFAULT_DETECT_INTERVAL : tracks.front().tracker.getDetectInterval();
+}
+
+FaceDetector* FaceAnalyzer::getDetector() {
+    return detector.get();
+}
+
+CascadeFaceDetector* FaceAnalyzer::getCascadeDetector() {
+    return dynamic_cast<CascadeFaceDetector*>(detector.get());
+}
+
+MouthDetector& FaceAnalyzer::getMouthDetector() {
+    return mouth_detector;
+}
+
+void FaceAnalyzer::setSmoothingEnabled(bool enabled) {
+    if (enabled && !smoothing_enabled) {
+        for (auto& track : tracks) {
+            track.smoother.reset();
+        }
+    }
+    smoothing_enabled = enabled;
+}
+
+bool FaceAnalyzer::isSmoothingEnabled() const {
+    return smoothing_enabled;
+}
+
+void FaceAnalyzer::setSmoothingParams(const OneEuroParams& params) {
+    smoothing = params;
+}
+
+const OneEuroParams& FaceAnalyzer::getSmoothingParams() const {
+    return smoothing;
+}
+
+size_t FaceAnalyzer::getTrackCount() const {
+    return tracks.size();
+}
+
+uint64_t FaceAnalyzer::getCascadeRuns() const {
+    return cascade_runs;
+}
+
+uint64_t FaceAnalyzer::getTrackedFrames() const {
+    return tracked_frames;
+}
+
+uint64_t FaceAnalyzer::getLostCount() const {
+    return lost_count;
+}
+
+uint64_t FaceAnalyzer::getFacesCreated() const {
+    return faces_created;
+}
+
+SmoothingStats FaceAnalyzer::getSmoothingStats() const {
+    SmoothingStats stats = retired_smoothing;
+    for (const auto& track : tracks) {
+        stats.add(track.smoother.getStats());
+    }
+    return stats;
+}
+
+void FaceAnalyzer::generateFacialLandmarks(const Rect& face_rect, FaceLandmarks& landmarks) {
+    // 68 landmarks from the normalized template
+    LandmarkTemplate::shared().apply(face_rect, landmarks);
+}
+
+void FaceAnalyzer::createFaceMesh(const FaceLandmarks& landmarks, FaceMesh& mesh) {
+    // Landmarks first
+    copy(landmarks.begin(), landmarks.end(), mesh.begin());
+    
+    // Add points between jaw landmarks for smoother curve
+    for (size_t i = 0; i < 16; i++) {
+        mesh[FACE_LANDMARK_COUNT + i] = (landmarks[i] + landmarks[i+1]) * 0.5f;
+    }
+}
+
+double FaceAnalyzer::calculateFaceAngle(const FaceLandmarks& landmarks) {
+    // Calculate angle based on eye positions
+    Point2f left_eye = landmarks[LANDMARK_RIGHT_EYE_CENTER];  // Right eye (left from viewer perspective)
+    Point2f right_eye = landmarks[LANDMARK_LEFT_EYE_CENTER];  // Left eye (right from viewer perspective)
+    
+    Point2f eye_vector = right_eye - left_eye;
+    double angle = atan2(eye_vector.y, eye_vector.x) * 180.0 / M_PI;
+    
+    return angle;
+}
+
+Point2f FaceAnalyzer::getMouthCenter(const FaceLandmarks& landmarks) {
+    // Use the actual mouth center landmark (landmark 48)
+    return landmarks[LANDMARK_MOUTH_CENTER];
+}
@@ -0,0 +1,75 @@
+#include "../headers/face_detector.h"
+#include "../headers/cascade_face_detector.h"
+#include "../headers/dnn_face_detector.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+FaceDetectorSettings FaceDetectorSettings::fromEnv(const unordered_map<string, string>& env) {
+    FaceDetectorSettings settings;
+    auto value = [&env](const string& key) {
+        auto it = env.find(key);
+        return it != env.end() ? it->second : string();
+    };
+    
+    string backend = value("FACE_DETECTOR");
+    transform(backend.begin(), backend.end(), backend.begin(), ::tolower);
+    if (backend == "dnn") {
+        settings.backend = FaceDetectorBackend::Dnn;
+    } else if (!backend.empty() && backend != "cascade") {
+        cerr << "⚠️  Unknown FACE_DETECTOR '" << backend << "', using cascade" << endl;
+    }
+    
+    if (!value("FACE_DNN_MODEL").empty()) settings.dnn.model_path = value("FACE_DNN_MODEL");
+    if (!value("FACE_DNN_CONFIG").empty()) settings.dnn.config_path = value("FACE_DNN_CONFIG");
+    
+    // "300x300", or a single number for a square input
+    string input = value("FACE_DNN_INPUT");
+    if (!input.empty()) {
+        int width = atoi(input.c_str());
+        size_t separator = input.find_first_of("xX");
+        int height = separator != string::npos ? atoi(input.c_str() + separator + 1) : width;
+        if (width > 0 && height > 0) settings.dnn.input_size = Size(width, height);
+    }
+    
+    string confidence = value("FACE_DNN_CONFIDENCE");
+    if (!confidence.empty()) settings.dnn.confidence = static_cast<float>(atof(confidence.c_str()));
+    
+    return settings;
+}
+
+string backendName(FaceDetectorBackend backend) {
+    switch (backend) {
+        case FaceDetectorBackend::Cascade: return "cascade";
+        case FaceDetectorBackend::Dnn: return "dnn";
+    }
+    return "unknown";
+}
+
+vector<string> defaultCascadePaths() {
+    return {
+        "/usr/local/opt/opencv/share/opencv4/haarcascades/haarcascade_frontalface_alt.xml",
+        "/usr/local/share/opencv4/haarcascades/haarcascade_frontalface_alt.xml",
+        "/opt/homebrew/share/opencv4/haarcascades/haarcascade_frontalface_alt.xml",
+        "/usr/share/opencv4/haarcascades/haarcascade_frontalface_alt.xml",
+        "haarcascade_frontalface_alt.xml"
+    };
+}
+
+unique_ptr<FaceDetector> createFaceDetector(const FaceDetectorSettings& settings,
+                                            const vector<string>& cascade_paths,
+                                            string& loaded_from) {
+    loaded_from.clear();
+    
+    if (settings.backend == FaceDetectorBackend::Dnn) {
+        auto detector = make_unique<DnnFaceDetector>(settings.dnn);
+        if (!detector->load()) return nullptr;
+        loaded_from = settings.dnn.model_path;
+        return detector;
+    }
+    
+    auto detector = make_unique<CascadeFaceDetector>();
+    loaded_from = detector->load(cascade_paths);
+    if (loaded_from.empty()) return nullptr;
+    return detector;
+}
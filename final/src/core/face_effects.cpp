@@ -0,0 +1,135 @@
+#include "../headers/face_effects.h"
+#include <algorithm>
+
+FaceEffectsCompositor::FaceEffectsCompositor(ThreadPool& pool)
+    : pool(pool),
+      particle_kind(ParticleKind::Water),
+      seed(1),
+      horizontal_offset(0.0f),
+      vertical_offset(0.0f) {
+}
+
+void FaceEffectsCompositor::setMask(const MaskAsset& asset) {
+    mask_asset = asset;
+    for (auto& entry : effects) {
+        entry.second.mask.setAsset(mask_asset);
+    }
+}
+
+void FaceEffectsCompositor::setParticleKind(ParticleKind kind) {
+    particle_kind = kind;
+    for (auto& entry : effects) {
+        entry.second.particles.setParticleKind(particle_kind);
+    }
+}
+
+void FaceEffectsCompositor::setOffsets(float horizontal, float vertical) {
+    horizontal_offset = horizontal;
+    vertical_offset = vertical;
+}
+
+void FaceEffectsCompositor::setSeed(uint64_t new_seed) {
+    seed = new_seed;
+}
+
+void FaceEffectsCompositor::compose(Mat& frame, const FaceList& faces, vector<Rect>& dirty) {
+    dirty.clear();
+    
+    for (auto& entry : effects) {
+        entry.second.face = nullptr;
+    }
+    for (const auto& face : faces) {
+        effectsFor(face.face_id).face = &face;
+    }
+    
+    // Faces that left stay in the list until their particles have faded
+    active.clear();
+    for (auto& entry : effects) {
+        active.push_back(&entry.second);
+    }
+    
+    // Sprite resize/rotation is the expensive part; each face has its own
+    // renderer, so they can be prepared side by side
+    bool draw_masks = !mask_asset.empty();
+    pool.parallelFor(active.size(), [&](size_t i) {
+        FaceEffects& face_effects = *active[i];
+        face_effects.placement = MaskRenderer::Placement();
+        if (draw_masks && face_effects.face != nullptr) {
+            face_effects.mask.setOffsets(horizontal_offset, vertical_offset);
+            face_effects.placement = face_effects.mask.place(*face_effects.face);
+        }
+    });
+    
+    // Blending writes to the shared frame, so it stays sequential
+    for (FaceEffects* face_effects : active) {
+        Rect mask_area = face_effects->mask.blend(frame, face_effects->placement);
+        if (!mask_area.empty()) dirty.push_back(mask_area);
+        
+        Rect particle_area = updateParticles(frame, face_effects->particles, face_effects->face);
+        if (!particle_area.empty()) dirty.push_back(particle_area);
+    }
+    
+    for (auto it = effects.begin(); it != effects.end();) {
+        if (it->second.face == nullptr && it->second.particles.getParticleCount() == 0) {
+            it = effects.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FaceEffectsCompositor::clear() {
+    effects.clear();
+    active.clear();
+}
+
+FaceEffectsStats FaceEffectsCompositor::getStats() const {
+    FaceEffectsStats stats;
+    stats.faces = effects.size();
+    for (const auto& entry : effects) {
+        const FaceEffects& face_effects = entry.second;
+        stats.particles += face_effects.particles.getParticleCount();
+        stats.sprite_hits += face_effects.mask.getCacheHits();
+        stats.sprite_misses += face_effects.mask.getCacheMisses();
+        stats.mip_levels = max(stats.mip_levels, face_effects.mask.getMipLevels());
+        ParticleAllocatorStats alloc = face_effects.particles.getAllocatorStats();
+        stats.particle_alloc.arena_blocks += alloc.arena_blocks;
+        stats.particle_alloc.arena_bytes += alloc.arena_bytes;
+        stats.particle_alloc.bytes_in_use += alloc.bytes_in_use;
+        stats.particle_alloc.spawned += alloc.spawned;
+        stats.particle_alloc.recycled += alloc.recycled;
+        stats.particle_alloc.rejected += alloc.rejected;
+        stats.particle_alloc.peak_live += alloc.peak_live;
+    }
+    return stats;
+}
+
+FaceEffectsCompositor::FaceEffects& FaceEffectsCompositor::effectsFor(int face_id) {
+    auto found = effects.find(face_id);
+    if (found != effects.end()) return found->second;
+    
+    FaceEffects& face_effects = effects[face_id];
+    face_effects.mask.setAsset(mask_asset);
+    face_effects.particles.setParticleKind(particle_kind);
+    face_effects.particles.setSeed(seed + static_cast<uint64_t>(face_id));
+    return face_effects;
+}
+
+Rect FaceEffectsCompositor::updateParticles(Mat& frame, ParticleSystem& particles, const DetectedFace* face) {
+    // A face that left (or has no mouth position) stops emitting and lets its particles fade
+    if (face != nullptr && face->mouth_center.x > 0 && face->mouth_center.y > 0) {
+        particles.setEmitPosition(face->mouth_center);
+        if (face->mouth_open) {
+            particles.startEmission();
+        } else {
+            particles.stopEmission();
+        }
+    } else {
+        particles.stopEmission();
+    }
+    
+    particles.update();
+    particles.draw(frame);
+    
+    return particles.getBounds() & Rect(0, 0, frame.cols, frame.rows);
+}
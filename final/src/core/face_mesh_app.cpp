@@ -1,96 +1,161 @@
 #include "../headers/face_mesh_app.h"
 #include "../headers/cli_interface.h"
+#include "../headers/particle_kinds.h"
 #include <iostream>
+#include <iomanip>
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <thread>
 
 using namespace std;
 
-FaceMeshApp::FaceMeshApp(const string& connection_string, 
+FaceMeshApp::FaceMeshApp(MongoConnection& connection, 
                          const string& mask_file, 
-                         const string& pokemon) 
-    : selected_mask_file(mask_file),
+                         const string& pokemon,
+                         const FaceDetectorSettings& detector,
+                         const WriteBehindConfig& writes,
+                         FaceDocumentFormat face_format,
+                         const SpoolConfig& spool,
+                         bool mongo_reachable) 
+    : face_analyzer(face_pool),
+      face_effects(face_pool),
+      detector_settings(detector),
+      selected_mask_file(mask_file),
       pokemon_name(pokemon),
       photo_counter(1),
+      database_page(0),
       use_real_camera(false),
       face_detection_enabled(false),
       mask_loaded(false),
       mask_vertical_offset(0.0f),
-      mask_horizontal_offset(0.0f) {
+      mask_horizontal_offset(0.0f),
+      detect_queue(2),
+      display_queue(2),
+      result_queue(2),
+      pipeline_running(false),
+      capture_pool(8),
+      photo_pool(4),
+      photo_results(8),
+      capture_requested(false) {
+    
+    // Initialize MongoDB handler (clients come from the pool main() already pinged)
+    mongo_handler = make_unique<MongoDBHandler>(connection);
+    mongo_handler->setFaceFormat(face_format);
+    write_behind = make_unique<MongoWriteBehind>(*mongo_handler, writes);
+    
+    // Capture metadata goes to the local spool first and is replayed from there,
+    // so captures are kept while MongoDB is unreachable
+    if (spool.enabled()) {
+        capture_spool = make_unique<CaptureSpool>(spool);
+        if (capture_spool->open()) {
+            mongo_handler->attachSpool(capture_spool.get());
+            spool_replayer = make_unique<SpoolReplayer>(*capture_spool, *mongo_handler, writes);
+            size_t recovered = capture_spool->getStats().recovered;
+            cout << "💾 Capture spool: " << spool.path;
+            if (recovered > 0) cout << " (" << recovered << " capture(s) from an earlier run to replay)";
+            cout << endl;
+        } else {
+            cout << "⚠️  Could not open capture spool " << spool.path << ", writing to MongoDB directly" << endl;
+            capture_spool.reset();
+        }
+    }
+    
+    // Photos are saved in the background; results come back to the render thread
+    photo_writer = make_unique<PhotoWriter>(*mongo_handler, *write_behind, 2, [this](const PhotoResult& result) {
+        photo_results.push(result);
+    });
     
-    // Initialize MongoDB handler
-    mongo_handler = make_unique<MongoDBHandler>(connection_string);
+    dirty_rects.reserve(16);
     
-    initializeLandmarkNames();
     loadFaceDetectionModels();
     loadMaskImage();
     initializeCamera();
     setupParticleSystem();
     
+    // Index builds can take a while on a large collection; the camera does not wait for them.
+    // Without a server they would only sit out the server selection timeout.
+    if (mongo_reachable) {
+        index_builder = thread([this] { mongo_handler->createIndexes(); });
+    } else {
+        cout << "⚠️  MongoDB unreachable at startup, skipping index creation until the next run" << endl;
+    }
+    
     cout << "📊 MongoDB connection established!" << endl;
     cout << "🎭 Selected Pokémon: " << pokemon_name << endl;
     cout << "🖼️  Using mask: " << selected_mask_file << endl;
 }
 
 FaceMeshApp::~FaceMeshApp() {
+    // Finish queued photos while the database and result queue still exist,
+    // then write their documents before the client goes away
+    photo_writer.reset();
+    if (index_builder.joinable()) index_builder.join();
+    if (spool_replayer) {
+        spool_replayer.reset();
+        mongo_handler->attachSpool(nullptr);
+        capture_spool.reset();
+    }
+    WriteBehindStats writes = write_behind->getStats();
+    if (writes.pending > 0) {
+        cout << "💾 Writing " << writes.pending << " queued capture(s) to MongoDB..." << endl;
+    }
+    write_behind.reset();
+    
     if (camera.isOpened()) {
         camera.release();
     }
     destroyAllWindows();
 }
 
-void FaceMeshApp::initializeLandmarkNames() {
-    landmark_names = {
-        // Jaw line (17 points: 0-16)
-        "jaw_1", "jaw_2", "jaw_3", "jaw_4", "jaw_5", "jaw_6", "jaw_7", "jaw_8", "jaw_9",
-        "jaw_10", "jaw_11", "jaw_12", "jaw_13", "jaw_14", "jaw_15", "jaw_16", "jaw_17",
-        
-        // Right eyebrow (5 points: 17-21)
-        "right_eyebrow_1", "right_eyebrow_2", "right_eyebrow_3", "right_eyebrow_4", "right_eyebrow_5",
-        
-        // Left eyebrow (5 points: 22-26)
-        "left_eyebrow_1", "left_eyebrow_2", "left_eyebrow_3", "left_eyebrow_4", "left_eyebrow_5",
-        
-        // Nose (9 points: 27-35)
-        "nose_1", "nose_2", "nose_3", "nose_4", "nose_5", "nose_6", "nose_7", "nose_8", "nose_9",
-        
-        // Right eye (6 points: 36-41)
-        "right_eye_center", "right_eye_1", "right_eye_2", "right_eye_3", "right_eye_4", "right_eye_5",
-        
-        // Left eye (6 points: 42-47)
-        "left_eye_center", "left_eye_1", "left_eye_2", "left_eye_3", "left_eye_4", "left_eye_5",
-        
-        // Mouth (20 points: 48-67)
-        "mouth_center", "mouth_outer_1", "mouth_outer_2", "mouth_outer_3", "mouth_outer_4", "mouth_outer_5",
-        "mouth_outer_6", "mouth_outer_7", "mouth_outer_8", "mouth_outer_9", "mouth_outer_10",
-        "mouth_outer_11", "mouth_inner_1", "mouth_inner_2", "mouth_inner_3", "mouth_inner_4", 
-        "mouth_inner_5", "mouth_inner_6", "mouth_inner_7", "mouth_inner_8"
-    };
-}
-
 void FaceMeshApp::loadFaceDetectionModels() {
     cout << "🔍 Loading face detection models..." << endl;
     
-    vector<string> cascade_paths = {
-        "/usr/local/opt/opencv/share/opencv4/haarcascades/haarcascade_frontalface_alt.xml",
-        "/usr/local/share/opencv4/haarcascades/haarcascade_frontalface_alt.xml",
-        "/opt/homebrew/share/opencv4/haarcascades/haarcascade_frontalface_alt.xml",
-        "haarcascade_frontalface_alt.xml"
-    };
+    vector<string> cascade_paths = defaultCascadePaths();
     
-    for (const auto& path : cascade_paths) {
-        if (face_cascade.load(path)) {
-            face_detection_enabled = true;
-            cout << "✅ Face detection model loaded: " << path << endl;
-            break;
-        }
+    string loaded_path;
+    unique_ptr<FaceDetector> detector;
+    if (detector_settings.backend == FaceDetectorBackend::Dnn && checkFaceModel()) {
+        detector = createFaceDetector(detector_settings, cascade_paths, loaded_path);
+    }
+    if (!detector && detector_settings.backend == FaceDetectorBackend::Dnn) {
+        cout << "⚠️  DNN face model unavailable, falling back to the Haar cascade" << endl;
+    }
+    if (!detector) {
+        detector = createFaceDetector(FaceDetectorSettings(), cascade_paths, loaded_path);
     }
     
-    if (!face_detection_enabled) {
+    if (detector) {
+        face_detection_enabled = true;
+        cout << "✅ Face detection model loaded: " << loaded_path << endl;
+        cout << "   🔎 Detector: " << detector->name() << endl;
+        cout << "   👥 Per-face workers: " << face_pool.size() << endl;
+        face_analyzer.setDetector(std::move(detector));
+    } else {
         cout << "❌ Face detection model not found!" << endl;
     }
 }
 
+bool FaceMeshApp::checkFaceModel() {
+    const DnnDetectorConfig& config = detector_settings.dnn;
+    
+    // YuNet (.onnx) is a single file; the SSD also needs its prototxt
+    bool yunet = config.model_path.size() >= 5 &&
+                 config.model_path.compare(config.model_path.size() - 5, 5, ".onnx") == 0;
+    
+    bool ok = true;
+    for (const string& path : {config.model_path, yunet ? string() : config.config_path}) {
+        if (path.empty() || ifstream(path).good()) continue;
+        cout << "❌ Face model file not found: " << path << endl;
+        ok = false;
+    }
+    if (!ok) cout << "   Run 'make models' to download the default ResNet-SSD files into models/" << endl;
+    return ok;
+}
+
 void FaceMeshApp::initializeCamera() {
     cout << "🔍 Checking for camera..." << endl;
     camera.open(0);
@@ -106,44 +171,41 @@ void FaceMeshApp::initializeCamera() {
 }
 
 void FaceMeshApp::setupParticleSystem() {
-    if (pokemon_name == "Mudkip") {
-        particle_system.setParticleType("water");
-    } else if (pokemon_name == "Meowth") {
-        particle_system.setParticleType("coin");
-    } else if (pokemon_name == "Eevee") {
-        particle_system.setParticleType("gem");
-    } else if (pokemon_name == "Sylveon") {
-        particle_system.setParticleType("heart");
-    } else if (pokemon_name == "Pikachu") {
-        particle_system.setParticleType("lightning");
-    } else {
-        particle_system.setParticleType("water");
+    // Pokémon -> particle kind; anything not listed gets water
+    static const struct {
+        const char* pokemon;
+        ParticleKind kind;
+    } POKEMON_PARTICLES[] = {
+        {"Mudkip", ParticleKind::Water},
+        {"Meowth", ParticleKind::Coin},
+        {"Eevee", ParticleKind::Gem},
+        {"Sylveon", ParticleKind::Heart},
+        {"Pikachu", ParticleKind::Lightning},
+    };
+    
+    ParticleKind particle_kind = ParticleKind::Water;
+    for (const auto& entry : POKEMON_PARTICLES) {
+        if (pokemon_name == entry.pokemon) {
+            particle_kind = entry.kind;
+            break;
+        }
     }
+    face_effects.setParticleKind(particle_kind);
     
-    cout << "✨ Particle system set to: " << particle_system.getParticleType() << endl;
+    cout << "✨ Particle system set to: " << particleKindOps(particle_kind).name << endl;
 }
 
 void FaceMeshApp::loadMaskImage() {
     cout << "🎭 Loading mask image: " << selected_mask_file << endl;
     
-    vector<string> mask_paths = {
-        "images/" + selected_mask_file,
-        selected_mask_file,
-        "./images/" + selected_mask_file
-    };
-    
-    for (const auto& path : mask_paths) {
-        mask_image = imread(path, IMREAD_UNCHANGED);
-        if (!mask_image.empty()) {
-            mask_loaded = true;
-            cout << "✅ Mask loaded: " << path << endl;
-            cout << "   📏 Mask size: " << mask_image.cols << "x" << mask_image.rows 
-                      << " (channels: " << mask_image.channels() << ")" << endl;
-            break;
-        }
-    }
-    
-    if (!mask_loaded) {
+    string loaded_from;
+    mask_loaded = MaskAssets::load(selected_mask_file, mask_asset, loaded_from);
+    if (mask_loaded) {
+        face_effects.setMask(mask_asset);
+        cout << "✅ Mask loaded: " << loaded_from << endl;
+        cout << "   📏 Mask size: " << mask_asset.original_size.width << "x" << mask_asset.original_size.height
+                  << " (opaque area: " << mask_asset.bounds.width << "x" << mask_asset.bounds.height << ")" << endl;
+    } else {
         cout << "⚠️  Mask file not found: " << selected_mask_file << endl;
         cout << "   💡 Using default overlay instead" << endl;
     }
@@ -160,423 +222,480 @@ void FaceMeshApp::run() {
         return;
     }
     
-    Mat frame;
+    // Capture and detection run on their own threads so the Haar cascade
+    // no longer caps the display rate. HighGUI must stay on this thread.
+    pipeline_running = true;
+    thread capture_thread(&FaceMeshApp::captureLoop, this);
+    thread detection_thread(&FaceMeshApp::detectionLoop, this);
     
-    while (true) {
-        camera >> frame;
-        if (frame.empty()) continue;
-        
-        // Detect faces and apply effects
-        auto faces = detectFacesWithMesh(frame);
-        Mat display_frame = drawFaceWithMouthEmoji(frame, faces);
-        
-        // Add version indicator
-        putText(display_frame, "SPACE: Photo | Q: Quit", 
-                   Point(10, 30), FONT_HERSHEY_SIMPLEX, 0.7, 
-                   Scalar(0, 255, 0), 2);
-        
-        putText(display_frame, "w/s: mask up/down | a/d: left/right", 
-                   Point(10, 60), FONT_HERSHEY_SIMPLEX, 0.5, 
-                   Scalar(0, 255, 255), 2);
-        
-        imshow("Pokemon Face Mesh", display_frame);
-        
-        int key = waitKey(1) & 0xFF;
-        // adjust mask position
-        if (key == ' ' || key == 13) { // SPACE or ENTER
-            processFrame(frame, "camera");
-        } else if (key == 'w' || key == 'W') {
-            mask_vertical_offset -= 0.05f;
-            cout << "📏 Mask moved up. Vertical offset: " << mask_vertical_offset << endl;
-        } else if (key == 's' || key == 'S') {
-            mask_vertical_offset += 0.05f;
-            cout << "📏 Mask moved down. Vertical offset: " << mask_vertical_offset << endl;
-        } else if (key == 'a' || key == 'A') {
-            mask_horizontal_offset -= 0.05f;
-            cout << "📏 Mask moved left. Horizontal offset: " << mask_horizontal_offset << endl;
-        } else if (key == 'd' || key == 'D') {
-            mask_horizontal_offset += 0.05f;
-            cout << "📏 Mask moved right. Horizontal offset: " << mask_horizontal_offset << endl;
-        } else if (key == 'r' || key == 'R') {
-            mask_vertical_offset = 0.0f;
-            mask_horizontal_offset = 0.0f;
-            cout << "📏 Mask position reset." << endl;
-        } else if (key == 'i' || key == 'I') {
-            mongo_handler->showFaceDatabase();
-        } else if (key == 'q' || key == 27) { // q or ESC
-            break;
-        }
+    renderLoop();
+    
+    pipeline_running = false;
+    detect_queue.close();
+    display_queue.close();
+    result_queue.close();
+    capture_thread.join();
+    detection_thread.join();
+    
+    if (recorder.isRecording()) toggleRecording();
+    
+    // Photos already accepted are still written before the app exits
+    if (photo_writer->getPending() > 0) {
+        cout << "💾 Saving " << photo_writer->getPending() << " pending photo(s)..." << endl;
     }
+    photo_writer->stop();
+    Mat no_display;
+    reportPhotos(no_display);
+    
+    showPipelineStats();
 }
 
-void FaceMeshApp::processFrame(const Mat& image, const string& source_type) {
-    string filename = "facemesh_" + pokemon_name + "_" + 
-                         mongo_handler->getCurrentTimestamp() + "_" + 
-                         to_string(photo_counter) + ".jpg";
+void FaceMeshApp::captureLoop() {
+    uint64_t sequence = 0;
+    Size frame_size(static_cast<int>(camera.get(CAP_PROP_FRAME_WIDTH)),
+                    static_cast<int>(camera.get(CAP_PROP_FRAME_HEIGHT)));
     
-    auto faces = detectFacesWithMesh(image);
-    Mat result_image = drawFaceMeshOverlay(image, faces);
-    
-    if (imwrite(filename, result_image)) {
-        cout << "\n🎭 Face capture saved: " << filename << endl;
-        cout << "   📊 Faces detected: " << faces.size() << endl;
+    while (pipeline_running) {
+        FramePacket packet;
+        auto start = chrono::steady_clock::now();
         
-        // Save to MongoDB with additional info
-        if (mongo_handler->saveFaceData(faces, filename, pokemon_name, selected_mask_file)) {
-            cout << "   💾 Data saved to MongoDB" << endl;
-        }
+        // Read straight into a recycled buffer
+        packet.frame = capture_pool.acquire(frame_size, CV_8UC3);
+        if (!camera.read(packet.frame) || packet.frame.empty()) continue;
+        frame_size = packet.frame.size();
         
-        photo_counter++;
-    } else {
-        cout << "❌ Failed to save image: " << filename << endl;
+        packet.captured_at = chrono::steady_clock::now();
+        packet.sequence = sequence++;
+        pipeline_stats.capture.record(packet.captured_at - start);
+        
+        // Both consumers (and the recorder) share the same pixels; none writes to them
+        recorder.add(packet);
+        detect_queue.push(packet);
+        display_queue.push(std::move(packet));
     }
 }
 
-void FaceMeshApp::showAppStats() {
-    cout << "\n📊 APP STATISTICS:" << endl;
-    cout << "  Camera available: " << (use_real_camera ? "Yes" : "No") << endl;
-    cout << "  Face detection: " << (face_detection_enabled ? "Enabled" : "Disabled") << endl;
-    cout << "  Pokémon: " << pokemon_name << endl;
-    cout << "  Mask file: " << selected_mask_file << endl;
-    cout << "  Analyses performed: " << (photo_counter - 1) << endl;
-    cout << "  Particles active: " << particle_system.getParticleCount() << endl;
+void FaceMeshApp::detectionLoop() {
+    FramePacket packet;
+    DetectionPacket result;      // Reused every frame; pushing copies it into a queue slot
     
-    auto stats = mongo_handler->getStatistics();
-    cout << "  MongoDB captures: " << stats.first << endl;
-    cout << "  Total faces saved: " << stats.second << endl;
+    while (pipeline_running) {
+        if (!detect_queue.pop(packet, chrono::milliseconds(100))) continue;
+        
+        auto start = chrono::steady_clock::now();
+        detectFacesWithMesh(packet.frame, result.faces);
+        result.sequence = packet.sequence;
+        pipeline_stats.detect.record(chrono::steady_clock::now() - start);
+        
+        result_queue.push(result);
+    }
 }
 
-void FaceMeshApp::displayInstructions() {
-    CLIInterface::displayInstructions();
-}
-// Draw face mesh overlay on the image
-vector<DetectedFace> FaceMeshApp::detectFacesWithMesh(const Mat& image) {
-    vector<DetectedFace> detected_faces;
-    
-    if (!face_detection_enabled) {
-        return detected_faces;
-    }
+void FaceMeshApp::renderLoop() {
+    FramePacket packet;
+    DetectionPacket latest;      // Most recent detection, reused until a newer one arrives
+    DetectionPacket incoming;
     
-    Mat gray;
-    cvtColor(image, gray, COLOR_BGR2GRAY);
-    equalizeHist(gray, gray);
-    
-    vector<Rect> faces;
-    face_cascade.detectMultiScale(gray, faces, 1.1, 3, 0, Size(30, 30));
-    
-    if (!faces.empty()) {
-        // Find the largest face
-        Rect largest_face = faces[0];
-        for (const auto& face_rect : faces) {
-            if (face_rect.area() > largest_face.area()) {
-                largest_face = face_rect;
-            }
+    while (true) {
+        if (!display_queue.pop(packet, chrono::milliseconds(100))) {
+            // Keep the window responsive even if the camera stalls
+            if (!handleKey(waitKey(1) & 0xFF)) break;
+            continue;
         }
         
-        DetectedFace face;
-        face.rect = largest_face;
-        face.center = Point2f(largest_face.x + largest_face.width/2.0f, 
-                                 largest_face.y + largest_face.height/2.0f);
-        face.confidence = 1.0;
-        face.landmarks = generateFacialLandmarks(largest_face);
-        face.face_mesh = createFaceMesh(face.landmarks);
-        face.face_angle = calculateFaceAngle(face.landmarks);
-        
-        Mat face_roi = image(largest_face);
-        face.mouth_open = detectMouthOpenSimple(face_roi);
-        face.mouth_center = getMouthCenter(face.landmarks);
+        auto start = chrono::steady_clock::now();
+        while (result_queue.tryPop(incoming)) {
+            latest = std::move(incoming);
+        }
         
-        detected_faces.push_back(face);
-    }
-    
-    return detected_faces;
-}
-
-vector<FaceLandmark> FaceMeshApp::generateFacialLandmarks(const Rect& face_rect) {
-    vector<FaceLandmark> landmarks;
-    
-    // Generate 68 facial landmarks based on face rectangle
-    float face_width = face_rect.width;
-    float face_height = face_rect.height;
-    float center_x = face_rect.x + face_width / 2.0f;
-    float center_y = face_rect.y + face_height / 2.0f;
-    
-    // Jaw line (17 points)
-    for (int i = 0; i < 17; i++) {
-        float t = i / 16.0f;
-        float x = face_rect.x + t * face_width;
-        float y = face_rect.y + face_height * 0.8f + sin(t * M_PI) * face_height * 0.1f;
+        // Compose into the reused display buffer; the captured frame is
+        // still shared with the detection worker so it stays untouched
+        packet.frame.copyTo(display_buffer);
+        composeFrame(display_buffer, latest.faces, dirty_rects);
+        Mat& display_frame = display_buffer;
         
-        FaceLandmark landmark;
-        landmark.point = Point2f(x, y);
-        landmark.landmark_id = i;
-        landmark.landmark_name = (i < landmark_names.size()) ? landmark_names[i] : "jaw_" + to_string(i);
-        landmarks.push_back(landmark);
-    }
-    
-    // Right eyebrow (5 points)
-    for (int i = 0; i < 5; i++) {
-        float t = i / 4.0f;
-        float x = center_x - face_width * 0.25f + t * face_width * 0.25f;
-        float y = center_y - face_height * 0.25f - face_height * 0.05f * sin(t * M_PI);
+        // Photos are the composed frame without the on-screen help text
+        if (capture_requested) {
+            capture_requested = false;
+            capturePhoto(display_frame, latest.faces);
+        }
         
-        FaceLandmark landmark;
-        landmark.point = Point2f(x, y);
-        landmark.landmark_id = 17 + i;
-        landmark.landmark_name = (17 + i < landmark_names.size()) ? landmark_names[17 + i] : "right_eyebrow_" + to_string(i);
-        landmarks.push_back(landmark);
-    }
-    
-    // Left eyebrow (5 points)
-    for (int i = 0; i < 5; i++) {
-        float t = i / 4.0f;
-        float x = center_x + t * face_width * 0.25f;
-        float y = center_y - face_height * 0.25f - face_height * 0.05f * sin(t * M_PI);
+        // Add version indicator
+        putText(display_frame, "SPACE: Photo | Q: Quit", 
+                   Point(10, 30), FONT_HERSHEY_SIMPLEX, 0.7, 
+                   Scalar(0, 255, 0), 2);
         
-        FaceLandmark landmark;
-        landmark.point = Point2f(x, y);
-        landmark.landmark_id = 22 + i;
-        landmark.landmark_name = (22 + i < landmark_names.size()) ? landmark_names[22 + i] : "left_eyebrow_" + to_string(i);
-        landmarks.push_back(landmark);
-    }
-    
-    // Nose (9 points)
-    for (int i = 0; i < 9; i++) {
-        float t = i / 8.0f;
-        float x = center_x + (i % 3 - 1) * face_width * 0.05f;
-        float y = center_y - face_height * 0.1f + t * face_height * 0.2f;
+        putText(display_frame, "w/s: mask up/down | a/d: left/right", 
+                   Point(10, 60), FONT_HERSHEY_SIMPLEX, 0.5, 
+                   Scalar(0, 255, 255), 2);
         
-        FaceLandmark landmark;
-        landmark.point = Point2f(x, y);
-        landmark.landmark_id = 27 + i;
-        landmark.landmark_name = (27 + i < landmark_names.size()) ? landmark_names[27 + i] : "nose_" + to_string(i);
-        landmarks.push_back(landmark);
-    }
-    
-    // Right eye (6 points)
-    Point2f right_eye_center(center_x - face_width * 0.18f, center_y - face_height * 0.1f);
-    FaceLandmark right_eye_center_landmark;
-    right_eye_center_landmark.point = right_eye_center;
-    right_eye_center_landmark.landmark_id = 36;
-    right_eye_center_landmark.landmark_name = (36 < landmark_names.size()) ? landmark_names[36] : "right_eye_center";
-    landmarks.push_back(right_eye_center_landmark);
-    
-    for (int i = 1; i < 6; i++) {
-        float angle = i * 2 * M_PI / 6;
-        float x = right_eye_center.x + cos(angle) * face_width * 0.06f;
-        float y = right_eye_center.y + sin(angle) * face_height * 0.03f;
+        reportPhotos(display_frame);
         
-        FaceLandmark landmark;
-        landmark.point = Point2f(x, y);
-        landmark.landmark_id = 36 + i;
-        landmark.landmark_name = (36 + i < landmark_names.size()) ? landmark_names[36 + i] : "right_eye_" + to_string(i);
-        landmarks.push_back(landmark);
-    }
-    
-    // Left eye (6 points)
-    Point2f left_eye_center(center_x + face_width * 0.18f, center_y - face_height * 0.1f);
-    FaceLandmark left_eye_center_landmark;
-    left_eye_center_landmark.point = left_eye_center;
-    left_eye_center_landmark.landmark_id = 42;
-    left_eye_center_landmark.landmark_name = (42 < landmark_names.size()) ? landmark_names[42] : "left_eye_center";
-    landmarks.push_back(left_eye_center_landmark);
-    
-    for (int i = 1; i < 6; i++) {
-        float angle = i * 2 * M_PI / 6;
-        float x = left_eye_center.x + cos(angle) * face_width * 0.06f;
-        float y = left_eye_center.y + sin(angle) * face_height * 0.03f;
+        imshow("Pokemon Face Mesh", display_frame);
         
-        FaceLandmark landmark;
-        landmark.point = Point2f(x, y);
-        landmark.landmark_id = 42 + i;
-        landmark.landmark_name = (42 + i < landmark_names.size()) ? landmark_names[42 + i] : "left_eye_" + to_string(i);
-        landmarks.push_back(landmark);
-    }
-    
-    // Mouth (20 points)
-    Point2f mouth_center(center_x, center_y + face_height * 0.42f);
-    FaceLandmark mouth_center_landmark;
-    mouth_center_landmark.point = mouth_center;
-    mouth_center_landmark.landmark_id = 48;
-    mouth_center_landmark.landmark_name = (48 < landmark_names.size()) ? landmark_names[48] : "mouth_center";
-    landmarks.push_back(mouth_center_landmark);
-    
-    for (int i = 1; i < 20; i++) {
-        float angle = i * 2 * M_PI / 20;
-        float radius = (i < 12) ? face_width * 0.15f : face_width * 0.1f;
-        float x = mouth_center.x + cos(angle) * radius;
-        float y = mouth_center.y + sin(angle) * face_height * 0.08f;
+        auto shown = chrono::steady_clock::now();
+        pipeline_stats.render.record(shown - start);
+        pipeline_stats.frame_age.record(shown - packet.captured_at);
         
-        FaceLandmark landmark;
-        landmark.point = Point2f(x, y);
-        landmark.landmark_id = 48 + i;
-        landmark.landmark_name = (48 + i < landmark_names.size()) ? landmark_names[48 + i] : "mouth_" + to_string(i);
-        landmarks.push_back(landmark);
+        int key = waitKey(1) & 0xFF;
+        if (!handleKey(key)) break;
     }
-    
-    return landmarks;
 }
 
-vector<Point2f> FaceMeshApp::createFaceMesh(const vector<FaceLandmark>& landmarks) {
-    vector<Point2f> mesh_points;
-    
-    // Convert landmarks to mesh points
-    for (const auto& landmark : landmarks) {
-        mesh_points.push_back(landmark.point);
-    }
-    
-    // Add additional interpolated points for smoother mesh
-    if (landmarks.size() >= 17) {
-        // Add points between jaw landmarks for smoother curve
-        for (size_t i = 0; i < 16; i++) {
-            Point2f mid_point = (landmarks[i].point + landmarks[i+1].point) * 0.5f;
-            mesh_points.push_back(mid_point);
+bool FaceMeshApp::handleKey(int key) {
+    // adjust mask position
+    if (key == ' ' || key == 13) { // SPACE or ENTER
+        // Taken from the next composed frame, so it shows exactly what is on screen
+        capture_requested = true;
+    } else if (key == 'w' || key == 'W') {
+        mask_vertical_offset -= 0.05f;
+        cout << "📏 Mask moved up. Vertical offset: " << mask_vertical_offset << endl;
+    } else if (key == 's' || key == 'S') {
+        mask_vertical_offset += 0.05f;
+        cout << "📏 Mask moved down. Vertical offset: " << mask_vertical_offset << endl;
+    } else if (key == 'a' || key == 'A') {
+        mask_horizontal_offset -= 0.05f;
+        cout << "📏 Mask moved left. Horizontal offset: " << mask_horizontal_offset << endl;
+    } else if (key == 'd' || key == 'D') {
+        mask_horizontal_offset += 0.05f;
+        cout << "📏 Mask moved right. Horizontal offset: " << mask_horizontal_offset << endl;
+    } else if (key == 'r' || key == 'R') {
+        mask_vertical_offset = 0.0f;
+        mask_horizontal_offset = 0.0f;
+        cout << "📏 Mask position reset." << endl;
+    } else if (key == 'i' || key == 'I') {
+        // Each press lists the next page; after the last one it starts over
+        const int page_size = 10;
+        if (!mongoReachable()) {
+            // find() would freeze the window for the whole server selection timeout
+            cout << "⚠️  MongoDB unreachable, captures can't be listed right now";
+            if (capture_spool) cout << " (" << capture_spool->getPendingRecords() << " waiting in the spool)";
+            cout << endl;
+            return true;
         }
+        flushCaptureWrites();
+        int shown = mongo_handler->showFaceDatabase(database_page, page_size);
+        database_page = shown < page_size ? 0 : database_page + 1;
+    } else if (key == 'g' || key == 'G') {
+        showAppStats();
+    } else if (key == 'p' || key == 'P') {
+        showPipelineStats();
+    } else if (key == 't' || key == 'T') {
+        lock_guard<mutex> guard(detection_mutex);
+        bool tracking_enabled = !face_analyzer.isTrackingEnabled();
+        face_analyzer.setTrackingEnabled(tracking_enabled);
+        cout << "🎯 Face tracking " << (tracking_enabled ? "enabled (cascade every " + 
+                to_string(face_analyzer.getDetectInterval()) + " frames)" : "disabled (cascade every frame)") << endl;
+    } else if (key == 'c' || key == 'C') {
+        lock_guard<mutex> guard(detection_mutex);
+        CascadeFaceDetector* detector = face_analyzer.getCascadeDetector();
+        if (detector == nullptr) {
+            cout << "🔎 Search strategy only applies to the Haar cascade (using "
+                 << (face_analyzer.getDetector() ? face_analyzer.getDetector()->name() : "none") << ")" << endl;
+            return true;
+        }
+        detector->setStrategy(detector->getStrategy() == DetectionStrategy::FullFrame
+                              ? DetectionStrategy::RoiPyramid
+                              : DetectionStrategy::FullFrame);
+        cout << "🔎 Cascade search strategy: " 
+             << CascadeFaceDetector::strategyName(detector->getStrategy()) << endl;
+    } else if (key == 'f' || key == 'F') {
+        lock_guard<mutex> guard(detection_mutex);
+        bool smoothing_enabled = !face_analyzer.isSmoothingEnabled();
+        face_analyzer.setSmoothingEnabled(smoothing_enabled);
+        cout << "🪶 Face smoothing " << (smoothing_enabled ? "enabled" : "disabled") << endl;
+    } else if (key == '[' || key == ']') {
+        // Lower cutoff = steadier mask but more lag when the head moves slowly
+        lock_guard<mutex> guard(detection_mutex);
+        OneEuroParams params = face_analyzer.getSmoothingParams();
+        params.min_cutoff = key == '[' ? max(0.05f, params.min_cutoff * 0.7f)
+                                       : min(30.0f, params.min_cutoff / 0.7f);
+        face_analyzer.setSmoothingParams(params);
+        cout << "🪶 Smoothing cutoff: " << params.min_cutoff << " Hz (beta " << params.beta << ")" << endl;
+    } else if (key == 'v' || key == 'V') {
+        toggleRecording();
+    } else if (key == 'q' || key == 27) { // q or ESC
+        return false;
     }
-    
-    return mesh_points;
+    return true;
 }
 
-double FaceMeshApp::calculateFaceAngle(const vector<FaceLandmark>& landmarks) {
-    if (landmarks.size() < 42) return 0.0;
-    
-    // Calculate angle based on eye positions
-    Point2f left_eye = landmarks[36].point;  // Right eye (left from viewer perspective)
-    Point2f right_eye = landmarks[42].point; // Left eye (right from viewer perspective)
+void FaceMeshApp::toggleRecording() {
+    if (recorder.isRecording()) {
+        recorder.stop();
+        cout << "⏹️  Recording saved: " << recorder.getPath()
+             << " (" << recorder.getFramesWritten() << " frames, "
+             << recorder.getBytesWritten() / (1024 * 1024) << " MB)" << endl;
+        return;
+    }
     
-    Point2f eye_vector = right_eye - left_eye;
-    double angle = atan2(eye_vector.y, eye_vector.x) * 180.0 / M_PI;
+    error_code error;
+    filesystem::create_directories("recordings", error);
+    string path = "recordings/session_" + mongo_handler->getCurrentTimestamp() + SessionRecording::FILE_EXTENSION;
+    Size frame_size(static_cast<int>(camera.get(CAP_PROP_FRAME_WIDTH)),
+                    static_cast<int>(camera.get(CAP_PROP_FRAME_HEIGHT)));
     
-    return angle;
+    if (recorder.start(path, frame_size)) {
+        cout << "⏺️  Recording camera to " << path << " (press v again to stop)" << endl;
+    } else {
+        cout << "❌ Could not create recording " << path << endl;
+    }
 }
 
-bool FaceMeshApp::detectMouthOpenSimple(const Mat& face_roi) {
-    if (face_roi.empty()) return false;
-    
-    // Get the mouth area (center bottom of face)
-    int mouth_y = face_roi.rows * 0.75;  // 75% down the face (lower than before)
-    int mouth_x_start = face_roi.cols * 0.4;   // 40% from left (narrower focus)
-    int mouth_x_end = face_roi.cols * 0.6;     // 60% from left
-    int mouth_height = face_roi.rows * 0.08;   // 8% of face height to scan
-    
-    if (mouth_y >= face_roi.rows || mouth_x_start >= mouth_x_end || mouth_y + mouth_height >= face_roi.rows) {
-        return false;
+void FaceMeshApp::flushCaptureWrites() {
+    // Runs on the render thread: give the writers a moment, never a stalled round trip
+    const chrono::milliseconds wait(300);
+    if (!write_behind->flush(wait)) {
+        cout << "⚠️  MongoDB is slow to answer: " << write_behind->getStats().pending
+             << " capture(s) still on their way" << endl;
+    }
+    if (spool_replayer && !spool_replayer->flush(wait)) {
+        cout << "⚠️  MongoDB " << (spool_replayer->getStats().online ? "is slow to answer" : "unreachable")
+             << ": " << capture_spool->getPendingRecords()
+             << " capture(s) are only in the spool so far" << endl;
     }
-    
-    // Convert to grayscale
-    Mat gray;
-    if (face_roi.channels() == 3) {
-        cvtColor(face_roi, gray, COLOR_BGR2GRAY);
+}
+
+bool FaceMeshApp::mongoReachable() {
+    if (spool_replayer) return spool_replayer->getStats().online;
+    MongoConnection& connection = mongo_handler->getConnection();
+    MongoConnectionStats stats = connection.getStats();
+    if (stats.pings == 0 || stats.last_ping.ok) return true;
+    return connection.ping(chrono::milliseconds(500)).ok;
+}
+
+void FaceMeshApp::capturePhoto(const Mat& composed, const FaceList& faces) {
+    auto start = chrono::steady_clock::now();
+    
+    // Copy into a recycled buffer; the display buffer is reused next frame
+    PhotoJob job;
+    job.image = photo_pool.acquire(composed.size(), composed.type());
+    composed.copyTo(job.image);
+    job.faces = faces;
+    job.filename = "facemesh_" + pokemon_name + "_" + 
+                   mongo_handler->getCurrentTimestamp() + "_" + 
+                   to_string(photo_counter) + ".jpg";
+    job.pokemon_name = pokemon_name;
+    job.mask_file = selected_mask_file;
+    
+    bool accepted = photo_writer->submit(std::move(job));
+    pipeline_stats.photo.record(chrono::steady_clock::now() - start);
+    
+    if (accepted) {
+        photo_counter++;
+        photo_status = "Saving photo...";
     } else {
-        gray = face_roi.clone();
+        // Backpressure: never block the preview waiting for disk or MongoDB
+        cout << "⏳ Still saving earlier photos, capture skipped" << endl;
+        photo_status = "Busy saving - try again";
     }
-    
-    // Apply slight blur to reduce noise
-    GaussianBlur(gray, gray, Size(3, 3), 0);
-    
-    // Get reference brightness from cheek area (should be consistent)
-    Rect cheek_area(face_roi.cols * 0.15, face_roi.rows * 0.5, face_roi.cols * 0.2, face_roi.rows * 0.15);
-    if (cheek_area.x + cheek_area.width < gray.cols && cheek_area.y + cheek_area.height < gray.rows) {
-        Scalar cheek_mean = mean(gray(cheek_area));
-        int dynamic_threshold = (int)(cheek_mean[0] * 0.6);  // 60% of cheek brightness
-        
-        // Count dark pixels in mouth region (looking for mouth cavity)
-        int total_pixels = 0;
-        int dark_pixels = 0;
-        int very_dark_pixels = 0;
-        
-        // Scan multiple horizontal lines in mouth region
-        for (int y_offset = 0; y_offset < mouth_height; y_offset += 2) {
-            int scan_y = mouth_y + y_offset;
-            if (scan_y >= gray.rows) break;
-            
-            for (int x = mouth_x_start; x < mouth_x_end; x += 1) {
-                if (x < gray.cols) {
-                    uchar pixel_value = gray.at<uchar>(scan_y, x);
-                    total_pixels++;
-                    
-                    if (pixel_value < dynamic_threshold) {
-                        dark_pixels++;
-                    }
-                    if (pixel_value < dynamic_threshold * 0.7) {
-                        very_dark_pixels++;
-                    }
-                }
+    photo_status_until = chrono::steady_clock::now() + chrono::seconds(2);
+}
+
+void FaceMeshApp::reportPhotos(Mat& display_frame) {
+    PhotoResult result;
+    while (photo_results.tryPop(result)) {
+        if (result.image_saved) {
+            cout << "\n🎭 Face capture saved: " << result.filename << endl;
+            cout << "   📊 Faces detected: " << result.faces << endl;
+            if (result.data_queued) {
+                cout << "   💾 Data queued for MongoDB" << endl;
             }
+            cout << "   ⏱️  encode " << fixed << setprecision(1) << result.encode_ms << " ms"
+                 << " | document " << result.persist_ms << " ms"
+                 << " | total " << result.total_ms << " ms (off the UI thread)" << endl;
+            cout.unsetf(ios::floatfield);
+            photo_status = "Saved " + result.filename;
+        } else {
+            cout << "❌ Failed to save image: " << result.filename << endl;
+            photo_status = "Photo failed";
         }
-        
-        // Calculate ratios
-        float dark_ratio = (total_pixels > 0) ? (float)dark_pixels / total_pixels : 0;
-        float very_dark_ratio = (total_pixels > 0) ? (float)very_dark_pixels / total_pixels : 0;
-        
-        // Debug output
-        // cout << "Cheek ref: " << (int)cheek_mean[0] << ", Threshold: " << dynamic_threshold 
-        //      << ", Dark: " << dark_pixels << "/" << total_pixels << " (" << dark_ratio 
-        //      << "), Very dark: " << very_dark_pixels << " (" << very_dark_ratio << ")" << endl;
-        
-        // More forgiving thresholds with better logic
-        bool mouth_detected = (very_dark_ratio > 0.12f) || (dark_ratio > 0.35f && very_dark_ratio > 0.05f);
-        
-        if (mouth_detected) {
-           // cout << "� MOUTH OPEN DETECTED! (Multi-line scan method)" << endl;
-        }
-        
-        return mouth_detected;
+        photo_status_until = chrono::steady_clock::now() + chrono::seconds(2);
     }
     
-    // Fallback to original method if cheek detection fails
-    return false;
+    if (!display_frame.empty() && !photo_status.empty() && chrono::steady_clock::now() < photo_status_until) {
+        putText(display_frame, photo_status, Point(10, display_frame.rows - 20),
+                FONT_HERSHEY_SIMPLEX, 0.6, Scalar(255, 255, 255), 2);
+    }
 }
 
-Point2f FaceMeshApp::getMouthCenter(const vector<FaceLandmark>& landmarks) {
-    // Use the actual mouth center landmark (landmark 48)
-    if (landmarks.size() > 48) {
-        return landmarks[48].point;
+void FaceMeshApp::showAppStats() {
+    cout << "\n📊 APP STATISTICS:" << endl;
+    cout << "  Camera available: " << (use_real_camera ? "Yes" : "No") << endl;
+    cout << "  Face detection: " << (face_detection_enabled ? "Enabled" : "Disabled") << endl;
+    cout << "  Pokémon: " << pokemon_name << endl;
+    cout << "  Mask file: " << selected_mask_file << endl;
+    cout << "  Analyses performed: " << (photo_counter - 1) << endl;
+    cout << "  Particles active: " << face_effects.getStats().particles << endl;
+    {
+        lock_guard<mutex> guard(detection_mutex);
+        if (face_analyzer.getDetector()) {
+            cout << "  Face detector: " << face_analyzer.getDetector()->name() << endl;
+        }
+        cout << "  Face tracking: " << (face_analyzer.isTrackingEnabled() ? "Enabled" : "Disabled") 
+             << " (detector runs: " << face_analyzer.getCascadeRuns()
+             << ", tracked frames: " << face_analyzer.getTrackedFrames()
+             << ", lost: " << face_analyzer.getLostCount() << ")" << endl;
+        cout << "  Faces followed: " << face_analyzer.getTrackCount()
+             << " (IDs handed out: " << face_analyzer.getFacesCreated() << ")" << endl;
+    }
+    
+    // The aggregation would sit out the server selection timeout while MongoDB is down
+    if (mongoReachable()) {
+        flushCaptureWrites();
+        auto stats = mongo_handler->getStatistics();
+        cout << "  MongoDB captures: " << stats.first << endl;
+        cout << "  Total faces saved: " << stats.second << endl;
+    } else {
+        cout << "  MongoDB captures: unknown (MongoDB unreachable)" << endl;
+    }
+    
+    // Last known result only: a fresh ping would stall the render thread while MongoDB is down
+    MongoConnectionStats connection = mongo_handler->getConnection().getStats();
+    const MongoPingResult& ping = connection.last_ping;
+    cout << "  MongoDB ping: ";
+    if (connection.pings == 0) {
+        cout << "none yet";
+    } else {
+        auto age = chrono::duration_cast<chrono::seconds>(chrono::steady_clock::now() - ping.sent_at);
+        cout << (ping.ok ? "ok" : "failed") << " (" << fixed << setprecision(1)
+             << ping.round_trip_ms << " ms, " << age.count() << " s ago)";
     }
-    // Fallback to old calculation if landmarks not available
-    return Point2f(0, 0);
+    if (spool_replayer) cout << " | replay: " << (spool_replayer->getStats().online ? "online" : "offline");
+    cout << " | client checkouts: " << connection.checkouts << endl;
+    cout.unsetf(ios::floatfield);
+    
+    showPipelineStats();
 }
 
-Mat FaceMeshApp::drawFaceWithMouthEmoji(const Mat& image, const vector<DetectedFace>& faces) {
-    Mat result = image.clone();
+void FaceMeshApp::showPipelineStats() {
+    auto printStage = [](const string& name, const StageStats& stage) {
+        cout << "  " << left << setw(12) << name << right
+             << " frames: " << setw(6) << stage.frames.load()
+             << " | avg: " << fixed << setprecision(2) << stage.averageMs() << " ms"
+             << " | last: " << stage.lastMs() << " ms"
+             << " | max: " << stage.maxMs() << " ms" << endl;
+    };
+    auto printQueue = [](const string& name, size_t depth, size_t capacity,
+                         uint64_t pushed, uint64_t dropped) {
+        cout << "  " << left << setw(12) << name << right
+             << " depth: " << depth << "/" << capacity
+             << " | pushed: " << pushed
+             << " | dropped: " << dropped << endl;
+    };
     
-    for (const auto& face : faces) {
-        // Apply custom mask if loaded
-        if (mask_loaded && !mask_image.empty()) {
-            result = applyCustomMask(result, face);
-        }
-        
-        // Update particle system
-        if (face.mouth_center.x > 0 && face.mouth_center.y > 0) {
-            result = updateWaterParticles(result, face.mouth_center, face.mouth_open);
-        }
-        
-        // Draw face rectangle
-        //rectangle(result, face.rect, Scalar(0, 255, 0), 2);
-        
-        // Add mouth state text
-        string mouth_state = face.mouth_open ? "MOUTH OPEN" : "MOUTH CLOSED";
-        Scalar text_color = face.mouth_open ? Scalar(0, 255, 0) : Scalar(0, 255, 255);
-        // putText(result, mouth_state, 
-        //            Point(face.rect.x, face.rect.y - 10), 
-        //            FONT_HERSHEY_SIMPLEX, 0.6, text_color, 2);
+    cout << "\n⏱️  PIPELINE STATISTICS:" << endl;
+    printStage("capture", pipeline_stats.capture);
+    printStage("detect", pipeline_stats.detect);
+    printStage("render", pipeline_stats.render);
+    printStage("frame age", pipeline_stats.frame_age);
+    printStage("photo", pipeline_stats.photo);
+    printQueue("detect q", detect_queue.size(), detect_queue.capacity(),
+               detect_queue.pushedCount(), detect_queue.droppedCount());
+    printQueue("display q", display_queue.size(), display_queue.capacity(),
+               display_queue.pushedCount(), display_queue.droppedCount());
+    printQueue("result q", result_queue.size(), result_queue.capacity(),
+               result_queue.pushedCount(), result_queue.droppedCount());
+    if (recorder.isRecording() || recorder.getFramesWritten() > 0) {
+        const StageStats& encode = recorder.getEncodeStats();
+        cout << "  recording: " << (recorder.isRecording() ? "on" : "off")
+             << " | frames: " << recorder.getFramesWritten()
+             << " | dropped: " << recorder.getDroppedFrames()
+             << " | encode avg: " << fixed << setprecision(2) << encode.averageMs() << " ms"
+             << " | max: " << encode.maxMs() << " ms" << endl;
+    }
+    cout << "  photos saved: " << photo_writer->getCompleted()
+         << " | pending: " << photo_writer->getPending() << "/" << photo_writer->getCapacity()
+         << " | skipped (busy): " << photo_writer->getRejected()
+         << " | encode avg: " << fixed << setprecision(2) << photo_writer->getEncodeStats().averageMs() << " ms"
+         << " | document avg: " << photo_writer->getPersistStats().averageMs() << " ms" << endl;
+    WriteBehindStats writes = write_behind->getStats();
+    cout << "  mongo writes: " << writes.written << "/" << writes.enqueued
+         << " | pending: " << writes.pending
+         << " | batches: " << writes.batches << " (avg " << setprecision(1) << writes.average_batch << " docs)"
+         << " | flush avg: " << setprecision(2) << writes.average_flush_ms << " ms"
+         << " | max: " << writes.max_flush_ms << " ms"
+         << " | " << setprecision(1) << writes.documents_per_second << " docs/s"
+         << " | failed: " << writes.failed << " | rejected: " << writes.rejected << endl;
+    if (spool_replayer) {
+        SpoolStats spooled = capture_spool->getStats();
+        SpoolReplayStats replay = spool_replayer->getStats();
+        cout << "  capture spool: " << spooled.appended << " appended"
+             << " | pending: " << spooled.pending_records << " (" << spooled.pending_bytes / 1024 << " KB)"
+             << " | fsyncs: " << spooled.syncs << " (avg " << setprecision(2) << spooled.average_sync_ms
+             << " ms, max " << spooled.max_sync_ms << " ms)"
+             << " | replayed: " << replay.replayed << " in " << replay.batches << " batches"
+             << " (" << setprecision(1) << replay.documents_per_second << " docs/s)"
+             << " | MongoDB " << (replay.stalled ? "stalled" : replay.online ? "online" : "offline")
+             << " | failed batches: " << replay.failed_batches
+             << " | rejected: " << replay.rejected
+             << " | corrupt: " << spooled.corrupt_bytes << " bytes" << endl;
+    }
+    cout << "  capture pool buffers: " << capture_pool.size()
+         << " | allocations: " << capture_pool.getAllocationCount()
+         << " | overflows: " << capture_pool.getOverflowCount() << endl;
+    
+    // Effects are per face; report the totals
+    FaceEffectsStats effects = face_effects.getStats();
+    const ParticleAllocatorStats& particle_stats = effects.particle_alloc;
+    SmoothingStats smoothing;
+    bool smoothing_enabled;
+    {
+        lock_guard<mutex> guard(detection_mutex);
+        smoothing = face_analyzer.getSmoothingStats();
+        smoothing_enabled = face_analyzer.isSmoothingEnabled();
+    }
+    cout << "  smoothing: " << (smoothing_enabled ? "on" : "off")
+         << " | filter: " << setprecision(3) << smoothing.averageFilterUs() << " us/face"
+         << " | jitter raw: " << setprecision(2) << smoothing.averageRawJitter() << " px"
+         << " | smoothed: " << smoothing.averageSmoothedJitter() << " px" << endl;
+    cout << "  face effects: " << effects.faces
+         << " | worker threads: " << face_pool.size() << endl;
+    cout << "  mask sprite cache hits: " << effects.sprite_hits
+         << " | misses: " << effects.sprite_misses
+         << " | mip levels: " << effects.mip_levels << endl;
+    cout << "  particle arena blocks: " << particle_stats.arena_blocks
+         << " (" << particle_stats.bytes_in_use / 1024 << "/" << particle_stats.arena_bytes / 1024 << " KB)"
+         << " | spawned: " << particle_stats.spawned
+         << " | recycled: " << particle_stats.recycled
+         << " | rejected: " << particle_stats.rejected
+         << " | peak live: " << particle_stats.peak_live << endl;
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+}
+
+void FaceMeshApp::displayInstructions() {
+    CLIInterface::displayInstructions();
+}
+void FaceMeshApp::detectFacesWithMesh(const Mat& image, FaceList& faces) {
+    if (!face_detection_enabled) {
+        faces.clear();
+        return;
     }
     
-    return result;
+    // Key handlers change analyzer settings from the UI thread
+    lock_guard<mutex> guard(detection_mutex);
+    face_analyzer.analyze(image, faces);
 }
 
-Mat FaceMeshApp::drawFaceMeshOverlay(const Mat& image, const vector<DetectedFace>& faces) {
-    return drawFaceWithMouthEmoji(image, faces); 
+void FaceMeshApp::composeFrame(Mat& frame, const FaceList& faces, vector<Rect>& dirty) {
+    face_effects.setOffsets(mask_horizontal_offset, mask_vertical_offset);
+    face_effects.compose(frame, faces, dirty);
 }
 
 Mat FaceMeshApp::createMaskOverlay(const Mat& image, const DetectedFace& face) {
     Mat overlay = Mat::zeros(image.size(), CV_8UC3);
     
-    if (face.landmarks.empty()) return overlay;
+    if (!face.has_landmarks) return overlay;
     
-    if (mask_loaded && !mask_image.empty()) {
+    if (mask_loaded && !mask_asset.empty()) {
         // Use custom mask image
-        return applyCustomMask(image, face);
+        Mat result = image.clone();
+        MaskRenderer renderer;
+        renderer.setAsset(mask_asset);
+        renderer.setOffsets(mask_horizontal_offset, mask_vertical_offset);
+        renderer.apply(result, face);
+        return result;
     } else {
         // Use default procedural mask
         return createDefaultMask(image, face);
@@ -597,115 +716,12 @@ Mat FaceMeshApp::createDefaultMask(const Mat& image, const DetectedFace& face) {
         fillPoly(mask, vector<vector<Point>>{mask_points}, mask_color);
         
         // Add decorative elements
-        if (face.landmarks.size() > 42) {
-            circle(mask, Point(face.landmarks[36].point), 5, Scalar(255, 255, 0), -1);
-            circle(mask, Point(face.landmarks[42].point), 5, Scalar(255, 255, 0), -1);
-        }
-        
-        if (face.landmarks.size() > 30) {
-            circle(mask, Point(face.landmarks[30].point), 3, Scalar(0, 255, 255), -1);
+        if (face.has_landmarks) {
+            circle(mask, Point(face.landmarks[LANDMARK_RIGHT_EYE_CENTER]), 5, Scalar(255, 255, 0), -1);
+            circle(mask, Point(face.landmarks[LANDMARK_LEFT_EYE_CENTER]), 5, Scalar(255, 255, 0), -1);
+            circle(mask, Point(face.landmarks[LANDMARK_NOSE_TIP]), 3, Scalar(0, 255, 255), -1);
         }
     }
     
     return mask;
 }
-
-Mat FaceMeshApp::applyCustomMask(const Mat& image, const DetectedFace& face) {
-    Mat result = image.clone();
-    
-    // Calculate face dimensions and position
-    Rect face_rect = face.rect;
-    float face_width = face_rect.width;
-    float face_height = face_rect.height;
-    
-    // Resize mask to fit face
-    Mat resized_mask;
-    float scale_factor = 1.4f; // Make mask slightly larger than face
-    int mask_width = static_cast<int>(face_width * scale_factor);
-    int mask_height = static_cast<int>(face_height * scale_factor);
-    
-    resize(mask_image, resized_mask, Size(mask_width, mask_height));
-    
-    // Calculate position to align mask with face features
-    float vertical_offset = -0.7f + mask_vertical_offset;
-    float horizontal_offset = 0.0f + mask_horizontal_offset;
-    
-    int mask_x = face_rect.x - (mask_width - face_width) / 2 + static_cast<int>(face_width * horizontal_offset);
-    int mask_y = face_rect.y - (mask_height - face_height) / 2 + static_cast<int>(face_height * vertical_offset);
-    
-    // Fine-tune positioning based on eye landmarks if available
-    if (face.landmarks.size() > 42) {
-        Point2f left_eye = face.landmarks[36].point;
-        Point2f right_eye = face.landmarks[42].point;
-        
-        Point2f eye_center;
-        float face_center_x = face_rect.x + face_rect.width * 0.5f;
-        
-        eye_center.x = face_center_x;
-        eye_center.y = (left_eye.y + right_eye.y) * 0.5f;
-        
-        float eye_offset_y = -face_height * 0.35f;
-        
-        mask_y = static_cast<int>(eye_center.y + eye_offset_y - mask_height * 0.3f + face_height * mask_vertical_offset);
-        mask_x = static_cast<int>(eye_center.x - mask_width * 0.5f + face_width * mask_horizontal_offset);
-    }
-    
-    // Create rotation matrix if face is angled
-    Mat rotation_matrix = getRotationMatrix2D(Point2f(mask_width/2, mask_height/2), 
-                                                      face.face_angle, 1.0);
-    Mat rotated_mask;
-    warpAffine(resized_mask, rotated_mask, rotation_matrix, Size(mask_width, mask_height));
-    
-    // Apply mask with proper blending
-    for (int y = 0; y < rotated_mask.rows; y++) {
-        for (int x = 0; x < rotated_mask.cols; x++) {
-            int img_x = mask_x + x;
-            int img_y = mask_y + y;
-            
-            // Check bounds
-            if (img_x >= 0 && img_x < result.cols && img_y >= 0 && img_y < result.rows) {
-                Vec3b mask_pixel = rotated_mask.at<Vec3b>(y, x);
-                Vec3b img_pixel = result.at<Vec3b>(img_y, img_x);
-                
-                // Apply mask with transparency based on brightness
-                float alpha = 1.0f; // Base transparency
-                
-                // If mask has 4 channels (RGBA), use alpha channel
-                if (rotated_mask.channels() == 4) {
-                    Vec4b mask_pixel_rgba = rotated_mask.at<Vec4b>(y, x);
-                    alpha = mask_pixel_rgba[3] / 255.0f * 0.7f; // Use alpha channel
-                    mask_pixel = Vec3b(mask_pixel_rgba[0], mask_pixel_rgba[1], mask_pixel_rgba[2]);
-                }
-                
-                // Skip transparent or very dark pixels
-                if (mask_pixel[0] + mask_pixel[1] + mask_pixel[2] > 30) {
-                    // Blend mask with original image
-                    result.at<Vec3b>(img_y, img_x) = Vec3b(
-                        static_cast<uchar>(img_pixel[0] * (1 - alpha) + mask_pixel[0] * alpha),
-                        static_cast<uchar>(img_pixel[1] * (1 - alpha) + mask_pixel[1] * alpha),
-                        static_cast<uchar>(img_pixel[2] * (1 - alpha) + mask_pixel[2] * alpha)
-                    );
-                }
-            }
-        }
-    }
-    
-    return result;
-}
-
-Mat FaceMeshApp::updateWaterParticles(const Mat& image, const Point2f& mouth_center, bool mouth_open) {
-    Mat result = image.clone();
-    
-    particle_system.setEmitPosition(mouth_center);
-    
-    if (mouth_open) {
-        particle_system.startEmission();
-    } else {
-        particle_system.stopEmission();
-    }
-    
-    particle_system.update();
-    particle_system.draw(result);
-    
-    return result;
-}
@@ -0,0 +1,114 @@
+#include "../headers/face_smoother.h"
+#include <chrono>
+#include <cmath>
+
+namespace {
+    float smoothingFactor(float cutoff, float dt) {
+        float tau = 1.0f / (2.0f * static_cast<float>(M_PI) * cutoff);
+        return 1.0f / (1.0f + tau / dt);
+    }
+    
+    double elapsedUs(chrono::steady_clock::time_point start) {
+        return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+    }
+}
+
+void SmoothingStats::add(const SmoothingStats& other) {
+    filtered += other.filtered;
+    samples += other.samples;
+    filter_us += other.filter_us;
+    raw_jitter += other.raw_jitter;
+    smoothed_jitter += other.smoothed_jitter;
+}
+
+double SmoothingStats::averageFilterUs() const {
+    return filtered > 0 ? filter_us / filtered : 0.0;
+}
+
+double SmoothingStats::averageRawJitter() const {
+    return samples > 0 ? raw_jitter / samples : 0.0;
+}
+
+double SmoothingStats::averageSmoothedJitter() const {
+    return samples > 0 ? smoothed_jitter / samples : 0.0;
+}
+
+OneEuroChannel::OneEuroChannel() : value(0.0f), derivative(0.0f), initialized(false) {
+}
+
+float OneEuroChannel::filter(float x, float dt, const OneEuroParams& params) {
+    if (!initialized || dt <= 0.0f) {
+        value = x;
+        derivative = 0.0f;
+        initialized = true;
+        return value;
+    }
+    
+    // Smoothed speed decides how much to trust the new sample
+    float raw_derivative = (x - value) / dt;
+    derivative += smoothingFactor(params.derivative_cutoff, dt) * (raw_derivative - derivative);
+    float cutoff = params.min_cutoff + params.beta * fabs(derivative);
+    value += smoothingFactor(cutoff, dt) * (x - value);
+    return value;
+}
+
+void OneEuroChannel::reset() {
+    initialized = false;
+}
+
+FaceSmoother::FaceSmoother() : last_time(0.0), last_dt(0.0f), history(0) {
+}
+
+Rect FaceSmoother::filterRect(const Rect& raw, double time_s, const OneEuroParams& params) {
+    auto start = chrono::steady_clock::now();
+    
+    last_dt = history > 0 ? static_cast<float>(time_s - last_time) : 0.0f;
+    last_time = time_s;
+    
+    Point2f raw_center(raw.x + raw.width * 0.5f, raw.y + raw.height * 0.5f);
+    Point2f center(channels[CENTER_X].filter(raw_center.x, last_dt, params),
+                   channels[CENTER_Y].filter(raw_center.y, last_dt, params));
+    float width = channels[WIDTH].filter(static_cast<float>(raw.width), last_dt, params);
+    float height = channels[HEIGHT].filter(static_cast<float>(raw.height), last_dt, params);
+    
+    Rect smoothed(cvRound(center.x - width * 0.5f), cvRound(center.y - height * 0.5f),
+                  cvRound(width), cvRound(height));
+    
+    // Acceleration of the center: zero for steady motion, high for jitter
+    if (history == 2) {
+        Point2f raw_accel = raw_center - raw_history[0] * 2.0f + raw_history[1];
+        Point2f smoothed_accel = center - smoothed_history[0] * 2.0f + smoothed_history[1];
+        stats.raw_jitter += sqrt(raw_accel.dot(raw_accel));
+        stats.smoothed_jitter += sqrt(smoothed_accel.dot(smoothed_accel));
+        stats.samples++;
+    }
+    raw_history[1] = raw_history[0];
+    raw_history[0] = raw_center;
+    smoothed_history[1] = smoothed_history[0];
+    smoothed_history[0] = center;
+    history = min(history + 1, 2);
+    
+    stats.filtered++;
+    stats.filter_us += elapsedUs(start);
+    return smoothed;
+}
+
+double FaceSmoother::filterAngle(double raw_degrees, const OneEuroParams& params) {
+    auto start = chrono::steady_clock::now();
+    
+    // Unwrap so a step across +-180 degrees is filtered as a small turn
+    double previous = channels[ANGLE].last();
+    while (raw_degrees - previous > 180.0) raw_degrees -= 360.0;
+    while (raw_degrees - previous < -180.0) raw_degrees += 360.0;
+    double angle = channels[ANGLE].filter(static_cast<float>(raw_degrees), last_dt, params);
+    
+    stats.filter_us += elapsedUs(start);
+    return remainder(angle, 360.0);
+}
+
+void FaceSmoother::reset() {
+    for (auto& channel : channels) {
+        channel.reset();
+    }
+    history = 0;
+}
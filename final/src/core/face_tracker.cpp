@@ -0,0 +1,117 @@
+#include "../headers/face_tracker.h"
+#include <algorithm>
+
+FaceTracker::FaceTracker(int interval, float min_score, float margin)
+    : confidence(0.0f),
+      tracking(false),
+      frames_since_detection(0),
+      detect_interval(max(1, interval)),
+      min_confidence(min_score),
+      search_margin(margin),
+      template_width(32),
+      full_detections(0),
+      tracked_frames(0),
+      lost_count(0) {
+}
+
+bool FaceTracker::needsDetection() const {
+    return !tracking || frames_since_detection >= detect_interval - 1;
+}
+
+void FaceTracker::reset(const Mat& gray, const Rect& face_rect) {
+    Rect bounded = face_rect & Rect(0, 0, gray.cols, gray.rows);
+    if (bounded.width < 8 || bounded.height < 8) {
+        lose();
+        return;
+    }
+    
+    // Keep a small template so matching stays cheap regardless of face size
+    float scale = static_cast<float>(template_width) / bounded.width;
+    int template_height = max(8, static_cast<int>(bounded.height * scale));
+    resize(gray(bounded), face_template, Size(template_width, template_height), 0, 0, INTER_AREA);
+    
+    last_rect = bounded;
+    confidence = 1.0f;
+    tracking = true;
+    frames_since_detection = 0;
+}
+
+bool FaceTracker::track(const Mat& gray, Rect& face_rect) {
+    if (!tracking || face_template.empty()) return false;
+    
+    // Expanded search region around the previous box
+    int margin_x = static_cast<int>(last_rect.width * search_margin);
+    int margin_y = static_cast<int>(last_rect.height * search_margin);
+    Rect search(last_rect.x - margin_x, last_rect.y - margin_y,
+                last_rect.width + 2 * margin_x, last_rect.height + 2 * margin_y);
+    search &= Rect(0, 0, gray.cols, gray.rows);
+    if (search.width < last_rect.width || search.height < last_rect.height) {
+        lose();
+        return false;
+    }
+    
+    // Match at template scale
+    float scale = static_cast<float>(template_width) / last_rect.width;
+    Size scaled(max(face_template.cols, static_cast<int>(search.width * scale)),
+                max(face_template.rows, static_cast<int>(search.height * scale)));
+    resize(gray(search), search_patch, scaled, 0, 0, INTER_AREA);
+    matchTemplate(search_patch, face_template, match_result, TM_CCOEFF_NORMED);
+    
+    double max_score = 0.0;
+    Point max_loc;
+    minMaxLoc(match_result, nullptr, &max_score, nullptr, &max_loc);
+    confidence = static_cast<float>(max_score);
+    
+    if (confidence < min_confidence) {
+        lost_count++;
+        lose();
+        return false;
+    }
+    
+    // Map the match back to full resolution, keeping the detected size
+    last_rect.x = search.x + static_cast<int>(max_loc.x / scale);
+    last_rect.y = search.y + static_cast<int>(max_loc.y / scale);
+    face_rect = last_rect & Rect(0, 0, gray.cols, gray.rows);
+    
+    frames_since_detection++;
+    tracked_frames++;
+    return true;
+}
+
+void FaceTracker::lose() {
+    tracking = false;
+    confidence = 0.0f;
+    frames_since_detection = 0;
+}
+
+void FaceTracker::countDetection() {
+    full_detections++;
+}
+
+void FaceTracker::setDetectInterval(int interval) {
+    detect_interval = max(1, interval);
+}
+
+int FaceTracker::getDetectInterval() const {
+    return detect_interval;
+}
+
+float FaceTracker::getConfidence() const {
+    return confidence;
+}
+
+bool FaceTracker::isTracking() const {
+    return tracking;
+}
+
+uint64_t FaceTracker::getFullDetections() const {
+    return full_detections;
+}
+
+uint64_t FaceTracker::getTrackedFrames() const {
+    return tracked_frames;
+}
+
+uint64_t FaceTracker::getLostCount() const {
+    return lost_count;
+}
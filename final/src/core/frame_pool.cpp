@@ -0,0 +1,45 @@
+#include "../headers/frame_pool.h"
+
+FramePool::FramePool(size_t capacity)
+    : max_buffers(capacity > 0 ? capacity : 1), next(0), allocations(0), overflows(0) {
+    buffers.reserve(max_buffers);
+}
+
+Mat FramePool::acquire(Size size, int type) {
+    for (size_t i = 0; i < buffers.size(); i++) {
+        Mat& buffer = buffers[(next + i) % buffers.size()];
+        
+        // refcount == 1 means only the pool still holds the buffer
+        if (buffer.u != nullptr && CV_XADD(&buffer.u->refcount, 0) != 1) continue;
+        
+        if (buffer.size() != size || buffer.type() != type) {
+            buffer.create(size, type);
+            allocations++;
+        }
+        next = (next + i + 1) % buffers.size();
+        return buffer;
+    }
+    
+    if (buffers.size() < max_buffers) {
+        buffers.emplace_back(size, type);
+        allocations++;
+        return buffers.back();
+    }
+    
+    // Every buffer is still in flight; hand out a one-off frame
+    overflows++;
+    allocations++;
+    return Mat(size, type);
+}
+
+size_t FramePool::size() const {
+    return buffers.size();
+}
+
+uint64_t FramePool::getAllocationCount() const {
+    return allocations;
+}
+
+uint64_t FramePool::getOverflowCount() const {
+    return overflows;
+}
@@ -0,0 +1,132 @@
+#include "../headers/landmark_template.h"
+#include <cmath>
+#include <opencv2/core/hal/intrin.hpp>
+
+namespace {
+    const char* const LANDMARK_NAMES[FACE_LANDMARK_COUNT] = {
+        // Jaw line (17 points: 0-16)
+        "jaw_1", "jaw_2", "jaw_3", "jaw_4", "jaw_5", "jaw_6", "jaw_7", "jaw_8", "jaw_9",
+        "jaw_10", "jaw_11", "jaw_12", "jaw_13", "jaw_14", "jaw_15", "jaw_16", "jaw_17",
+        
+        // Right eyebrow (5 points: 17-21)
+        "right_eyebrow_1", "right_eyebrow_2", "right_eyebrow_3", "right_eyebrow_4", "right_eyebrow_5",
+        
+        // Left eyebrow (5 points: 22-26)
+        "left_eyebrow_1", "left_eyebrow_2", "left_eyebrow_3", "left_eyebrow_4", "left_eyebrow_5",
+        
+        // Nose (9 points: 27-35)
+        "nose_1", "nose_2", "nose_3", "nose_4", "nose_5", "nose_6", "nose_7", "nose_8", "nose_9",
+        
+        // Right eye (6 points: 36-41)
+        "right_eye_center", "right_eye_1", "right_eye_2", "right_eye_3", "right_eye_4", "right_eye_5",
+        
+        // Left eye (6 points: 42-47)
+        "left_eye_center", "left_eye_1", "left_eye_2", "left_eye_3", "left_eye_4", "left_eye_5",
+        
+        // Mouth (20 points: 48-67)
+        "mouth_center", "mouth_outer_1", "mouth_outer_2", "mouth_outer_3", "mouth_outer_4", "mouth_outer_5",
+        "mouth_outer_6", "mouth_outer_7", "mouth_outer_8", "mouth_outer_9", "mouth_outer_10",
+        "mouth_outer_11", "mouth_inner_1", "mouth_inner_2", "mouth_inner_3", "mouth_inner_4",
+        "mouth_inner_5", "mouth_inner_6", "mouth_inner_7", "mouth_inner_8"
+    };
+}
+
+LandmarkTemplate::LandmarkTemplate() {
+    // Same layout as the old per-frame generator, with the face rect at
+    // (0, 0, 1, 1); the face center is (0.5, 0.5)
+    int id = 0;
+    auto set = [&](float u, float v) {
+        uv[2 * id] = u;
+        uv[2 * id + 1] = v;
+        id++;
+    };
+    
+    // Jaw line (17 points)
+    for (int i = 0; i < 17; i++) {
+        float t = i / 16.0f;
+        set(t, 0.8f + sin(t * M_PI) * 0.1f);
+    }
+    
+    // Right eyebrow (5 points)
+    for (int i = 0; i < 5; i++) {
+        float t = i / 4.0f;
+        set(0.5f - 0.25f + t * 0.25f, 0.5f - 0.25f - 0.05f * sin(t * M_PI));
+    }
+    
+    // Left eyebrow (5 points)
+    for (int i = 0; i < 5; i++) {
+        float t = i / 4.0f;
+        set(0.5f + t * 0.25f, 0.5f - 0.25f - 0.05f * sin(t * M_PI));
+    }
+    
+    // Nose (9 points)
+    for (int i = 0; i < 9; i++) {
+        float t = i / 8.0f;
+        set(0.5f + (i % 3 - 1) * 0.05f, 0.5f - 0.1f + t * 0.2f);
+    }
+    
+    // Eyes (center + 5 points on an ellipse each)
+    for (float eye_u : {0.5f - 0.18f, 0.5f + 0.18f}) {
+        float eye_v = 0.5f - 0.1f;
+        set(eye_u, eye_v);
+        for (int i = 1; i < 6; i++) {
+            float angle = i * 2 * M_PI / 6;
+            set(eye_u + cos(angle) * 0.06f, eye_v + sin(angle) * 0.03f);
+        }
+    }
+    
+    // Mouth (center + 11 outer and 8 inner points)
+    float mouth_u = 0.5f;
+    float mouth_v = 0.5f + 0.42f;
+    set(mouth_u, mouth_v);
+    for (int i = 1; i < 20; i++) {
+        float angle = i * 2 * M_PI / 20;
+        float radius = (i < 12) ? 0.15f : 0.1f;
+        set(mouth_u + cos(angle) * radius, mouth_v + sin(angle) * 0.08f);
+    }
+    
+    CV_Assert(id == FACE_LANDMARK_COUNT);
+}
+
+const LandmarkTemplate& LandmarkTemplate::shared() {
+    static const LandmarkTemplate layout;
+    return layout;
+}
+
+void LandmarkTemplate::apply(const Rect& face_rect, FaceLandmarks& landmarks) const {
+    // Point2f is two packed floats, so the landmarks are 136 floats laid
+    // out exactly like the template
+    static_assert(sizeof(FaceLandmarks) == sizeof(float) * FACE_LANDMARK_COUNT * 2,
+                  "FaceLandmarks must be tightly packed points");
+    float* out = reinterpret_cast<float*>(landmarks.data());
+    const float w = static_cast<float>(face_rect.width);
+    const float h = static_cast<float>(face_rect.height);
+    const float x = static_cast<float>(face_rect.x);
+    const float y = static_cast<float>(face_rect.y);
+    const int n = FACE_LANDMARK_COUNT * 2;
+    int i = 0;
+    
+#if CV_SIMD128
+    alignas(16) const float scale_lanes[4] = {w, h, w, h};
+    alignas(16) const float offset_lanes[4] = {x, y, x, y};
+    const v_float32x4 scale = v_load(scale_lanes);
+    const v_float32x4 offset = v_load(offset_lanes);
+    for (; i + v_float32x4::nlanes <= n; i += v_float32x4::nlanes) {
+        v_store(out + i, v_fma(v_load(uv + i), scale, offset));
+    }
+#endif
+    
+    for (; i < n; i += 2) {
+        out[i] = x + uv[i] * w;
+        out[i + 1] = y + uv[i + 1] * h;
+    }
+}
+
+Point2f LandmarkTemplate::normalized(int landmark_id) const {
+    return Point2f(uv[2 * landmark_id], uv[2 * landmark_id + 1]);
+}
+
+const char* landmarkName(int landmark_id) {
+    if (landmark_id < 0 || landmark_id >= FACE_LANDMARK_COUNT) return "unknown";
+    return LANDMARK_NAMES[landmark_id];
+}
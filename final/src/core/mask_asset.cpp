@@ -0,0 +1,249 @@
+#include "../headers/mask_asset.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace MaskAssets {
+    namespace {
+        // Cache layout (native byte order):
+        //   "PKMA" u32 version u32 count, then per asset:
+        //   u32 name_len, name, u64 source bytes, i64 source mtime,
+        //   i32 original w/h, i32 bounds x/y/w/h,
+        //   u32 span_count, spans as i32 triples, bounds.w * bounds.h * 4 pixel bytes
+        const char CACHE_MAGIC[4] = {'P', 'K', 'M', 'A'};
+        const uint32_t CACHE_VERSION = 2;
+        const char CACHE_PATH[] = "images/mask_assets.bin";
+
+        template <typename T>
+        void writeValue(ofstream& out, T value) {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template <typename T>
+        bool readValue(ifstream& in, T& value) {
+            return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+        }
+
+        bool readHeader(ifstream& in, uint32_t& count) {
+            char magic[4];
+            uint32_t version = 0;
+            return in.read(magic, sizeof(magic)) && memcmp(magic, CACHE_MAGIC, sizeof(magic)) == 0 &&
+                   readValue(in, version) && version == CACHE_VERSION && readValue(in, count);
+        }
+
+        /**
+         * @brief Read one cache entry; with want_pixels false the spans and pixels are skipped
+         */
+        bool readEntry(ifstream& in, MaskAsset& asset, bool want_pixels) {
+            uint32_t name_len = 0;
+            if (!readValue(in, name_len) || name_len > 4096) return false;
+            asset.name.resize(name_len);
+            if (!in.read(&asset.name[0], name_len)) return false;
+            if (!readValue(in, asset.source_bytes) || !readValue(in, asset.source_mtime)) return false;
+
+            int32_t values[6];
+            for (auto& value : values) {
+                if (!readValue(in, value)) return false;
+            }
+            asset.original_size = Size(values[0], values[1]);
+            asset.bounds = Rect(values[2], values[3], values[4], values[5]);
+            if (asset.bounds.width < 0 || asset.bounds.height < 0) return false;
+
+            uint32_t span_count = 0;
+            if (!readValue(in, span_count)) return false;
+            if (!want_pixels) {
+                streamoff skip = static_cast<streamoff>(span_count) * 3 * sizeof(int32_t) +
+                                 static_cast<streamoff>(asset.bounds.area()) * 4;
+                return static_cast<bool>(in.seekg(skip, ios::cur));
+            }
+
+            asset.spans.resize(span_count);
+            for (auto& span : asset.spans) {
+                if (!readValue(in, span.y) || !readValue(in, span.x_begin) || !readValue(in, span.x_end)) {
+                    return false;
+                }
+            }
+
+            if (!asset.bounds.empty()) {
+                asset.pixels.create(asset.bounds.size(), CV_8UC4);
+                for (int y = 0; y < asset.pixels.rows; y++) {
+                    if (!in.read(reinterpret_cast<char*>(asset.pixels.ptr<uchar>(y)), asset.pixels.cols * 4)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    }
+
+    MaskAsset prepare(const Mat& mask, const string& name, float alpha_scale, int dark_threshold) {
+        MaskAsset asset;
+        asset.name = name;
+        asset.original_size = mask.size();
+        if (mask.empty() || mask.depth() != CV_8U) return asset;
+
+        // Masks without alpha are drawn fully opaque
+        Mat bgra;
+        float scale = 1.0f;
+        if (mask.channels() == 4) {
+            bgra = mask;
+            scale = alpha_scale;
+        } else if (mask.channels() == 3) {
+            cvtColor(mask, bgra, COLOR_BGR2BGRA);
+        } else if (mask.channels() == 1) {
+            cvtColor(mask, bgra, COLOR_GRAY2BGRA);
+        } else {
+            return asset;
+        }
+
+        Mat premultiplied(bgra.size(), CV_8UC4);
+        for (int y = 0; y < bgra.rows; y++) {
+            const uchar* src = bgra.ptr<uchar>(y);
+            uchar* dst = premultiplied.ptr<uchar>(y);
+            for (int x = 0; x < bgra.cols; x++, src += 4, dst += 4) {
+                int alpha = static_cast<int>(lround(src[3] * scale));
+                if (src[0] + src[1] + src[2] <= dark_threshold) alpha = 0;
+
+                dst[0] = static_cast<uchar>((src[0] * alpha + 127) / 255);
+                dst[1] = static_cast<uchar>((src[1] * alpha + 127) / 255);
+                dst[2] = static_cast<uchar>((src[2] * alpha + 127) / 255);
+                dst[3] = static_cast<uchar>(alpha);
+            }
+        }
+
+        asset.bounds = BlendKernels::findOpaqueSpans(premultiplied, asset.spans);
+        if (asset.bounds.empty()) {
+            asset.spans.clear();
+            return asset;
+        }
+
+        asset.pixels = premultiplied(asset.bounds).clone();
+        for (auto& span : asset.spans) {
+            span.y -= asset.bounds.y;
+            span.x_begin -= asset.bounds.x;
+            span.x_end -= asset.bounds.x;
+        }
+        return asset;
+    }
+
+    bool saveCache(const string& path, const vector<MaskAsset>& assets) {
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out) return false;
+
+        out.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        writeValue<uint32_t>(out, CACHE_VERSION);
+        writeValue<uint32_t>(out, static_cast<uint32_t>(assets.size()));
+
+        for (const auto& asset : assets) {
+            writeValue<uint32_t>(out, static_cast<uint32_t>(asset.name.size()));
+            out.write(asset.name.data(), asset.name.size());
+            writeValue<uint64_t>(out, asset.source_bytes);
+            writeValue<int64_t>(out, asset.source_mtime);
+            writeValue<int32_t>(out, asset.original_size.width);
+            writeValue<int32_t>(out, asset.original_size.height);
+            writeValue<int32_t>(out, asset.bounds.x);
+            writeValue<int32_t>(out, asset.bounds.y);
+            writeValue<int32_t>(out, asset.pixels.empty() ? 0 : asset.bounds.width);
+            writeValue<int32_t>(out, asset.pixels.empty() ? 0 : asset.bounds.height);
+
+            writeValue<uint32_t>(out, static_cast<uint32_t>(asset.spans.size()));
+            for (const auto& span : asset.spans) {
+                writeValue<int32_t>(out, span.y);
+                writeValue<int32_t>(out, span.x_begin);
+                writeValue<int32_t>(out, span.x_end);
+            }
+
+            for (int y = 0; y < asset.pixels.rows; y++) {
+                out.write(reinterpret_cast<const char*>(asset.pixels.ptr<uchar>(y)),
+                          asset.pixels.cols * 4);
+            }
+        }
+        return static_cast<bool>(out);
+    }
+
+    bool loadCache(const string& path, vector<MaskAsset>& assets) {
+        assets.clear();
+        ifstream in(path, ios::binary);
+        uint32_t count = 0;
+        if (!in || !readHeader(in, count)) return false;
+
+        for (uint32_t i = 0; i < count; i++) {
+            MaskAsset asset;
+            if (!readEntry(in, asset, true)) return false;
+            assets.push_back(std::move(asset));
+        }
+        return true;
+    }
+
+    bool loadCached(const string& path, const string& name, MaskAsset& asset) {
+        ifstream in(path, ios::binary);
+        uint32_t count = 0;
+        if (!in || !readHeader(in, count)) return false;
+
+        for (uint32_t i = 0; i < count; i++) {
+            // Headers are read for every entry, pixels only for the one asked for
+            streampos entry_start = in.tellg();
+            MaskAsset entry;
+            if (!readEntry(in, entry, false)) return false;
+            if (entry.name != name) continue;
+
+            in.seekg(entry_start);
+            return readEntry(in, asset, true);
+        }
+        return false;
+    }
+
+    bool stampSource(const string& source_path, MaskAsset& asset) {
+        error_code error;
+        uintmax_t bytes = filesystem::file_size(source_path, error);
+        if (error) return false;
+        auto modified = filesystem::last_write_time(source_path, error);
+        if (error) return false;
+        asset.source_bytes = static_cast<uint64_t>(bytes);
+        asset.source_mtime = static_cast<int64_t>(modified.time_since_epoch().count());
+        return true;
+    }
+
+    const MaskAsset* find(const vector<MaskAsset>& assets, const string& name) {
+        for (const auto& asset : assets) {
+            if (asset.name == name) return &asset;
+        }
+        return nullptr;
+    }
+
+    bool load(const string& mask_file, MaskAsset& asset, string& loaded_from) {
+        string source_path;
+        for (const auto& path : {"images/" + mask_file, mask_file, "./images/" + mask_file}) {
+            if (filesystem::exists(path)) {
+                source_path = path;
+                break;
+            }
+        }
+
+        // Preprocessed masks from `make assets` skip the per-load conversion,
+        // unless the PNG changed since the cache was built
+        MaskAsset cached;
+        if (loadCached(CACHE_PATH, mask_file, cached) && !cached.empty()) {
+            MaskAsset source;
+            bool current = source_path.empty() ||
+                           (stampSource(source_path, source) &&
+                            source.source_bytes == cached.source_bytes &&
+                            source.source_mtime == cached.source_mtime);
+            if (current) {
+                asset = std::move(cached);
+                loaded_from = CACHE_PATH;
+                return true;
+            }
+        }
+
+        if (source_path.empty()) return false;
+        Mat mask_image = imread(source_path, IMREAD_UNCHANGED);
+        if (mask_image.empty()) return false;
+        asset = prepare(mask_image, mask_file);
+        stampSource(source_path, asset);
+        loaded_from = source_path;
+        return true;
+    }
+}
@@ -0,0 +1,212 @@
+#include "../headers/mask_renderer.h"
+#include "../headers/blend_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+MaskRenderer::MaskRenderer()
+    : rotation_data{1, 0, 0, 0, 1, 0},
+      size_step(4),
+      angle_step(1.0),
+      use_clock(0),
+      cache_hits(0),
+      cache_misses(0),
+      vertical_offset(0.0f),
+      horizontal_offset(0.0f) {
+    sprite_cache.resize(6);
+}
+
+void MaskRenderer::setMask(const Mat& mask) {
+    setAsset(MaskAssets::prepare(mask, ""));
+}
+
+void MaskRenderer::setAsset(const MaskAsset& asset) {
+    mask_asset = asset;
+    
+    // Pre-bake a mip chain so big downscales start from a close level
+    mip_chain.clear();
+    if (!mask_asset.empty()) {
+        mip_chain.push_back(mask_asset.pixels);
+        while (mip_chain.back().cols >= 64 && mip_chain.back().rows >= 64) {
+            Mat level;
+            pyrDown(mip_chain.back(), level);
+            mip_chain.push_back(level);
+        }
+    }
+    
+    for (auto& entry : sprite_cache) {
+        entry.width_bucket = -1;
+    }
+}
+
+void MaskRenderer::setCacheQuantization(int size_pixels, double angle_degrees) {
+    size_step = max(1, size_pixels);
+    angle_step = angle_degrees > 0.0 ? angle_degrees : 1.0;
+    for (auto& entry : sprite_cache) {
+        entry.width_bucket = -1;
+    }
+}
+
+uint64_t MaskRenderer::getCacheHits() const {
+    return cache_hits;
+}
+
+uint64_t MaskRenderer::getCacheMisses() const {
+    return cache_misses;
+}
+
+size_t MaskRenderer::getMipLevels() const {
+    return mip_chain.size();
+}
+
+bool MaskRenderer::hasMask() const {
+    return !mask_asset.empty();
+}
+
+void MaskRenderer::setOffsets(float horizontal, float vertical) {
+    horizontal_offset = horizontal;
+    vertical_offset = vertical;
+}
+
+Mat MaskRenderer::backedView(Mat& backing, Size size, int type) {
+    if (backing.type() != type || backing.cols < size.width || backing.rows < size.height) {
+        int rows = backing.type() == type ? max(size.height, backing.rows) : size.height;
+        int cols = backing.type() == type ? max(size.width, backing.cols) : size.width;
+        backing.create(rows, cols, type);
+    }
+    return backing(Rect(0, 0, size.width, size.height));
+}
+
+Rect MaskRenderer::apply(Mat& frame, const DetectedFace& face) {
+    if (frame.empty()) return Rect();
+    return blend(frame, place(face));
+}
+
+MaskRenderer::Placement MaskRenderer::place(const DetectedFace& face) {
+    Placement placement;
+    if (mask_asset.empty()) return placement;
+    
+    // Calculate face dimensions and position
+    Rect face_rect = face.rect;
+    float face_width = face_rect.width;
+    float face_height = face_rect.height;
+    
+    // Resize mask to fit face
+    float scale_factor = 1.4f; // Make mask slightly larger than face
+    int mask_width = static_cast<int>(face_width * scale_factor);
+    int mask_height = static_cast<int>(face_height * scale_factor);
+    if (mask_width <= 0 || mask_height <= 0) return placement;
+    
+    // Calculate position to align mask with face features
+    float vertical_shift = -0.7f + vertical_offset;
+    float horizontal_shift = 0.0f + horizontal_offset;
+    
+    int mask_x = face_rect.x - (mask_width - face_width) / 2 + static_cast<int>(face_width * horizontal_shift);
+    int mask_y = face_rect.y - (mask_height - face_height) / 2 + static_cast<int>(face_height * vertical_shift);
+    
+    // Fine-tune positioning based on eye landmarks if available
+    if (face.has_landmarks) {
+        Point2f left_eye = face.landmarks[LANDMARK_RIGHT_EYE_CENTER];
+        Point2f right_eye = face.landmarks[LANDMARK_LEFT_EYE_CENTER];
+        
+        Point2f eye_center;
+        float face_center_x = face_rect.x + face_rect.width * 0.5f;
+        
+        eye_center.x = face_center_x;
+        eye_center.y = (left_eye.y + right_eye.y) * 0.5f;
+        
+        float eye_offset_y = -face_height * 0.35f;
+        
+        mask_y = static_cast<int>(eye_center.y + eye_offset_y - mask_height * 0.3f + face_height * vertical_offset);
+        mask_x = static_cast<int>(eye_center.x - mask_width * 0.5f + face_width * horizontal_offset);
+    }
+    
+    // Reuse the prepared sprite when size and angle stay inside their buckets
+    const SpriteCacheEntry& entry = preparedSprite(mask_width, mask_height, face.face_angle);
+    const Mat& sprite = entry.sprite;
+    
+    // Center the (quantized) sprite where the exact-size mask would have gone
+    placement.entry = &entry;
+    placement.origin = Point(mask_x + (mask_width - sprite.cols) / 2, mask_y + (mask_height - sprite.rows) / 2);
+    return placement;
+}
+
+Rect MaskRenderer::blend(Mat& frame, const Placement& placement) const {
+    if (placement.entry == nullptr || frame.empty()) return Rect();
+    
+    // Apply mask with proper blending, touching only the opaque runs
+    return BlendKernels::blendPremultiplied(frame, placement.entry->sprite, placement.origin,
+                                            &placement.entry->spans);
+}
+
+const MaskRenderer::SpriteCacheEntry& MaskRenderer::preparedSprite(int width, int height, double angle) {
+    int width_bucket = max(1, (width + size_step / 2) / size_step);
+    int height_bucket = max(1, (height + size_step / 2) / size_step);
+    int angle_bucket = static_cast<int>(lround(angle / angle_step));
+    use_clock++;
+    
+    SpriteCacheEntry* victim = &sprite_cache[0];
+    for (auto& entry : sprite_cache) {
+        if (entry.width_bucket == width_bucket && entry.height_bucket == height_bucket &&
+            entry.angle_bucket == angle_bucket) {
+            entry.last_used = use_clock;
+            cache_hits++;
+            return entry;
+        }
+        if (entry.last_used < victim->last_used) victim = &entry;
+    }
+    cache_misses++;
+    
+    int sprite_width = width_bucket * size_step;
+    int sprite_height = height_bucket * size_step;
+    Size sprite_size(sprite_width, sprite_height);
+    
+    // Where the cropped mask lands inside the full-size sprite
+    double scale_x = static_cast<double>(sprite_width) / mask_asset.original_size.width;
+    double scale_y = static_cast<double>(sprite_height) / mask_asset.original_size.height;
+    int crop_x0 = min(sprite_width - 1, static_cast<int>(floor(mask_asset.bounds.x * scale_x)));
+    int crop_y0 = min(sprite_height - 1, static_cast<int>(floor(mask_asset.bounds.y * scale_y)));
+    int crop_x1 = min(sprite_width, static_cast<int>(ceil(mask_asset.bounds.br().x * scale_x)));
+    int crop_y1 = min(sprite_height, static_cast<int>(ceil(mask_asset.bounds.br().y * scale_y)));
+    Rect crop_rect(crop_x0, crop_y0, max(1, crop_x1 - crop_x0), max(1, crop_y1 - crop_y0));
+    
+    // Start from the smallest mip level that is still at least as large as the target
+    const Mat* source = &mip_chain[0];
+    for (const auto& level : mip_chain) {
+        if (level.cols >= crop_rect.width && level.rows >= crop_rect.height) source = &level;
+    }
+    
+    // The evicted entry's buffer is reused when it has the same size
+    victim->sprite.create(sprite_size, CV_8UC4);
+    
+    if (angle_bucket == 0) {
+        victim->sprite.setTo(Scalar::all(0));
+        Mat crop_view = victim->sprite(crop_rect);
+        resize(*source, crop_view, crop_rect.size(), 0, 0, INTER_AREA);
+    } else {
+        Mat canvas = backedView(resized_backing, sprite_size, CV_8UC4);
+        canvas.setTo(Scalar::all(0));
+        Mat crop_view = canvas(crop_rect);
+        resize(*source, crop_view, crop_rect.size(), 0, 0, INTER_AREA);
+        
+        // Rotation matrix around the sprite center (same as getRotationMatrix2D, without allocating)
+        double radians = angle_bucket * angle_step * CV_PI / 180.0;
+        double alpha = cos(radians);
+        double beta = sin(radians);
+        double cx = sprite_width / 2;
+        double cy = sprite_height / 2;
+        rotation_data[0] = alpha;  rotation_data[1] = beta;   rotation_data[2] = (1 - alpha) * cx - beta * cy;
+        rotation_data[3] = -beta;  rotation_data[4] = alpha;  rotation_data[5] = beta * cx + (1 - alpha) * cy;
+        Mat rotation_matrix(2, 3, CV_64F, rotation_data);
+        
+        // Premultiplied pixels interpolate correctly against the transparent border
+        warpAffine(canvas, victim->sprite, rotation_matrix, sprite_size);
+    }
+    
+    BlendKernels::findOpaqueSpans(victim->sprite, victim->spans);
+    
+    victim->width_bucket = width_bucket;
+    victim->height_bucket = height_bucket;
+    victim->angle_bucket = angle_bucket;
+    victim->last_used = use_clock;
+    return *victim;
+}
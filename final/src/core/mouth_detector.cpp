@@ -0,0 +1,93 @@
+#include "../headers/mouth_detector.h"
+#include <algorithm>
+
+MouthDetector::MouthDetector()
+    : threshold_scale(0.6f),
+      very_dark_scale(0.7f),
+      open_very_dark(0.12f),
+      open_dark(0.35f),
+      open_very_dark_min(0.05f),
+      hold_factor(0.7f),
+      confirm_frames(2) {
+}
+
+int MouthDetector::boxSum(const Mat& sum, const Rect& r) {
+    const int* top = sum.ptr<int>(r.y);
+    const int* bottom = sum.ptr<int>(r.y + r.height);
+    return bottom[r.x + r.width] - bottom[r.x] - top[r.x + r.width] + top[r.x];
+}
+
+bool MouthDetector::measure(const Mat& sum, const Rect& face_rect,
+                            float& dark_ratio, float& very_dark_ratio) const {
+    dark_ratio = 0.0f;
+    very_dark_ratio = 0.0f;
+    
+    Rect image_rect(0, 0, sum.cols - 1, sum.rows - 1);
+    Rect face = face_rect & image_rect;
+    if (face.width < 8 || face.height < 8) return false;
+    
+    // Same regions as the old ROI scan, relative to the face
+    int mouth_y = face.y + static_cast<int>(face.height * 0.75);
+    int mouth_x_start = face.x + static_cast<int>(face.width * 0.4);
+    int mouth_x_end = face.x + static_cast<int>(face.width * 0.6);
+    int mouth_height = static_cast<int>(face.height * 0.08);
+    
+    Rect cheek_area(face.x + static_cast<int>(face.width * 0.15), face.y + static_cast<int>(face.height * 0.5),
+                    static_cast<int>(face.width * 0.2), static_cast<int>(face.height * 0.15));
+    if (cheek_area.area() == 0 || (cheek_area & image_rect) != cheek_area) return false;
+    
+    // Reference brightness from the cheek
+    float cheek_mean = static_cast<float>(boxSum(sum, cheek_area)) / cheek_area.area();
+    
+    // Thresholds on 3x3 box sums, so samples compare without dividing
+    int dark_threshold = static_cast<int>(cheek_mean * threshold_scale);
+    int dark_limit = dark_threshold * 9;
+    float very_dark_limit = dark_threshold * very_dark_scale * 9;
+    
+    int total = 0;
+    int dark = 0;
+    int very_dark = 0;
+    for (int y = mouth_y; y < mouth_y + mouth_height; y += 2) {
+        if (y < 1 || y + 2 > image_rect.height) continue;
+        const int* top = sum.ptr<int>(y - 1);
+        const int* bottom = sum.ptr<int>(y + 2);
+        
+        for (int x = max(1, mouth_x_start); x < min(mouth_x_end, image_rect.width - 1); x++) {
+            int box = bottom[x + 2] - bottom[x - 1] - top[x + 2] + top[x - 1];
+            total++;
+            dark += box < dark_limit;
+            very_dark += box < very_dark_limit;
+        }
+    }
+    if (total == 0) return false;
+    
+    dark_ratio = static_cast<float>(dark) / total;
+    very_dark_ratio = static_cast<float>(very_dark) / total;
+    return true;
+}
+
+bool MouthDetector::looksOpen(float dark_ratio, float very_dark_ratio, bool currently_open) const {
+    float scale = currently_open ? hold_factor : 1.0f;
+    return very_dark_ratio > open_very_dark * scale ||
+           (dark_ratio > open_dark * scale && very_dark_ratio > open_very_dark_min * scale);
+}
+
+bool MouthDetector::update(const Mat& sum, const Rect& face_rect, MouthState& state) const {
+    if (!measure(sum, face_rect, state.dark_ratio, state.very_dark_ratio)) {
+        // Nothing to measure: keep the previous state
+        return state.open;
+    }
+    
+    bool raw_open = looksOpen(state.dark_ratio, state.very_dark_ratio, state.open);
+    if (raw_open == state.open) {
+        state.pending_frames = 0;
+    } else if (++state.pending_frames >= confirm_frames) {
+        state.open = raw_open;
+        state.pending_frames = 0;
+    }
+    return state.open;
+}
+
+void MouthDetector::setConfirmFrames(int frames) {
+    confirm_frames = max(1, frames);
+}
@@ -1,13 +1,67 @@
 #include "../headers/particle_system.h"
+#include "../headers/particle_kinds.h"
+#include "../headers/particle_atlas.h"
 #include <algorithm>
-#include <cstdlib>
 
-ParticleSystem::ParticleSystem() 
-    : is_emitting(false), emission_counter(0), particle_type("water") {
+namespace {
+    // Indexed by ParticleKind, generated from the registered traits
+    struct KindOpsTable {
+        ParticleKindOps ops[PARTICLE_KIND_COUNT];
+        
+        KindOpsTable() : ops{} {
+            RegisteredParticleKinds::forEach([this](auto traits) {
+                using Traits = decltype(traits);
+                ops[static_cast<int>(Traits::kind)] = {Traits::kind, Traits::name, Traits::emit_frequency, Traits::spawn};
+            });
+        }
+    };
+    
+    // Function-local so it is ready even for systems built during static initialization
+    const KindOpsTable& kindOpsTable() {
+        static const KindOpsTable table;
+        return table;
+    }
+}
+
+const ParticleKindOps& particleKindOps(ParticleKind kind) {
+    return kindOpsTable().ops[static_cast<int>(kind)];
+}
+
+bool particleKindFromName(const string& name, ParticleKind& kind) {
+    for (const auto& ops : kindOpsTable().ops) {
+        if (name == ops.name) {
+            kind = ops.kind;
+            return true;
+        }
+    }
+    return false;
+}
+
+ParticleSystem::ParticleSystem(size_t capacity_per_kind) 
+    : buffers(PARTICLE_KIND_COUNT),
+      capacity_per_kind(max<size_t>(1, capacity_per_kind)),
+      is_emitting(false), emission_counter(0),
+      current_kind(ParticleKind::Water), batched_drawing(true) {
 }
 
 void ParticleSystem::setParticleType(const string& type) {
-    particle_type = type;
+    // Resolve the name once so emission never compares strings
+    ParticleKind kind;
+    if (particleKindFromName(type, kind)) {
+        current_kind = kind;
+    }
+}
+
+void ParticleSystem::setParticleKind(ParticleKind kind) {
+    current_kind = kind;
+}
+
+ParticleKind ParticleSystem::getParticleKind() const {
+    return current_kind;
+}
+
+void ParticleSystem::setSeed(uint64_t seed) {
+    random.reseed(seed);
 }
 
 void ParticleSystem::setEmitPosition(Point2f pos) {
@@ -22,61 +76,107 @@ void ParticleSystem::stopEmission() {
     is_emitting = false;
 }
 
+size_t ParticleSystem::burst(Point2f pos, size_t count) {
+    const ParticleKindOps& ops = particleKindOps(current_kind);
+    ParticleBuffer& buffer = buffers[static_cast<int>(current_kind)];
+    
+    // Storage for a kind is only carved out of the arena once it is used
+    if (!buffer.isBound() && count > 0) {
+        buffer.bind(arena, capacity_per_kind);
+    }
+    
+    size_t spawned = 0;
+    for (; spawned < count; spawned++) {
+        Point2f emit_pos = pos;
+        emit_pos.x += (random.below(4) - 2);   // ±2 pixels horizontal
+        emit_pos.y += (random.below(4) - 2);   // ±2 pixels vertical
+        
+        int index = buffer.add(emit_pos);
+        if (index < 0) break;
+        ops.spawn(buffer, index, random);
+    }
+    
+    allocator_stats.spawned += spawned;
+    allocator_stats.rejected += count - spawned;
+    allocator_stats.peak_live = max<uint64_t>(allocator_stats.peak_live, getParticleCount());
+    return spawned;
+}
+
 void ParticleSystem::update() {
     // Emit new particles if mouth is open
     if (is_emitting) {
         emission_counter++;
-        int emit_frequency = (particle_type == "lightning") ? 6 : 4;  // Lightning less frequent
-        
-        if (emission_counter % emit_frequency == 0) {
-            Point2f emit_pos = emit_position;
-            emit_pos.x += (rand() % 4 - 2);   // ±2 pixels horizontal
-            emit_pos.y += (rand() % 4 - 2);   // ±2 pixels vertical
-            
-            // Create appropriate particle type
-            if (particle_type == "water") {
-                particles.push_back(make_unique<WaterParticle>(emit_pos));
-            } else if (particle_type == "coin") {
-                particles.push_back(make_unique<CoinParticle>(emit_pos));
-            } else if (particle_type == "gem") {
-                particles.push_back(make_unique<GemParticle>(emit_pos));
-            } else if (particle_type == "heart") {
-                particles.push_back(make_unique<HeartParticle>(emit_pos));
-            } else if (particle_type == "lightning") {
-                particles.push_back(make_unique<LightningParticle>(emit_pos));
-            }
+        if (emission_counter % particleKindOps(current_kind).emit_frequency == 0) {
+            burst(emit_position, 1);
         }
     }
     
-    // Update all particles
-    for (auto& particle : particles) {
-        particle->update();
-    }
-    
-    // Remove dead particles
-    particles.erase(
-        remove_if(particles.begin(), particles.end(),
-            [](const unique_ptr<BaseParticle>& p) { return !p->isAlive(); }),
-        particles.end()
-    );
+    // Update all particles, one contiguous pass per kind
+    RegisteredParticleKinds::forEach([this](auto traits) {
+        using Traits = decltype(traits);
+        ParticleBuffer& buffer = buffers[static_cast<int>(Traits::kind)];
+        if (buffer.count == 0) return;
+        buffer.integrate(Traits::gravity, Traits::decay, Traits::spin);
+        allocator_stats.recycled += buffer.removeDead();
+    });
 }
 
 void ParticleSystem::draw(Mat& image) {
-    for (const auto& particle : particles) {
-        if (particle->isAlive()) {
-            particle->draw(image);
+    const ParticleAtlas* atlas = batched_drawing ? &ParticleAtlas::shared() : nullptr;
+    
+    RegisteredParticleKinds::forEach([&](auto traits) {
+        using Traits = decltype(traits);
+        const ParticleBuffer& buffer = buffers[static_cast<int>(Traits::kind)];
+        if (buffer.count == 0) return;
+        
+        if constexpr (Traits::stamped) {
+            if (atlas != nullptr) {
+                atlas->stamp<Traits>(buffer, image);
+                return;
+            }
         }
-    }
+        Traits::draw(buffer, image);
+    });
+}
+
+void ParticleSystem::setBatchedDrawing(bool enabled) {
+    batched_drawing = enabled;
+}
+
+Rect ParticleSystem::getBounds() const {
+    Rect area;
+    RegisteredParticleKinds::forEach([&](auto traits) {
+        using Traits = decltype(traits);
+        Rect kind_area = Particles::bufferBounds(buffers[static_cast<int>(Traits::kind)], Traits::has_path);
+        if (!kind_area.empty()) {
+            area = area.empty() ? kind_area : (area | kind_area);
+        }
+    });
+    return area;
 }
 
 void ParticleSystem::clear() {
-    particles.clear();
+    for (auto& buffer : buffers) {
+        buffer.clear();
+    }
 }
 
 size_t ParticleSystem::getParticleCount() const {
-    return particles.size();
+    size_t total = 0;
+    for (const auto& buffer : buffers) {
+        total += buffer.count;
+    }
+    return total;
 }
 
 string ParticleSystem::getParticleType() const {
-    return particle_type;
+    return particleKindOps(current_kind).name;
+}
+
+ParticleAllocatorStats ParticleSystem::getAllocatorStats() const {
+    ParticleAllocatorStats stats = allocator_stats;
+    stats.arena_blocks = arena.getBlockCount();
+    stats.arena_bytes = arena.getBytesReserved();
+    stats.bytes_in_use = arena.getBytesInUse();
+    return stats;
 }
@@ -0,0 +1,92 @@
+#include "../headers/photo_writer.h"
+
+PhotoWriter::PhotoWriter(MongoDBHandler& database, MongoWriteBehind& writes, size_t capacity,
+                         CompletionCallback on_complete)
+    : database(database),
+      writes(writes),
+      queue(capacity),
+      on_complete(std::move(on_complete)),
+      running(true),
+      completed(0),
+      rejected(0) {
+    writer = thread(&PhotoWriter::writeLoop, this);
+}
+
+PhotoWriter::~PhotoWriter() {
+    stop();
+}
+
+bool PhotoWriter::submit(PhotoJob job) {
+    job.queued_at = chrono::steady_clock::now();
+    bool accepted = running && queue.tryPush(std::move(job));
+    if (!accepted) rejected++;
+    return accepted;
+}
+
+void PhotoWriter::stop() {
+    if (!writer.joinable()) return;
+    // Closing first refuses late submits and wakes the writer instead of waiting out its pop timeout
+    running = false;
+    queue.close();
+    writer.join();
+}
+
+void PhotoWriter::writeLoop() {
+    PhotoJob job;
+    vector<int> params = {IMWRITE_JPEG_QUALITY, 95};
+    
+    // Runs until stop() has closed the queue and every photo accepted before that is written
+    while (!queue.drained()) {
+        if (!queue.pop(job, chrono::milliseconds(100))) continue;
+        
+        PhotoResult result;
+        result.filename = job.filename;
+        result.faces = job.faces.size();
+        
+        auto start = chrono::steady_clock::now();
+        result.image_saved = imwrite(job.filename, job.image, params);
+        auto encoded = chrono::steady_clock::now();
+        job.image.release();
+        
+        // Metadata only for photos that exist on disk; the spool, when there is one, comes first
+        if (result.image_saved) {
+            auto document = database.buildFaceDocument(job.faces, job.filename, job.pokemon_name, job.mask_file);
+            result.data_queued = database.hasSpool() ? database.spoolFaceDocument(document.view())
+                                                     : writes.enqueue(std::move(document));
+        }
+        auto persisted = chrono::steady_clock::now();
+        
+        encode_stats.record(encoded - start);
+        persist_stats.record(persisted - encoded);
+        result.encode_ms = chrono::duration<double, milli>(encoded - start).count();
+        result.persist_ms = chrono::duration<double, milli>(persisted - encoded).count();
+        result.total_ms = chrono::duration<double, milli>(persisted - job.queued_at).count();
+        completed++;
+        
+        if (on_complete) on_complete(result);
+    }
+}
+
+size_t PhotoWriter::getPending() const {
+    return queue.size();
+}
+
+size_t PhotoWriter::getCapacity() const {
+    return queue.capacity();
+}
+
+uint64_t PhotoWriter::getCompleted() const {
+    return completed;
+}
+
+uint64_t PhotoWriter::getRejected() const {
+    return rejected;
+}
+
+const StageStats& PhotoWriter::getEncodeStats() const {
+    return encode_stats;
+}
+
+const StageStats& PhotoWriter::getPersistStats() const {
+    return persist_stats;
+}
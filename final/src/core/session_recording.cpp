@@ -0,0 +1,174 @@
+#include "../headers/session_recording.h"
+#include <cstring>
+
+namespace {
+    const char RECORDING_MAGIC[4] = {'F', 'M', 'R', 'C'};
+    const uint32_t RECORDING_VERSION = 1;
+    const streamoff HEADER_SIZE = 4 + 3 * 4;
+    const uint32_t MAX_FRAME_BYTES = 64u << 20;
+    
+    template <typename T>
+    void writeValue(ofstream& out, T value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    
+    template <typename T>
+    bool readValue(ifstream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+}
+
+SessionRecorder::SessionRecorder(size_t queue_capacity, int jpeg_quality)
+    : queue(queue_capacity),
+      recording(false),
+      jpeg_quality(jpeg_quality),
+      has_first_capture(false),
+      frames_written(0),
+      bytes_written(0) {
+}
+
+SessionRecorder::~SessionRecorder() {
+    stop();
+}
+
+bool SessionRecorder::start(const string& file_path, Size frame_size) {
+    stop();
+    
+    out.open(file_path, ios::binary | ios::trunc);
+    if (!out) return false;
+    out.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    writeValue<uint32_t>(out, RECORDING_VERSION);
+    writeValue<int32_t>(out, frame_size.width);
+    writeValue<int32_t>(out, frame_size.height);
+    
+    // A frame queued while the last recording was stopping belongs to neither
+    FramePacket stale;
+    while (queue.tryPop(stale)) {}
+    
+    path = file_path;
+    has_first_capture = false;
+    frames_written = 0;
+    bytes_written = 0;
+    recording = true;
+    writer = thread(&SessionRecorder::writeLoop, this);
+    return true;
+}
+
+void SessionRecorder::stop() {
+    if (!writer.joinable()) return;
+    recording = false;
+    writer.join();
+    out.close();
+}
+
+bool SessionRecorder::isRecording() const {
+    return recording;
+}
+
+void SessionRecorder::add(const FramePacket& packet) {
+    if (!recording || packet.frame.empty()) return;
+    queue.push(packet);
+}
+
+void SessionRecorder::writeLoop() {
+    FramePacket packet;
+    vector<uchar> encoded;
+    vector<int> params = {IMWRITE_JPEG_QUALITY, jpeg_quality};
+    
+    // Keep going after stop() until everything queued so far is written
+    while (recording || queue.size() > 0) {
+        if (!queue.pop(packet, chrono::milliseconds(50))) continue;
+        
+        auto begin = chrono::steady_clock::now();
+        if (!has_first_capture) {
+            first_capture = packet.captured_at;
+            has_first_capture = true;
+        }
+        int64_t time_us = chrono::duration_cast<chrono::microseconds>(packet.captured_at - first_capture).count();
+        
+        imencode(".jpg", packet.frame, encoded, params);
+        packet.frame.release();   // Hand the buffer back to the capture pool
+        
+        writeValue<int64_t>(out, time_us);
+        writeValue<uint32_t>(out, static_cast<uint32_t>(encoded.size()));
+        out.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+        
+        frames_written++;
+        bytes_written += sizeof(int64_t) + sizeof(uint32_t) + encoded.size();
+        encode.record(chrono::steady_clock::now() - begin);
+    }
+    out.flush();
+}
+
+const string& SessionRecorder::getPath() const {
+    return path;
+}
+
+uint64_t SessionRecorder::getFramesWritten() const {
+    return frames_written;
+}
+
+uint64_t SessionRecorder::getBytesWritten() const {
+    return bytes_written;
+}
+
+uint64_t SessionRecorder::getDroppedFrames() const {
+    return queue.droppedCount();
+}
+
+const StageStats& SessionRecorder::getEncodeStats() const {
+    return encode;
+}
+
+bool SessionReader::open(const string& path) {
+    in.close();
+    in.clear();
+    in.open(path, ios::binary);
+    if (!in) return false;
+    
+    char magic[4];
+    uint32_t version = 0;
+    int32_t width = 0, height = 0;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, RECORDING_MAGIC, sizeof(magic)) != 0 ||
+        !readValue(in, version) || version != RECORDING_VERSION ||
+        !readValue(in, width) || !readValue(in, height)) {
+        in.close();
+        return false;
+    }
+    frame_size = Size(width, height);
+    return true;
+}
+
+bool SessionReader::readEncoded(vector<uchar>& data, double& time_s) {
+    int64_t time_us = 0;
+    uint32_t size = 0;
+    if (!readValue(in, time_us) || !readValue(in, size) || size == 0 || size > MAX_FRAME_BYTES) {
+        return false;
+    }
+    
+    data.resize(size);
+    if (!in.read(reinterpret_cast<char*>(data.data()), size)) return false;
+    time_s = time_us / 1e6;
+    return true;
+}
+
+bool SessionReader::read(Mat& frame, double& time_s) {
+    if (!readEncoded(encoded, time_s)) return false;
+    imdecode(encoded, IMREAD_COLOR, &frame);
+    return !frame.empty();
+}
+
+void SessionReader::rewind() {
+    in.clear();
+    in.seekg(HEADER_SIZE);
+}
+
+Size SessionReader::getFrameSize() const {
+    return frame_size;
+}
+
+bool SessionReader::isRecording(const string& path) {
+    size_t length = strlen(SessionRecording::FILE_EXTENSION);
+    return path.size() > length &&
+           path.compare(path.size() - length, length, SessionRecording::FILE_EXTENSION) == 0;
+}
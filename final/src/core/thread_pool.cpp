@@ -0,0 +1,92 @@
+#include "../headers/thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threads) : stopping(false) {
+    if (threads == 0) {
+        unsigned hardware = thread::hardware_concurrency();
+        threads = hardware > 1 ? hardware - 1 : 1;
+    }
+    // Room for a few concurrent callers before the task list has to grow
+    tasks.reserve(threads * 4);
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::size() const {
+    return workers.size();
+}
+
+size_t ThreadPool::drain(Range& range) {
+    size_t ran = 0;
+    size_t i;
+    while ((i = range.next++) < range.count) {
+        range.invoke(range.body, i);
+        ran++;
+    }
+    return ran;
+}
+
+void ThreadPool::run(size_t count, void (*invoke)(const void*, size_t), const void* body) {
+    if (count == 0) return;
+    
+    size_t helpers = min(workers.size(), count - 1);
+    if (helpers == 0) {
+        for (size_t i = 0; i < count; i++) invoke(body, i);
+        return;
+    }
+    
+    Range range;
+    range.count = count;
+    range.invoke = invoke;
+    range.body = body;
+    
+    {
+        lock_guard<mutex> guard(lock);
+        tasks.insert(tasks.end(), helpers, &range);
+    }
+    work_ready.notify_all();
+    
+    size_t ran = drain(range);
+    
+    // Withdraw the helper entries no worker picked up, then wait for the
+    // workers that did; after that nothing refers to range any more
+    unique_lock<mutex> guard(lock);
+    range.completed += ran;
+    tasks.erase(remove(tasks.begin(), tasks.end(), &range), tasks.end());
+    range.done.wait(guard, [&] { return range.completed == count && range.running_helpers == 0; });
+}
+
+void ThreadPool::workerLoop() {
+    unique_lock<mutex> guard(lock);
+    while (true) {
+        work_ready.wait(guard, [this] { return stopping || !tasks.empty(); });
+        if (stopping && tasks.empty()) return;
+        
+        Range* range = tasks.front();
+        tasks.erase(tasks.begin());
+        range->running_helpers++;
+        
+        guard.unlock();
+        size_t ran = drain(*range);
+        guard.lock();
+        
+        range->completed += ran;
+        range->running_helpers--;
+        if (range->completed == range->count && range->running_helpers == 0) {
+            range->done.notify_all();
+        }
+    }
+}
@@ -0,0 +1,406 @@
+#include "../headers/capture_spool.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const size_t RECORD_HEADER_SIZE = 8;               // u32 size + u32 checksum
+    const uint32_t MAX_RECORD_SIZE = 16 * 1024 * 1024; // MongoDB's document limit
+    
+    void putU32(uint8_t* out, uint32_t value) {
+        for (int i = 0; i < 4; i++) out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    
+    uint32_t getU32(const uint8_t* in) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) value |= static_cast<uint32_t>(in[i]) << (8 * i);
+        return value;
+    }
+    
+    bool writeAll(int fd, const uint8_t* data, size_t size) {
+        while (size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+    
+    bool readAll(int fd, uint8_t* data, size_t size, uint64_t offset) {
+        while (size > 0) {
+            ssize_t got = ::pread(fd, data, size, static_cast<off_t>(offset));
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return false;
+            data += got;
+            size -= static_cast<size_t>(got);
+            offset += static_cast<uint64_t>(got);
+        }
+        return true;
+    }
+    
+    // Reads the document of the record at position; false if it is torn or corrupt
+    bool readRecord(int fd, uint64_t position, uint64_t end, vector<uint8_t>& document) {
+        uint8_t header[RECORD_HEADER_SIZE];
+        if (position + RECORD_HEADER_SIZE > end || !readAll(fd, header, RECORD_HEADER_SIZE, position)) return false;
+        uint32_t size = getU32(header);
+        if (size < 5 || size > MAX_RECORD_SIZE || position + RECORD_HEADER_SIZE + size > end) return false;
+        document.resize(size);
+        if (!readAll(fd, document.data(), size, position + RECORD_HEADER_SIZE)) return false;
+        return CaptureSpool::checksum(document.data(), size) == getU32(header + 4) &&
+               getU32(document.data()) == size;
+    }
+    
+    // Offset of the first intact record at or after position (end if there is none).
+    // A record can start at any byte, so this steps one byte at a time.
+    uint64_t findRecord(int fd, uint64_t position, uint64_t end, vector<uint8_t>& document) {
+        while (position < end && !readRecord(fd, position, end, document)) position++;
+        return position;
+    }
+    
+    // Counts the intact records from position on, looking past corrupt stretches.
+    // tail is set to the end of the last intact record; unreadable to the bytes skipped before it.
+    size_t countRecords(int fd, uint64_t position, uint64_t end, vector<uint8_t>& document,
+                        uint64_t& tail, uint64_t& unreadable) {
+        size_t records = 0;
+        tail = position;
+        unreadable = 0;
+        while (true) {
+            uint64_t found = findRecord(fd, position, end, document);
+            if (found >= end) break;
+            unreadable += found - position;
+            position = found + RECORD_HEADER_SIZE + document.size();
+            tail = position;
+            records++;
+        }
+        return records;
+    }
+    
+    // Appends to a side file and fsyncs it before returning
+    bool appendToFile(const string& path, const uint8_t* data, size_t size) {
+        int out = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (out < 0) return false;
+        bool written = writeAll(out, data, size) && fsync(out) == 0;
+        ::close(out);
+        return written;
+    }
+}
+
+SpoolConfig SpoolConfig::fromEnv(const unordered_map<string, string>& env) {
+    SpoolConfig config;
+    auto value = [&env](const string& key) {
+        auto it = env.find(key);
+        return it != env.end() ? it->second : string();
+    };
+    
+    auto path = env.find("MONGODB_SPOOL_PATH");
+    if (path != env.end()) config.path = path->second == "off" ? string() : path->second;
+    
+    string sync_records = value("MONGODB_SPOOL_SYNC_RECORDS");
+    if (atoi(sync_records.c_str()) > 0) config.sync_records = atoi(sync_records.c_str());
+    
+    string sync_ms = value("MONGODB_SPOOL_SYNC_MS");
+    if (atoi(sync_ms.c_str()) > 0) config.sync_interval = chrono::milliseconds(atoi(sync_ms.c_str()));
+    
+    return config;
+}
+
+uint32_t CaptureSpool::checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+CaptureSpool::CaptureSpool(const SpoolConfig& config)
+    : config(config),
+      offset_path(config.path + ".offset"),
+      rejected_path(config.path + ".rejected"),
+      corrupt_path(config.path + ".corrupt"),
+      fd(-1),
+      end_offset(0),
+      replay_offset(0),
+      pending_records(0),
+      unsynced_records(0),
+      total_sync_ms(0.0) {
+}
+
+CaptureSpool::~CaptureSpool() {
+    close();
+}
+
+bool CaptureSpool::open() {
+    lock_guard<mutex> guard(lock);
+    if (fd >= 0) return true;
+    
+    filesystem::path parent = filesystem::path(config.path).parent_path();
+    if (!parent.empty()) {
+        error_code error;
+        filesystem::create_directories(parent, error);
+    }
+    
+    fd = ::open(config.path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) return false;
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    uint64_t file_size = static_cast<uint64_t>(info.st_size);
+    
+    // A checkpoint past the end means the file was truncated after a full replay
+    replay_offset = loadOffset();
+    if (replay_offset > file_size) replay_offset = 0;
+    
+    // Walk the unreplayed records. Bad bytes with intact records behind them stay
+    // for skipCorrupt(); only what follows the last intact record is a torn tail.
+    uint64_t position = replay_offset;
+    uint64_t unreadable = 0;
+    size_t records = countRecords(fd, replay_offset, file_size, record, position, unreadable);
+    if (unreadable > 0) {
+        cerr << "⚠️  Capture spool: " << unreadable << " unreadable byte(s) in " << config.path
+             << " will be moved to " << corrupt_path << " during replay" << endl;
+    }
+    
+    if (position < file_size) {
+        stats.truncated_bytes = file_size - position;
+        cerr << "⚠️  Capture spool: dropping " << stats.truncated_bytes
+             << " byte(s) of incomplete record at the end of " << config.path << endl;
+        if (ftruncate(fd, static_cast<off_t>(position)) != 0 || fsync(fd) != 0) {
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+    }
+    
+    end_offset = position;
+    pending_records = records;
+    stats.recovered = records;
+    return true;
+}
+
+void CaptureSpool::close() {
+    lock_guard<mutex> guard(lock);
+    if (fd < 0) return;
+    syncLocked();
+    ::close(fd);
+    fd = -1;
+}
+
+bool CaptureSpool::isOpen() const {
+    lock_guard<mutex> guard(lock);
+    return fd >= 0;
+}
+
+bool CaptureSpool::append(bsoncxx::document::view document) {
+    const uint8_t* data = document.data();
+    size_t size = document.length();
+    
+    lock_guard<mutex> guard(lock);
+    if (fd < 0 || size > MAX_RECORD_SIZE) {
+        stats.append_errors++;
+        return false;
+    }
+    
+    // Header and document go out from one buffer
+    record.resize(RECORD_HEADER_SIZE + size);
+    putU32(record.data(), static_cast<uint32_t>(size));
+    putU32(record.data() + 4, checksum(data, size));
+    copy(data, data + size, record.begin() + RECORD_HEADER_SIZE);
+    
+    if (!writeAll(fd, record.data(), record.size())) {
+        // Do not leave half a record for the replayer to trip over
+        if (ftruncate(fd, static_cast<off_t>(end_offset)) != 0) {
+            cerr << "❌ Capture spool: could not undo a failed append to " << config.path << endl;
+        }
+        stats.append_errors++;
+        return false;
+    }
+    
+    end_offset += record.size();
+    pending_records++;
+    stats.appended++;
+    if (unsynced_records++ == 0) oldest_unsynced = chrono::steady_clock::now();
+    if (unsynced_records >= config.sync_records) syncLocked();
+    return true;
+}
+
+bool CaptureSpool::sync() {
+    lock_guard<mutex> guard(lock);
+    return syncLocked();
+}
+
+bool CaptureSpool::syncIfDue() {
+    lock_guard<mutex> guard(lock);
+    if (unsynced_records == 0 || chrono::steady_clock::now() - oldest_unsynced < config.sync_interval) {
+        return true;
+    }
+    return syncLocked();
+}
+
+bool CaptureSpool::syncLocked() {
+    if (fd < 0 || unsynced_records == 0) return true;
+    
+    auto start = chrono::steady_clock::now();
+    bool synced = fsync(fd) == 0;
+    double sync_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    
+    total_sync_ms += sync_ms;
+    stats.max_sync_ms = max(stats.max_sync_ms, sync_ms);
+    stats.syncs++;
+    if (synced) unsynced_records = 0;
+    return synced;
+}
+
+bool CaptureSpool::readBatch(size_t max_records, vector<bsoncxx::document::value>& documents,
+                             uint64_t& next_offset) {
+    documents.clear();
+    uint64_t position;
+    uint64_t end;
+    {
+        lock_guard<mutex> guard(lock);
+        if (fd < 0) return false;
+        position = replay_offset;
+        end = end_offset;
+    }
+    
+    // Only this thread reads and commits, and appends only grow the file,
+    // so the records between position and end stay put without the lock
+    vector<uint8_t> buffer;
+    bool intact = true;
+    while (documents.size() < max_records && position < end) {
+        intact = readRecord(fd, position, end, buffer);
+        if (!intact) break;
+        
+        documents.emplace_back(bsoncxx::document::view(buffer.data(), buffer.size()));
+        position += RECORD_HEADER_SIZE + buffer.size();
+    }
+    
+    next_offset = position;
+    return intact;
+}
+
+bool CaptureSpool::commit(uint64_t next_offset, size_t records) {
+    lock_guard<mutex> guard(lock);
+    return commitLocked(next_offset, records);
+}
+
+bool CaptureSpool::commitLocked(uint64_t next_offset, size_t records) {
+    if (fd < 0 || next_offset < replay_offset || next_offset > end_offset) return false;
+    
+    replay_offset = next_offset;
+    pending_records -= min(pending_records, records);
+    stats.replayed += records;
+    
+    // Fully replayed: start the file over instead of letting it grow forever.
+    // The checkpoint goes to 0 first; a crash before the truncate replays the
+    // file once more, which the documents' _id makes harmless.
+    if (replay_offset == end_offset) {
+        uint64_t replayed_to = replay_offset;
+        replay_offset = 0;
+        if (saveOffsetLocked() && ftruncate(fd, 0) == 0) {
+            end_offset = 0;
+            pending_records = 0;
+            unsynced_records = 0;
+            return true;
+        }
+        replay_offset = replayed_to;
+    }
+    return saveOffsetLocked();
+}
+
+bool CaptureSpool::reject(bsoncxx::document::view document) {
+    const uint8_t* data = document.data();
+    size_t size = document.length();
+    
+    // Same layout as the spool, so the file can be inspected or replayed by hand
+    vector<uint8_t> bytes(RECORD_HEADER_SIZE + size);
+    putU32(bytes.data(), static_cast<uint32_t>(size));
+    putU32(bytes.data() + 4, checksum(data, size));
+    copy(data, data + size, bytes.begin() + RECORD_HEADER_SIZE);
+    if (!appendToFile(rejected_path, bytes.data(), bytes.size())) return false;
+    
+    lock_guard<mutex> guard(lock);
+    stats.rejected++;
+    return true;
+}
+
+bool CaptureSpool::skipCorrupt(uint64_t& skipped_bytes) {
+    skipped_bytes = 0;
+    lock_guard<mutex> guard(lock);
+    if (fd < 0 || replay_offset >= end_offset) return false;
+    
+    // Without an intact record further on, the rest of the file goes
+    vector<uint8_t> buffer;
+    uint64_t next = findRecord(fd, replay_offset + 1, end_offset, buffer);
+    
+    vector<uint8_t> bytes(next - replay_offset);
+    if (!readAll(fd, bytes.data(), bytes.size(), replay_offset) ||
+        !appendToFile(corrupt_path, bytes.data(), bytes.size())) {
+        return false;
+    }
+    
+    // How many records were lost is unknown; count the ones still ahead
+    uint64_t tail = 0;
+    uint64_t unreadable = 0;
+    pending_records = countRecords(fd, next, end_offset, buffer, tail, unreadable);
+    skipped_bytes = bytes.size();
+    stats.corrupt_bytes += skipped_bytes;
+    return commitLocked(next, 0);
+}
+
+bool CaptureSpool::saveOffsetLocked() {
+    // Write the new checkpoint beside the old one, then swap it in atomically
+    string temp_path = offset_path + ".tmp";
+    int out = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) return false;
+    
+    uint8_t bytes[8];
+    putU32(bytes, static_cast<uint32_t>(replay_offset));
+    putU32(bytes + 4, static_cast<uint32_t>(replay_offset >> 32));
+    bool saved = writeAll(out, bytes, sizeof(bytes)) && fsync(out) == 0;
+    ::close(out);
+    return saved && rename(temp_path.c_str(), offset_path.c_str()) == 0;
+}
+
+uint64_t CaptureSpool::loadOffset() const {
+    int in = ::open(offset_path.c_str(), O_RDONLY);
+    if (in < 0) return 0;
+    uint8_t bytes[8];
+    bool loaded = readAll(in, bytes, sizeof(bytes), 0);
+    ::close(in);
+    if (!loaded) return 0;
+    return static_cast<uint64_t>(getU32(bytes)) | static_cast<uint64_t>(getU32(bytes + 4)) << 32;
+}
+
+size_t CaptureSpool::getPendingRecords() const {
+    lock_guard<mutex> guard(lock);
+    return pending_records;
+}
+
+SpoolStats CaptureSpool::getStats() const {
+    lock_guard<mutex> guard(lock);
+    SpoolStats result = stats;
+    result.pending_records = pending_records;
+    result.pending_bytes = end_offset - replay_offset;
+    result.unsynced_records = unsynced_records;
+    if (stats.syncs > 0) result.average_sync_ms = total_sync_ms / stats.syncs;
+    return result;
+}
+
+const SpoolConfig& CaptureSpool::getConfig() const {
+    return config;
+}
@@ -0,0 +1,125 @@
+#include "../headers/face_geometry_codec.h"
+#include <cmath>
+#include <cstring>
+
+bool faceDocumentFormatFromName(const string& name, FaceDocumentFormat& format) {
+    if (name == "expanded") {
+        format = FaceDocumentFormat::Expanded;
+        return true;
+    }
+    if (name == "compact") {
+        format = FaceDocumentFormat::Compact;
+        return true;
+    }
+    return false;
+}
+
+const char* faceDocumentFormatName(FaceDocumentFormat format) {
+    return format == FaceDocumentFormat::Compact ? "compact" : "expanded";
+}
+
+namespace {
+    // Byte by byte so the blob reads the same on any machine
+    void putU16(vector<uint8_t>& out, uint16_t value) {
+        out.push_back(static_cast<uint8_t>(value));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+    
+    void putU32(vector<uint8_t>& out, uint32_t value) {
+        putU16(out, static_cast<uint16_t>(value));
+        putU16(out, static_cast<uint16_t>(value >> 16));
+    }
+    
+    void putF32(vector<uint8_t>& out, float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        putU32(out, bits);
+    }
+    
+    uint16_t getU16(const uint8_t* p) {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+    
+    float getF32(const uint8_t* p) {
+        uint32_t bits = getU16(p) | (static_cast<uint32_t>(getU16(p + 2)) << 16);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    
+    bool fitsInt16(const Point2f& point, const Point2f& origin, float scale) {
+        return fabs((point.x - origin.x) * scale) <= 32767.0f &&
+               fabs((point.y - origin.y) * scale) <= 32767.0f;
+    }
+}
+
+void FaceGeometryCodec::encode(const DetectedFace& face, vector<uint8_t>& out) {
+    int landmark_count = face.has_landmarks ? FACE_LANDMARK_COUNT : 0;
+    int mesh_count = face.has_landmarks ? FACE_MESH_POINT_COUNT : 0;
+    Point2f origin(static_cast<float>(face.rect.x), static_cast<float>(face.rect.y));
+    const float scale = static_cast<float>(1 << FRACTION_BITS);
+    
+    bool small = true;
+    for (int i = 0; i < landmark_count && small; i++) small = fitsInt16(face.landmarks[i], origin, scale);
+    for (int i = 0; i < mesh_count && small; i++) small = fitsInt16(face.face_mesh[i], origin, scale);
+    
+    out.clear();
+    out.reserve(HEADER_SIZE + (landmark_count + mesh_count) * (small ? 4 : 8));
+    out.push_back(small ? INT16_OFFSET : FLOAT32);
+    out.push_back(static_cast<uint8_t>(landmark_count));
+    out.push_back(static_cast<uint8_t>(mesh_count));
+    out.push_back(small ? FRACTION_BITS : 0);
+    putF32(out, small ? origin.x : 0.0f);
+    putF32(out, small ? origin.y : 0.0f);
+    
+    auto put = [&](const Point2f& point) {
+        if (small) {
+            putU16(out, static_cast<uint16_t>(static_cast<int16_t>(lround((point.x - origin.x) * scale))));
+            putU16(out, static_cast<uint16_t>(static_cast<int16_t>(lround((point.y - origin.y) * scale))));
+        } else {
+            putF32(out, point.x);
+            putF32(out, point.y);
+        }
+    };
+    for (int i = 0; i < landmark_count; i++) put(face.landmarks[i]);
+    for (int i = 0; i < mesh_count; i++) put(face.face_mesh[i]);
+}
+
+bool FaceGeometryCodec::decode(const uint8_t* data, size_t size, DetectedFace& face) {
+    if (data == nullptr || size < HEADER_SIZE) return false;
+    
+    uint8_t encoding = data[0];
+    int landmark_count = data[1];
+    int mesh_count = data[2];
+    int fraction_bits = data[3];
+    if (encoding != INT16_OFFSET && encoding != FLOAT32) return false;
+    if (fraction_bits > 15) return false;
+    
+    // Faces carry either the full landmark set and mesh or nothing
+    bool full = landmark_count == FACE_LANDMARK_COUNT && mesh_count == FACE_MESH_POINT_COUNT;
+    if (!full && (landmark_count != 0 || mesh_count != 0)) return false;
+    
+    size_t point_size = encoding == INT16_OFFSET ? 4 : 8;
+    if (size != HEADER_SIZE + (landmark_count + mesh_count) * point_size) return false;
+    
+    Point2f origin(getF32(data + 4), getF32(data + 8));
+    float step = 1.0f / static_cast<float>(1 << fraction_bits);
+    const uint8_t* p = data + HEADER_SIZE;
+    
+    auto get = [&]() {
+        Point2f point;
+        if (encoding == INT16_OFFSET) {
+            point.x = origin.x + static_cast<int16_t>(getU16(p)) * step;
+            point.y = origin.y + static_cast<int16_t>(getU16(p + 2)) * step;
+        } else {
+            point.x = getF32(p);
+            point.y = getF32(p + 4);
+        }
+        p += point_size;
+        return point;
+    };
+    for (int i = 0; i < landmark_count; i++) face.landmarks[i] = get();
+    for (int i = 0; i < mesh_count; i++) face.face_mesh[i] = get();
+    face.has_landmarks = full;
+    return true;
+}
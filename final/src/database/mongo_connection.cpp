@@ -0,0 +1,77 @@
+#include "../headers/mongo_connection.h"
+#include <bsoncxx/builder/basic/document.hpp>
+#include <mongocxx/client.hpp>
+#include <mongocxx/database.hpp>
+#include <mongocxx/uri.hpp>
+#include <chrono>
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+namespace {
+    // Adds URI options ("mongodb://host" needs a "/" before the "?")
+    string withOptions(const string& uri, const string& options) {
+        size_t hosts = uri.find("://");
+        hosts = hosts == string::npos ? 0 : hosts + 3;
+        if (uri.find('?', hosts) != string::npos) return uri + "&" + options;
+        if (uri.find('/', hosts) != string::npos) return uri + "?" + options;
+        return uri + "/?" + options;
+    }
+}
+
+MongoConnection::MongoConnection(const string& connection_string)
+    : connection_string(connection_string) {
+}
+
+MongoConnection::Client MongoConnection::acquire() {
+    mongocxx::pool* created;
+    {
+        lock_guard<mutex> guard(lock);
+        if (!client_pool) {
+            // Parses the URI only; the handshake happens on the first command
+            client_pool = make_unique<mongocxx::pool>(mongocxx::uri{connection_string});
+            stats.pool_created = true;
+        }
+        stats.checkouts++;
+        created = client_pool.get();
+    }
+    // pool::acquire is thread-safe and may wait for a free client
+    return created->acquire();
+}
+
+MongoPingResult MongoConnection::ping(chrono::milliseconds timeout) {
+    MongoPingResult result;
+    auto start = chrono::steady_clock::now();
+    result.sent_at = start;
+    try {
+        if (timeout.count() > 0) {
+            // A single-threaded client tries once, so the connect timeout bounds it too
+            string limit = to_string(timeout.count());
+            mongocxx::client client{mongocxx::uri{withOptions(connection_string,
+                "serverSelectionTimeoutMS=" + limit + "&connectTimeoutMS=" + limit)}};
+            client["admin"].run_command(make_document(kvp("ping", 1)));
+        } else {
+            auto client = acquire();
+            (*client)["admin"].run_command(make_document(kvp("ping", 1)));
+        }
+        result.ok = true;
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    result.round_trip_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    lock_guard<mutex> guard(lock);
+    stats.pings++;
+    if (!result.ok) stats.failed_pings++;
+    stats.last_ping = result;
+    return result;
+}
+
+MongoConnectionStats MongoConnection::getStats() const {
+    lock_guard<mutex> guard(lock);
+    return stats;
+}
+
+const string& MongoConnection::getConnectionString() const {
+    return connection_string;
+}
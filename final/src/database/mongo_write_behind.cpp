@@ -0,0 +1,181 @@
+#include "../headers/mongo_write_behind.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+WriteBehindConfig WriteBehindConfig::fromEnv(const unordered_map<string, string>& env) {
+    WriteBehindConfig config;
+    auto value = [&env](const string& key) {
+        auto it = env.find(key);
+        return it != env.end() ? it->second : string();
+    };
+    
+    string batch_size = value("MONGODB_BATCH_SIZE");
+    if (atoi(batch_size.c_str()) > 0) config.batch_size = atoi(batch_size.c_str());
+    
+    string flush_ms = value("MONGODB_FLUSH_MS");
+    if (atoi(flush_ms.c_str()) > 0) config.flush_interval = chrono::milliseconds(atoi(flush_ms.c_str()));
+    
+    string capacity = value("MONGODB_QUEUE_CAPACITY");
+    if (atoi(capacity.c_str()) > 0) config.queue_capacity = atoi(capacity.c_str());
+    
+    string write_concern = value("MONGODB_WRITE_CONCERN");
+    if (!write_concern.empty()) config.write_concern = write_concern;
+    
+    string journal = value("MONGODB_JOURNAL");
+    if (!journal.empty()) config.journal = journal == "1" || journal == "true";
+    
+    config.queue_capacity = max(config.queue_capacity, config.batch_size);
+    return config;
+}
+
+mongocxx::write_concern MongoWriteBehind::makeWriteConcern(const WriteBehindConfig& config) {
+    mongocxx::write_concern concern;
+    if (config.write_concern == "majority") {
+        concern.acknowledge_level(mongocxx::write_concern::level::k_majority);
+    } else if (config.write_concern == "0") {
+        concern.acknowledge_level(mongocxx::write_concern::level::k_unacknowledged);
+    } else {
+        concern.nodes(max(1, atoi(config.write_concern.c_str())));
+    }
+    // The journal cannot be waited on without acknowledgement
+    if (config.write_concern != "0") {
+        concern.journal(config.journal);
+        concern.timeout(config.write_timeout);
+    }
+    return concern;
+}
+
+MongoWriteBehind::MongoWriteBehind(MongoDBHandler& database, const WriteBehindConfig& config)
+    : database(database),
+      config(config),
+      attempted(0),
+      flush_through(0),
+      writing(false),
+      stopping(false),
+      total_flush_ms(0.0) {
+    // Unordered: one bad document does not keep the rest of its batch from being written
+    insert_options.ordered(false);
+    insert_options.write_concern(makeWriteConcern(config));
+    batch.reserve(config.batch_size);
+    writer = thread(&MongoWriteBehind::writeLoop, this);
+}
+
+MongoWriteBehind::~MongoWriteBehind() {
+    stop();
+}
+
+bool MongoWriteBehind::enqueue(bsoncxx::document::value document) {
+    unique_lock<mutex> guard(lock);
+    
+    // Backpressure: wait for the writer, but never forever
+    bool has_room = room_or_flushed.wait_for(guard, config.enqueue_timeout, [this] {
+        return queue.size() < config.queue_capacity || stopping;
+    });
+    if (!has_room || stopping) {
+        stats.rejected++;
+        return false;
+    }
+    
+    auto now = chrono::steady_clock::now();
+    if (stats.enqueued == 0) first_enqueue = now;
+    queue.push_back({std::move(document), now});
+    stats.enqueued++;
+    
+    guard.unlock();
+    wake_writer.notify_one();
+    return true;
+}
+
+bool MongoWriteBehind::flush(chrono::milliseconds timeout) {
+    unique_lock<mutex> guard(lock);
+    if (!writer.joinable()) return queue.empty();
+    
+    // The queue is FIFO, so the flush is done once the writer has sent this many
+    uint64_t target = stats.enqueued;
+    if (attempted >= target) return true;
+    flush_through = max(flush_through, target);
+    wake_writer.notify_one();
+    return room_or_flushed.wait_for(guard, timeout, [this, target] { return attempted >= target; });
+}
+
+void MongoWriteBehind::stop() {
+    {
+        lock_guard<mutex> guard(lock);
+        if (!writer.joinable()) return;
+        stopping = true;
+    }
+    wake_writer.notify_one();
+    room_or_flushed.notify_all();
+    writer.join();
+}
+
+void MongoWriteBehind::writeLoop() {
+    unique_lock<mutex> guard(lock);
+    
+    while (true) {
+        if (queue.empty()) {
+            if (stopping) break;
+            wake_writer.wait(guard, [this] { return !queue.empty() || stopping; });
+            continue;
+        }
+        
+        // Write a batch when it is full, old enough, or a flush is waiting for it
+        auto deadline = queue.front().queued_at + config.flush_interval;
+        bool due = queue.size() >= config.batch_size || stopping ||
+                   attempted < flush_through || chrono::steady_clock::now() >= deadline;
+        if (!due) {
+            wake_writer.wait_until(guard, deadline);
+            continue;
+        }
+        
+        size_t count = min(queue.size(), config.batch_size);
+        batch.clear();
+        for (size_t i = 0; i < count; i++) {
+            batch.push_back(std::move(queue.front().document));
+            queue.pop_front();
+        }
+        writing = true;
+        room_or_flushed.notify_all();
+        guard.unlock();
+        
+        // The round trip happens without the lock, so callers can keep queueing
+        auto start = chrono::steady_clock::now();
+        size_t inserted = 0;
+        bool written = database.insertMany(batch, insert_options, inserted);
+        auto finished = chrono::steady_clock::now();
+        
+        guard.lock();
+        writing = false;
+        double flush_ms = chrono::duration<double, milli>(finished - start).count();
+        total_flush_ms += flush_ms;
+        stats.max_flush_ms = max(stats.max_flush_ms, flush_ms);
+        stats.batches++;
+        stats.written += inserted;
+        stats.failed += count - min(count, inserted);
+        last_write = finished;
+        attempted += count;
+        room_or_flushed.notify_all();
+        if (!written) {
+            cerr << "⚠️  MongoDB batch of " << count << " document(s) failed ("
+                 << count - min(count, inserted) << " not written)" << endl;
+        }
+    }
+}
+
+WriteBehindStats MongoWriteBehind::getStats() const {
+    lock_guard<mutex> guard(lock);
+    WriteBehindStats result = stats;
+    result.pending = queue.size() + (writing ? batch.size() : 0);
+    if (stats.batches > 0) {
+        result.average_batch = static_cast<double>(stats.written + stats.failed) / stats.batches;
+        result.average_flush_ms = total_flush_ms / stats.batches;
+        double seconds = chrono::duration<double>(last_write - first_enqueue).count();
+        result.documents_per_second = seconds > 0.0 ? stats.written / seconds : 0.0;
+    }
+    return result;
+}
+
+const WriteBehindConfig& MongoWriteBehind::getConfig() const {
+    return config;
+}
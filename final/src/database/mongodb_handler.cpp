@@ -1,9 +1,16 @@
 #include "../headers/mongodb_handler.h"
+#include "../headers/landmark_template.h"
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <bsoncxx/oid.hpp>
 #include <bsoncxx/types.hpp>
 #include <bsoncxx/builder/basic/array.hpp>
-#include <mongocxx/uri.hpp>
+#include <mongocxx/client.hpp>
+#include <mongocxx/database.hpp>
+#include <mongocxx/options/find.hpp>
+#include <mongocxx/options/index.hpp>
+#include <mongocxx/pipeline.hpp>
+#include <mongocxx/exception/bulk_write_exception.hpp>
 #include <mongocxx/exception/exception.hpp>
 #include <iostream>
 #include <chrono>
@@ -14,81 +21,236 @@ using bsoncxx::builder::basic::kvp;
 using bsoncxx::builder::basic::make_document;
 using bsoncxx::builder::basic::make_array;
 
-MongoDBHandler::MongoDBHandler(const string& connection_string)
-    : db_client(mongocxx::uri{connection_string}),
-      db(db_client["facemesh_app"]),
-      face_collection(db["face_analysis"]) {
+namespace {
+    // $sum yields int32, int64 or double depending on the values summed
+    int64_t readCount(const bsoncxx::document::element& element) {
+        if (!element) return 0;
+        switch (element.type()) {
+            case bsoncxx::type::k_int32: return element.get_int32().value;
+            case bsoncxx::type::k_int64: return element.get_int64().value;
+            case bsoncxx::type::k_double: return static_cast<int64_t>(element.get_double().value);
+            default: return 0;
+        }
+    }
+    
+    // Splits the per-document errors of a bulk insert reply into duplicate _ids and
+    // documents the server refused (by batch index). False if anything else went
+    // wrong (no reply, write concern errors), which is worth retrying as a whole.
+    bool readWriteErrors(const mongocxx::bulk_write_exception& e, size_t& duplicates, vector<size_t>& refused) {
+        const int DUPLICATE_KEY = 11000;
+        duplicates = 0;
+        refused.clear();
+        auto reply = e.raw_server_error();
+        if (!reply) return false;
+        auto view = reply->view();
+        if (view["writeConcernErrors"] && !view["writeConcernErrors"].get_array().value.empty()) return false;
+        auto errors = view["writeErrors"];
+        if (!errors || errors.type() != bsoncxx::type::k_array) return false;
+        for (auto&& error : errors.get_array().value) {
+            auto details = error.get_document().value;
+            if (readCount(details["code"]) == DUPLICATE_KEY) {
+                duplicates++;
+            } else {
+                refused.push_back(static_cast<size_t>(readCount(details["index"])));
+            }
+        }
+        return duplicates + refused.size() > 0;
+    }
 }
 
-bool MongoDBHandler::testConnection() {
-    try {
-        face_collection.find_one({});
-        return true;
-    } catch (const std::exception& e) {
-        return false;
-    }
+MongoDBHandler::MongoDBHandler(MongoConnection& connection,
+                               const string& database_name,
+                               const string& collection_name)
+    : connection(connection),
+      database_name(database_name),
+      collection_name(collection_name),
+      face_format(FaceDocumentFormat::Expanded),
+      spool(nullptr) {
 }
 
-bool MongoDBHandler::saveFaceData(const vector<DetectedFace>& faces, 
-                                  const string& filename,
-                                  const string& pokemon_name,
-                                  const string& mask_file) {
-    try {
-        bsoncxx::builder::basic::array faces_array;
+MongoDBHandler::MongoDBHandler(const string& connection_string,
+                               const string& database_name,
+                               const string& collection_name)
+    : owned_connection(make_unique<MongoConnection>(connection_string)),
+      connection(*owned_connection),
+      database_name(database_name),
+      collection_name(collection_name),
+      face_format(FaceDocumentFormat::Expanded),
+      spool(nullptr) {
+}
+
+mongocxx::collection MongoDBHandler::captures(MongoConnection::Client& client) {
+    return (*client)[database_name][collection_name];
+}
+
+MongoConnection& MongoDBHandler::getConnection() {
+    return connection;
+}
+
+bool MongoDBHandler::testConnection(chrono::milliseconds timeout) {
+    return connection.ping(timeout).ok;
+}
+
+bsoncxx::document::value MongoDBHandler::buildFaceDocument(const FaceList& faces,
+                                                           const string& filename,
+                                                           const string& pokemon_name,
+                                                           const string& mask_file) {
+    bsoncxx::builder::basic::array faces_array;
+    vector<uint8_t> geometry;
+    
+    for (const auto& face : faces) {
+        int landmark_count = face.has_landmarks ? FACE_LANDMARK_COUNT : 0;
+        int mesh_count = face.has_landmarks ? FACE_MESH_POINT_COUNT : 0;
+        
+        bsoncxx::builder::basic::document face_document;
+        face_document.append(
+            kvp("face_id", face.face_id),
+            kvp("face_rect", make_document(
+                kvp("x", face.rect.x),
+                kvp("y", face.rect.y),
+                kvp("width", face.rect.width),
+                kvp("height", face.rect.height)
+            )),
+            kvp("confidence", face.confidence),
+            kvp("center", make_document(
+                kvp("x", face.center.x),
+                kvp("y", face.center.y)
+            ))
+        );
         
-        for (const auto& face : faces) {
+        if (face_format == FaceDocumentFormat::Compact) {
+            // Landmarks and mesh packed into one binary (see FaceGeometryCodec)
+            FaceGeometryCodec::encode(face, geometry);
+            face_document.append(kvp("geometry", bsoncxx::types::b_binary{
+                bsoncxx::binary_sub_type::k_binary,
+                static_cast<uint32_t>(geometry.size()),
+                geometry.data()
+            }));
+        } else {
             bsoncxx::builder::basic::array landmarks_array;
-            for (const auto& landmark : face.landmarks) {
+            for (int id = 0; id < landmark_count; id++) {
                 landmarks_array.append(make_document(
-                    kvp("id", landmark.landmark_id),
-                    kvp("name", landmark.landmark_name),
-                    kvp("x", landmark.point.x),
-                    kvp("y", landmark.point.y)
+                    kvp("id", id),
+                    kvp("name", landmarkName(id)),
+                    kvp("x", face.landmarks[id].x),
+                    kvp("y", face.landmarks[id].y)
                 ));
             }
             
             bsoncxx::builder::basic::array mesh_array;
-            for (const auto& point : face.face_mesh) {
+            for (int i = 0; i < mesh_count; i++) {
                 mesh_array.append(make_document(
-                    kvp("x", point.x),
-                    kvp("y", point.y)
+                    kvp("x", face.face_mesh[i].x),
+                    kvp("y", face.face_mesh[i].y)
                 ));
             }
             
-            faces_array.append(make_document(
-                kvp("face_rect", make_document(
-                    kvp("x", face.rect.x),
-                    kvp("y", face.rect.y),
-                    kvp("width", face.rect.width),
-                    kvp("height", face.rect.height)
-                )),
-                kvp("confidence", face.confidence),
-                kvp("center", make_document(
-                    kvp("x", face.center.x),
-                    kvp("y", face.center.y)
-                )),
+            face_document.append(
                 kvp("landmarks", landmarks_array),
-                kvp("face_mesh", mesh_array),
-                kvp("face_angle", face.face_angle),
-                kvp("mouth_open", face.mouth_open),
-                kvp("landmarks_count", static_cast<int>(face.landmarks.size())),
-                kvp("mesh_points_count", static_cast<int>(face.face_mesh.size()))
-            ));
+                kvp("face_mesh", mesh_array)
+            );
         }
         
-        auto doc = make_document(
-            kvp("filename", filename),
-            kvp("pokemon_name", pokemon_name),
-            kvp("mask_file", mask_file),
-            kvp("timestamp", getCurrentTimestamp()),
-            kvp("capture_time", bsoncxx::types::b_date{chrono::system_clock::now()}),
-            kvp("faces_detected", static_cast<int>(faces.size())),
-            kvp("faces", faces_array),
-            kvp("analysis_type", "pokemon_face_mesh"),
-            kvp("app_version", "4.0")
+        face_document.append(
+            kvp("face_angle", face.face_angle),
+            kvp("mouth_open", face.mouth_open),
+            kvp("landmarks_count", landmark_count),
+            kvp("mesh_points_count", mesh_count)
         );
+        faces_array.append(face_document.extract());
+    }
+    
+    // The _id is chosen here, not by the driver, so a replayed spool record is recognized as a duplicate
+    return make_document(
+        kvp("_id", bsoncxx::oid{}),
+        kvp("filename", filename),
+        kvp("pokemon_name", pokemon_name),
+        kvp("mask_file", mask_file),
+        kvp("timestamp", getCurrentTimestamp()),
+        kvp("capture_time", bsoncxx::types::b_date{chrono::system_clock::now()}),
+        kvp("faces_detected", static_cast<int>(faces.size())),
+        kvp("faces", faces_array),
+        kvp("face_format", faceDocumentFormatName(face_format)),
+        kvp("analysis_type", "pokemon_face_mesh"),
+        kvp("app_version", "4.0")
+    );
+}
+
+bool MongoDBHandler::readFaceGeometry(bsoncxx::document::view face_document, DetectedFace& face) {
+    face.has_landmarks = false;
+    try {
+        // Compact documents
+        auto geometry = face_document["geometry"];
+        if (geometry) {
+            if (geometry.type() != bsoncxx::type::k_binary) return false;
+            auto binary = geometry.get_binary();
+            return FaceGeometryCodec::decode(binary.bytes, binary.size, face);
+        }
+        
+        // Expanded documents
+        auto landmarks = face_document["landmarks"];
+        auto mesh = face_document["face_mesh"];
+        if (!landmarks || !mesh) return false;
+        
+        int landmark_count = 0;
+        for (auto&& element : landmarks.get_array().value) {
+            auto point = element.get_document().value;
+            int id = point["id"].get_int32().value;
+            if (id < 0 || id >= FACE_LANDMARK_COUNT) return false;
+            face.landmarks[id] = Point2f(static_cast<float>(point["x"].get_double().value),
+                                         static_cast<float>(point["y"].get_double().value));
+            landmark_count++;
+        }
+        
+        int mesh_count = 0;
+        for (auto&& element : mesh.get_array().value) {
+            if (mesh_count >= FACE_MESH_POINT_COUNT) return false;
+            auto point = element.get_document().value;
+            face.face_mesh[mesh_count++] = Point2f(static_cast<float>(point["x"].get_double().value),
+                                                   static_cast<float>(point["y"].get_double().value));
+        }
+        
+        if (landmark_count == 0 && mesh_count == 0) return true;
+        face.has_landmarks = landmark_count == FACE_LANDMARK_COUNT && mesh_count == FACE_MESH_POINT_COUNT;
+        return face.has_landmarks;
+    } catch (const std::exception& e) {
+        return false;
+    }
+}
+
+void MongoDBHandler::setFaceFormat(FaceDocumentFormat format) {
+    face_format = format;
+}
+
+FaceDocumentFormat MongoDBHandler::getFaceFormat() const {
+    return face_format;
+}
+
+void MongoDBHandler::attachSpool(CaptureSpool* spool) {
+    this->spool = spool;
+}
+
+bool MongoDBHandler::hasSpool() const {
+    return spool != nullptr;
+}
+
+bool MongoDBHandler::spoolFaceDocument(bsoncxx::document::view document) {
+    if (!spool) return false;
+    if (spool->append(document)) return true;
+    cerr << "❌ Failed to write capture to the spool " << spool->getConfig().path << endl;
+    return false;
+}
+
+bool MongoDBHandler::saveFaceData(const FaceList& faces, 
+                                  const string& filename,
+                                  const string& pokemon_name,
+                                  const string& mask_file) {
+    try {
+        auto doc = buildFaceDocument(faces, filename, pokemon_name, mask_file);
+        if (spool) return spoolFaceDocument(doc.view());
         
-        auto result = face_collection.insert_one(doc.view());
+        auto client = connection.acquire();
+        auto result = captures(client).insert_one(doc.view());
         return result.has_value();
         
     } catch (const std::exception& e) {
@@ -97,17 +259,102 @@ bool MongoDBHandler::saveFaceData(const vector<DetectedFace>& faces,
     }
 }
 
-void MongoDBHandler::showFaceDatabase() {
+bool MongoDBHandler::insertMany(const vector<bsoncxx::document::value>& documents,
+                                const mongocxx::options::insert& options,
+                                size_t& inserted,
+                                vector<size_t>* rejected) {
+    inserted = 0;
+    if (rejected) rejected->clear();
+    if (documents.empty()) return true;
+    
+    try {
+        auto client = connection.acquire();
+        auto result = captures(client).insert_many(documents, options);
+        // Unacknowledged writes report no result
+        inserted = result ? static_cast<size_t>(result->inserted_count()) : documents.size();
+        return true;
+    } catch (const mongocxx::bulk_write_exception& e) {
+        // Documents that are already stored (replayed from the spool) count as written
+        size_t duplicates = 0;
+        vector<size_t> refused;
+        if (readWriteErrors(e, duplicates, refused)) {
+            auto reply = e.raw_server_error();
+            inserted = static_cast<size_t>(readCount(reply->view()["nInserted"])) + duplicates;
+            if (refused.empty()) return true;
+            if (rejected) *rejected = refused;
+        }
+        cerr << "❌ MongoDB bulk insert failed: " << e.what() << endl;
+        return false;
+    } catch (const std::exception& e) {
+        cerr << "❌ Failed to save to MongoDB: " << e.what() << endl;
+        return false;
+    }
+}
+
+bool MongoDBHandler::dropCollection() {
+    try {
+        auto client = connection.acquire();
+        captures(client).drop();
+        return true;
+    } catch (const std::exception& e) {
+        cerr << "❌ Failed to drop MongoDB collection: " << e.what() << endl;
+        return false;
+    }
+}
+
+bool MongoDBHandler::createIndexes() {
+    try {
+        auto client = connection.acquire();
+        auto face_collection = captures(client);
+        
+        // Newest-first listings, and per-Pokémon queries in capture order
+        mongocxx::options::index by_time;
+        by_time.name("capture_time_desc");
+        face_collection.create_index(make_document(kvp("capture_time", -1)), by_time);
+        
+        mongocxx::options::index by_pokemon;
+        by_pokemon.name("pokemon_name_capture_time");
+        face_collection.create_index(make_document(kvp("pokemon_name", 1), kvp("capture_time", -1)), by_pokemon);
+        return true;
+    } catch (const std::exception& e) {
+        cerr << "⚠️  Could not create MongoDB indexes: " << e.what() << endl;
+        return false;
+    }
+}
+
+int MongoDBHandler::showFaceDatabase(int page, int page_size) {
+    page = max(page, 0);
+    page_size = max(page_size, 1);
     cout << "\n📋 CAPTURED FACES DATABASE:" << endl;
     cout << string(50, '-') << endl;
     
     try {
-        auto cursor = face_collection.find({});
+        auto client = connection.acquire();
+        auto face_collection = captures(client);
+        
+        // Only the listed fields, one page, newest first (served by the capture_time index)
+        mongocxx::options::find options;
+        options.projection(make_document(
+            kvp("_id", 0),
+            kvp("filename", 1),
+            kvp("pokemon_name", 1),
+            kvp("mask_file", 1),
+            kvp("timestamp", 1),
+            kvp("faces_detected", 1),
+            kvp("face_format", 1),
+            kvp("app_version", 1)
+        ));
+        options.sort(make_document(kvp("capture_time", -1)));
+        options.skip(static_cast<int64_t>(page) * page_size);
+        options.limit(page_size);
+        
+        auto cursor = face_collection.find({}, options);
+        int first = page * page_size + 1;
         int count = 0;
         
         for (auto&& doc : cursor) {
+            cout << "\n🎭 Capture #" << first + count << ":" << endl;
             count++;
-            cout << "\n🎭 Capture #" << count << ":" << endl;
             
             if (doc["filename"]) {
                 cout << "  📸 File: " << doc["filename"].get_string().value << endl;
@@ -124,36 +371,50 @@ void MongoDBHandler::showFaceDatabase() {
             if (doc["faces_detected"]) {
                 cout << "  👤 Faces detected: " << doc["faces_detected"].get_int32().value << endl;
             }
+            if (doc["face_format"]) {
+                cout << "  💾 Face data: " << doc["face_format"].get_string().value << endl;
+            }
             if (doc["app_version"]) {
                 cout << "  📦 Version: " << doc["app_version"].get_string().value << endl;
             }
         }
         
+        // Collection metadata, not a scan
+        int64_t total = face_collection.estimated_document_count();
         if (count == 0) {
-            cout << "  No face captures found. Take some photos first!" << endl;
+            cout << (page == 0 ? "  No face captures found. Take some photos first!"
+                               : "  No more captures.") << endl;
         } else {
-            cout << "\n📊 Total analyses: " << count << endl;
+            cout << "\n📊 Captures " << first << "-" << first + count - 1
+                 << " of " << total << " (newest first)" << endl;
         }
+        return count;
         
     } catch (const std::exception& e) {
         cout << "❌ Error reading database: " << e.what() << endl;
+        return 0;
     }
 }
 
 pair<int, int> MongoDBHandler::getStatistics() {
     try {
-        int total_captures = 0;
-        int total_faces = 0;
+        auto client = connection.acquire();
+        auto face_collection = captures(client);
+        
+        // Counted on the server; a single small document comes back
+        mongocxx::pipeline pipeline;
+        pipeline.group(make_document(
+            kvp("_id", bsoncxx::types::b_null{}),
+            kvp("captures", make_document(kvp("$sum", 1))),
+            kvp("faces", make_document(kvp("$sum", "$faces_detected")))
+        ));
         
-        auto cursor = face_collection.find({});
+        auto cursor = face_collection.aggregate(pipeline);
         for (auto&& doc : cursor) {
-            total_captures++;
-            if (doc["faces_detected"]) {
-                total_faces += doc["faces_detected"].get_int32().value;
-            }
+            return make_pair(static_cast<int>(readCount(doc["captures"])),
+                             static_cast<int>(readCount(doc["faces"])));
         }
-        
-        return make_pair(total_captures, total_faces);
+        return make_pair(0, 0);   // Empty collection: $group produces nothing
     } catch (const std::exception& e) {
         return make_pair(0, 0);
     }
@@ -162,7 +423,9 @@ pair<int, int> MongoDBHandler::getStatistics() {
 string MongoDBHandler::getCurrentTimestamp() {
     auto now = chrono::system_clock::now();
     auto time_t = chrono::system_clock::to_time_t(now);
+    tm local_time;
+    localtime_r(&time_t, &local_time);   // Called from the UI and the photo writer
     stringstream ss;
-    ss << put_time(localtime(&time_t), "%Y%m%d_%H%M%S");
+    ss << put_time(&local_time, "%Y%m%d_%H%M%S");
     return ss.str();
 }
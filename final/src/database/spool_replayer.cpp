@@ -0,0 +1,188 @@
+#include "../headers/spool_replayer.h"
+#include <algorithm>
+#include <iostream>
+
+SpoolReplayer::SpoolReplayer(CaptureSpool& spool, MongoDBHandler& database,
+                             const WriteBehindConfig& write_config)
+    : spool(spool),
+      database(database),
+      write_config(write_config),
+      flush_requests(0),
+      flushes_done(0),
+      stopping(false),
+      retry_delay(spool.getConfig().retry_min),
+      retry_at(chrono::steady_clock::now()),
+      total_batch_ms(0.0) {
+    // Records leave the spool on MongoDB's word, so "0" (unacknowledged) would lose them
+    if (this->write_config.write_concern == "0") {
+        this->write_config.write_concern = "1";
+        cout << "💾 Capture spool: replaying with write concern 1 (MONGODB_WRITE_CONCERN=0 "
+             << "would drop captures the server never stored)" << endl;
+    }
+    
+    // Unordered: one bad document does not keep the rest of its batch from being written
+    insert_options.ordered(false);
+    insert_options.write_concern(MongoWriteBehind::makeWriteConcern(this->write_config));
+    batch.reserve(write_config.batch_size);
+    replayer = thread(&SpoolReplayer::replayLoop, this);
+}
+
+SpoolReplayer::~SpoolReplayer() {
+    stop();
+}
+
+bool SpoolReplayer::flush(chrono::milliseconds timeout) {
+    {
+        unique_lock<mutex> guard(lock);
+        // Offline the backoff schedule decides when to try again; the caller does not wait for it
+        if (!replayer.joinable() || !stats.online) return spool.getPendingRecords() == 0;
+        uint64_t ticket = ++flush_requests;
+        wake_replayer.notify_one();
+        if (!flushed.wait_for(guard, timeout, [this, ticket] { return flushes_done >= ticket; })) return false;
+    }
+    return spool.getPendingRecords() == 0;
+}
+
+void SpoolReplayer::stop() {
+    {
+        lock_guard<mutex> guard(lock);
+        if (!replayer.joinable()) return;
+        stopping = true;
+    }
+    wake_replayer.notify_one();
+    replayer.join();
+    
+    spool.sync();
+    size_t left = spool.getPendingRecords();
+    if (left > 0) {
+        cout << "💾 " << left << " capture(s) stay in " << spool.getConfig().path
+             << " and will be sent to MongoDB on the next run" << endl;
+    }
+}
+
+void SpoolReplayer::replayLoop() {
+    const SpoolConfig& config = spool.getConfig();
+    unique_lock<mutex> guard(lock);
+    
+    while (true) {
+        bool final_pass = stopping;
+        bool online = stats.online;
+        bool stalled = stats.stalled;
+        bool retry_due = chrono::steady_clock::now() >= retry_at;
+        uint64_t ticket = flush_requests;
+        guard.unlock();
+        
+        spool.syncIfDue();
+        
+        // Offline: only a ping on the backoff schedule decides when to resume. On exit
+        // one quick ping gets a last chance to send the spool before the next run.
+        if (!online && (retry_due || final_pass)) {
+            bool reachable = database.testConnection(final_pass ? config.final_ping : chrono::milliseconds(0));
+            guard.lock();
+            stats.reconnect_pings++;
+            if (reachable) {
+                stats.online = true;
+                retry_delay = config.retry_min;
+                cout << "🔌 MongoDB reachable again, replaying "
+                     << spool.getPendingRecords() << " spooled capture(s)" << endl;
+            } else {
+                retry_delay = min(retry_delay * 2, config.retry_max);
+                retry_at = chrono::steady_clock::now() + retry_delay;
+            }
+            online = stats.online;
+            guard.unlock();
+        }
+        
+        if (online && !stalled && spool.getPendingRecords() > 0) drain();
+        
+        guard.lock();
+        // A flush is answered even if MongoDB is down; the caller checks what is left
+        if (flushes_done < ticket) {
+            flushes_done = ticket;
+            flushed.notify_all();
+        }
+        if (final_pass) break;
+        
+        auto wake_at = chrono::steady_clock::now() + config.sync_interval;
+        if (!stats.online) wake_at = min(wake_at, retry_at);
+        wake_replayer.wait_until(guard, wake_at, [this] {
+            return stopping || flushes_done < flush_requests;
+        });
+    }
+}
+
+bool SpoolReplayer::drain() {
+    uint64_t next_offset = 0;
+    while (true) {
+        bool intact = spool.readBatch(write_config.batch_size, batch, next_offset);
+        if (batch.empty()) {
+            if (intact) return true;
+            uint64_t skipped = 0;
+            if (spool.skipCorrupt(skipped)) {
+                cerr << "⚠️  Capture spool: moved " << skipped << " unreadable byte(s) to "
+                     << spool.getConfig().path << ".corrupt" << endl;
+                continue;
+            }
+            stall("cannot move past an unreadable record");
+            return true;
+        }
+        
+        auto start = chrono::steady_clock::now();
+        size_t inserted = 0;
+        vector<size_t> rejected;
+        bool written = database.insertMany(batch, insert_options, inserted, &rejected) && inserted == batch.size();
+        double batch_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        
+        // Documents the server refuses would fail the same way on every retry
+        if (!written && !rejected.empty() && inserted + rejected.size() == batch.size()) {
+            bool moved = true;
+            for (size_t index : rejected) {
+                moved = moved && index < batch.size() && spool.reject(batch[index].view());
+            }
+            if (!moved) {
+                stall("cannot write " + spool.getConfig().path + ".rejected");
+                return true;
+            }
+            cerr << "⚠️  MongoDB refused " << rejected.size() << " capture(s), moved to "
+                 << spool.getConfig().path << ".rejected" << endl;
+            written = true;
+        }
+        
+        lock_guard<mutex> guard(lock);
+        if (!written) {
+            // Keep the batch in the spool and wait for MongoDB to come back
+            stats.failed_batches++;
+            stats.online = false;
+            retry_delay = spool.getConfig().retry_min;
+            retry_at = chrono::steady_clock::now() + retry_delay;
+            cerr << "⚠️  MongoDB unreachable, " << spool.getPendingRecords()
+                 << " capture(s) kept in the spool" << endl;
+            return false;
+        }
+        
+        spool.commit(next_offset, batch.size());
+        stats.batches++;
+        stats.replayed += inserted;
+        stats.rejected += rejected.size();
+        total_batch_ms += batch_ms;
+        stats.max_batch_ms = max(stats.max_batch_ms, batch_ms);
+    }
+}
+
+void SpoolReplayer::stall(const string& reason) {
+    lock_guard<mutex> guard(lock);
+    stats.stalled = true;
+    cerr << "❌ Capture spool: " << reason << ", replay stopped until the next run ("
+         << spool.getPendingRecords() << " capture(s) kept)" << endl;
+}
+
+SpoolReplayStats SpoolReplayer::getStats() const {
+    lock_guard<mutex> guard(lock);
+    SpoolReplayStats result = stats;
+    if (stats.batches > 0) {
+        result.average_batch = static_cast<double>(stats.replayed) / stats.batches;
+        result.average_batch_ms = total_batch_ms / stats.batches;
+        result.documents_per_second = total_batch_ms > 0.0 ? stats.replayed * 1000.0 / total_batch_ms : 0.0;
+    }
+    return result;
+}
@@ -0,0 +1,126 @@
+#ifndef BATCH_PROCESSOR_H
+#define BATCH_PROCESSOR_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "face_analyzer.h"
+#include "face_detector.h"
+#include "face_effects.h"
+#include "frame_pipeline.h"
+#include "particle_system.h"
+#include "session_recording.h"
+#include "thread_pool.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief What a batch run reads, draws and writes
+ */
+struct BatchConfig {
+    string input;                            // Video file, image directory or .fmrec recording
+    string output;                           // Video file (.mp4/.avi/.mkv) or directory for JPEG frames
+    string faces_csv;                        // Optional per-frame face list (CSV)
+    string mask_file = "pikachu_mask.png";   // Mask drawn on every face ("" = none)
+    ParticleKind particle_kind = ParticleKind::Lightning;
+    FaceDetectorSettings detector;           // Detection backend
+    size_t workers = 0;                      // Pool threads (0 = hardware threads - 1)
+    size_t window = 0;                       // Frames detected in parallel per step (0 = 4 per thread)
+    uint64_t seed = 1;                       // Particle random seed
+    size_t max_frames = 0;                   // Stop after this many frames (0 = all)
+    double fps = 0.0;                        // Frame rate of image directories / output (0 = video's own or 30)
+    int jpeg_quality = 90;                   // Quality of JPEG frame output
+};
+
+/**
+ * @brief Headless detection, masking and particles over a recorded session
+ *
+ * Frames are processed in windows. Decoding (image directories), detection
+ * and JPEG encoding are independent per frame and run across the thread
+ * pool, each worker with its own detector. Matching faces to tracks,
+ * smoothing and effects depend on the previous frame, so they run in
+ * frame order on the calling thread; with a fixed seed the output is the
+ * same on every run regardless of the number of workers.
+ */
+class BatchProcessor {
+private:
+    BatchConfig config;
+    ThreadPool pool;                                 // Workers for per-frame stages
+    FaceAnalyzer analyzer;                           // Tracks, smoothing and face description
+    FaceEffectsCompositor effects;                   // Masks and particles
+    vector<unique_ptr<FaceDetector>> detectors;      // One per thread that may detect at once
+    vector<FaceDetector*> idle_detectors;            // Detectors not in use (guarded by detector_lock)
+    mutex detector_lock;
+    
+    // Input and output
+    VideoCapture video;                              // Video input
+    SessionReader recording;                         // Recording input (frames carry capture times)
+    bool read_recording;                             // Input is a recording
+    vector<string> image_files;                      // Image directory input, sorted
+    size_t next_image;                               // Next file in image_files
+    Size image_size;                                 // First image's size; a video needs every frame at it
+    double input_fps;                                // Frame rate used for timestamps
+    VideoWriter writer;                              // Video output
+    bool write_video;                                // Output is a video file (else JPEG frames)
+    ofstream faces_out;                              // Face list output
+    
+    // Reused per-window buffers
+    vector<Mat> frames;                              // Decoded frames, composed in place
+    vector<double> times;                            // Per-frame timestamps (seconds)
+    vector<Mat> grays;                               // Per-frame equalized grayscale for the detectors
+    vector<vector<Rect>> detections;                 // Per-frame detector output
+    FaceList faces;                                  // Faces of the frame being composed
+    vector<Rect> dirty;                              // Areas drawn by the compositor
+    
+    // Statistics
+    StageStats decode;                               // Reading frames
+    StageStats detect;                               // Detector, per frame
+    StageStats compose;                              // Tracks, smoothing, masks and particles
+    StageStats encode;                               // Writing frames
+    uint64_t frame_count;                            // Frames processed
+    uint64_t face_count;                             // Faces summed over frames
+    uint64_t resized_count;                          // Images scaled to the video size
+    double wall_ms;                                  // Time for the whole run
+
+public:
+    explicit BatchProcessor(const BatchConfig& config);
+    
+    /**
+     * @brief Process the whole input
+     * @return false if the input, detector, mask or output could not be opened
+     */
+    bool run();
+    
+    /**
+     * @brief Print per-stage latency and throughput of the last run
+     */
+    void printStats() const;
+    
+    uint64_t getFrameCount() const;
+    uint64_t getFaceCount() const;
+
+private:
+    bool openInput();
+    bool openOutput(Size frame_size);
+    bool loadDetectors();
+    
+    /**
+     * @brief Decode up to frames.size() frames and their timestamps
+     * @return Number of frames read (0 at the end of the input)
+     */
+    size_t readWindow();
+    
+    void detectWindow(size_t count);
+    void composeWindow(size_t count, uint64_t first_frame);
+    void writeWindow(size_t count, uint64_t first_frame);
+    
+    FaceDetector* acquireDetector();
+    void releaseDetector(FaceDetector* detector);
+};
+
+#endif // BATCH_PROCESSOR_H
@@ -0,0 +1,76 @@
+#ifndef BLEND_KERNELS_H
+#define BLEND_KERNELS_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Horizontal run of non-transparent sprite pixels [x_begin, x_end) on row y
+ */
+struct OpaqueSpan {
+    int y;
+    int x_begin;
+    int x_end;
+};
+
+/**
+ * @brief Alpha blending kernels used to composite sprites onto BGR frames
+ *
+ * Straight-alpha sprites are 8-bit BGRA; the effective opacity of a pixel
+ * is alpha / 255 * alpha_scale, and pixels whose B + G + R is not above
+ * dark_threshold are skipped (the original mask behavior).
+ *
+ * Premultiplied sprites already carry the effective alpha and have the
+ * color scaled by it, so blending is out = img * (1 - alpha) + color.
+ */
+namespace BlendKernels {
+    
+    /**
+     * @brief Blend a BGRA sprite onto a BGR frame in place (fixed-point, SIMD when available)
+     * @param frame CV_8UC3 destination
+     * @param sprite CV_8UC4 source
+     * @param origin Frame position of the sprite's top-left corner (may be off-frame)
+     * @param alpha_scale Opacity multiplier applied to the sprite alpha (0.0 - 1.0)
+     * @param dark_threshold Sprite pixels with B + G + R <= threshold are left untouched
+     * @param use_simd Allow the vectorized path (false forces the scalar fallback)
+     * @return Frame rectangle that was blended (sprite clipped to the frame)
+     */
+    Rect blendBGRA(Mat& frame, const Mat& sprite, Point origin, float alpha_scale,
+                   int dark_threshold = 30, bool use_simd = true);
+    
+    /**
+     * @brief Original floating point per-pixel loop, kept as the reference for benchmarks
+     */
+    Rect blendBGRAReference(Mat& frame, const Mat& sprite, Point origin, float alpha_scale,
+                            int dark_threshold = 30);
+    
+    /**
+     * @brief Blend a premultiplied BGRA sprite onto a BGR frame in place
+     * @param frame CV_8UC3 destination
+     * @param sprite CV_8UC4 premultiplied source
+     * @param origin Frame position of the sprite's top-left corner (may be off-frame)
+     * @param spans Optional runs of non-transparent pixels; only these are touched
+     * @param use_simd Allow the vectorized path
+     * @return Frame rectangle covered by the sprite (clipped to the frame)
+     */
+    Rect blendPremultiplied(Mat& frame, const Mat& sprite, Point origin,
+                            const vector<OpaqueSpan>* spans = nullptr, bool use_simd = true);
+    
+    /**
+     * @brief Collect the runs of pixels with non-zero alpha in a BGRA sprite
+     * @param sprite CV_8UC4 sprite
+     * @param spans Output runs (cleared first), in row order
+     * @return Tight bounding box of the non-transparent pixels
+     */
+    Rect findOpaqueSpans(const Mat& sprite, vector<OpaqueSpan>& spans);
+    
+    /**
+     * @brief Whether the kernels were compiled with a vector path
+     */
+    bool simdAvailable();
+}
+
+#endif // BLEND_KERNELS_H
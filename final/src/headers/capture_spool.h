@@ -0,0 +1,173 @@
+#ifndef CAPTURE_SPOOL_H
+#define CAPTURE_SPOOL_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <bsoncxx/document/value.hpp>
+#include <bsoncxx/document/view.hpp>
+
+using namespace std;
+
+/**
+ * @brief Where the spool lives and how often it is synced to disk
+ */
+struct SpoolConfig {
+    string path = "spool/captures.spool";          // Empty disables the spool
+    size_t sync_records = 32;                      // fsync once this many records are unsynced
+    chrono::milliseconds sync_interval{200};       // ...or once the oldest has waited this long
+    chrono::milliseconds retry_min{500};           // First wait after MongoDB becomes unreachable
+    chrono::milliseconds retry_max{30000};         // Longest wait between reconnect pings
+    chrono::milliseconds final_ping{1000};         // Ping timeout on exit while MongoDB is unreachable
+    
+    bool enabled() const { return !path.empty(); }
+    
+    /**
+     * @brief Read MONGODB_SPOOL_PATH ("off" disables), MONGODB_SPOOL_SYNC_RECORDS
+     *        and MONGODB_SPOOL_SYNC_MS (missing keys keep the defaults)
+     */
+    static SpoolConfig fromEnv(const unordered_map<string, string>& env);
+};
+
+/**
+ * @brief Counters for the spool file
+ */
+struct SpoolStats {
+    uint64_t appended = 0;          // Records written since the spool was opened
+    uint64_t replayed = 0;          // Records committed as stored in MongoDB (or rejected)
+    uint64_t rejected = 0;          // Documents MongoDB refused, moved to "<path>.rejected"
+    uint64_t corrupt_bytes = 0;     // Unreadable bytes skipped, moved to "<path>.corrupt"
+    uint64_t syncs = 0;             // fsync calls
+    uint64_t recovered = 0;         // Records found unreplayed when the spool was opened
+    uint64_t truncated_bytes = 0;   // Torn tail dropped when the spool was opened
+    uint64_t append_errors = 0;     // Records that could not be written
+    size_t pending_records = 0;     // Records not yet replayed
+    uint64_t pending_bytes = 0;
+    size_t unsynced_records = 0;    // Appended but not yet fsynced
+    double average_sync_ms = 0.0;
+    double max_sync_ms = 0.0;
+};
+
+/**
+ * @brief Append-only file of capture documents waiting for MongoDB
+ *
+ * File layout (little-endian), one record per document:
+ *   u32 size, u32 FNV-1a checksum of the BSON bytes, size BSON bytes
+ *
+ * A document is on disk as soon as append() returns; fsync is batched
+ * (every sync_records records or sync_interval, whichever comes first), so
+ * a power loss can take at most one sync window with it. The replay
+ * position lives in "<path>.offset" and only moves forward after MongoDB
+ * has acknowledged a batch. When everything is replayed the file is
+ * truncated back to zero. Records carry their _id, so replaying a batch
+ * twice after a crash does not duplicate captures.
+ *
+ * open() checks every unreplayed record and cuts off a torn tail left by
+ * a crash mid-append: bad bytes with no intact record after them. Bad
+ * bytes in front of intact records are kept for the replay. Nothing that cannot be replayed stays
+ * in the way of the records behind it: documents MongoDB refuses go to
+ * "<path>.rejected" (same record layout) and bytes that fail their
+ * checksum later on go to "<path>.corrupt" as they were found.
+ */
+class CaptureSpool {
+private:
+    SpoolConfig config;
+    string offset_path;                        // "<path>.offset"
+    string rejected_path;                      // "<path>.rejected"
+    string corrupt_path;                       // "<path>.corrupt"
+    int fd;                                    // Spool file (-1 when closed)
+    mutable mutex lock;
+    uint64_t end_offset;                       // File size
+    uint64_t replay_offset;                    // First record not yet in MongoDB
+    size_t pending_records;
+    vector<uint8_t> record;                    // Reused header + document buffer
+    
+    // Sync state (guarded by lock)
+    size_t unsynced_records;
+    chrono::steady_clock::time_point oldest_unsynced;
+    
+    // Statistics (guarded by lock)
+    SpoolStats stats;
+    double total_sync_ms;
+
+public:
+    explicit CaptureSpool(const SpoolConfig& config = SpoolConfig());
+    ~CaptureSpool();
+    
+    CaptureSpool(const CaptureSpool&) = delete;
+    CaptureSpool& operator=(const CaptureSpool&) = delete;
+    
+    /**
+     * @brief Open or create the spool and recover unreplayed records
+     * @return false if the file cannot be opened
+     */
+    bool open();
+    void close();
+    bool isOpen() const;
+    
+    /**
+     * @brief Append one document (no fsync unless sync_records are now unsynced)
+     * @return false if the write failed; the document is not spooled
+     */
+    bool append(bsoncxx::document::view document);
+    
+    /**
+     * @brief fsync now if anything is unsynced
+     */
+    bool sync();
+    
+    /**
+     * @brief fsync if the oldest unsynced record has waited sync_interval
+     */
+    bool syncIfDue();
+    
+    /**
+     * @brief Read up to max_records documents from the replay position
+     * @param documents Receives the documents (cleared first)
+     * @param next_offset Replay position after these documents, for commit()
+     * @return false if a record is corrupt (documents holds the ones before it)
+     */
+    bool readBatch(size_t max_records, vector<bsoncxx::document::value>& documents, uint64_t& next_offset);
+    
+    /**
+     * @brief Mark everything before next_offset as stored in MongoDB
+     * @param records Number of documents that range holds
+     */
+    bool commit(uint64_t next_offset, size_t records);
+    
+    /**
+     * @brief Copy a document MongoDB refused to "<path>.rejected" (fsynced)
+     *
+     * The caller still commit()s its batch, so the document is not retried.
+     * @return false if the copy could not be written
+     */
+    bool reject(bsoncxx::document::view document);
+    
+    /**
+     * @brief Move the unreadable bytes at the replay position to "<path>.corrupt"
+     *        and resume at the next intact record
+     * @param skipped_bytes Set to the number of bytes moved
+     * @return false if there is nothing to skip or the bytes could not be saved
+     */
+    bool skipCorrupt(uint64_t& skipped_bytes);
+    
+    size_t getPendingRecords() const;
+    SpoolStats getStats() const;
+    const SpoolConfig& getConfig() const;
+    
+    /**
+     * @brief FNV-1a over the document bytes (the record checksum)
+     */
+    static uint32_t checksum(const uint8_t* data, size_t size);
+
+private:
+    bool syncLocked();
+    bool commitLocked(uint64_t next_offset, size_t records);
+    bool saveOffsetLocked();
+    uint64_t loadOffset() const;
+};
+
+#endif // CAPTURE_SPOOL_H
@@ -0,0 +1,86 @@
+#ifndef CASCADE_FACE_DETECTOR_H
+#define CASCADE_FACE_DETECTOR_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/objdetect.hpp>
+#include <string>
+#include <vector>
+#include "face_detector.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief How the Haar cascade searches a frame
+ */
+enum class DetectionStrategy {
+    FullFrame,      // Full-resolution search over the whole image (original behavior)
+    RoiPyramid      // Downscaled search restricted to the area around the previous face
+};
+
+/**
+ * @brief Tuning parameters for the cascade search
+ */
+struct CascadeSearchConfig {
+    double scale_factor = 1.1;      // detectMultiScale pyramid step
+    int min_neighbors = 3;          // detectMultiScale neighbor threshold
+    Size min_size = Size(30, 30);   // Smallest face searched for (full resolution)
+    double downscale = 0.5;         // Image scale used by RoiPyramid (raised so min_size stays >= 20 px)
+    float roi_expand = 0.75f;       // ROI growth around the previous face (fraction of its size)
+    float min_size_ratio = 0.7f;    // Smallest face relative to the previous face width
+    float max_size_ratio = 1.4f;    // Largest face relative to the previous face width
+};
+
+/**
+ * @brief Haar cascade face detector with selectable search strategy
+ */
+class CascadeFaceDetector : public FaceDetector {
+private:
+    CascadeClassifier cascade;      // Loaded Haar cascade
+    DetectionStrategy strategy;     // Active search strategy
+    CascadeSearchConfig config;     // Search parameters
+    Mat small_gray;                 // Reused downscaled search image
+    vector<Rect> small_faces;       // Reused detections in downscaled coordinates
+    bool loaded;                    // Whether a cascade file was loaded
+    
+public:
+    explicit CascadeFaceDetector(DetectionStrategy initial = DetectionStrategy::RoiPyramid);
+    
+    /**
+     * @brief Load the first cascade file that exists
+     * @param paths Candidate cascade XML paths
+     * @return Path that was loaded, or an empty string
+     */
+    string load(const vector<string>& paths);
+    
+    /**
+     * @brief Find faces in an equalized grayscale frame
+     * @param gray Equalized grayscale frame
+     * @param faces Output rectangles in full-resolution coordinates
+     * @param previous Last known face (RoiPyramid only); nullptr searches the whole frame
+     */
+    void detect(const Mat& gray, vector<Rect>& faces, const Rect* previous = nullptr);
+    
+    /**
+     * @brief FaceDetector entry point; the cascade only looks at gray
+     */
+    void detect(const Mat& image, const Mat& gray, vector<Rect>& faces, const Rect* previous) override;
+    
+    bool isLoaded() const override;
+    string name() const override;
+    void setStrategy(DetectionStrategy new_strategy);
+    DetectionStrategy getStrategy() const;
+    void setConfig(const CascadeSearchConfig& new_config);
+    const CascadeSearchConfig& getConfig() const;
+    
+    /**
+     * @brief Human-readable strategy name
+     */
+    static string strategyName(DetectionStrategy value);
+    
+private:
+    void detectFullFrame(const Mat& gray, vector<Rect>& faces);
+    void detectRoiPyramid(const Mat& gray, vector<Rect>& faces, const Rect* previous);
+};
+
+#endif // CASCADE_FACE_DETECTOR_H
@@ -3,9 +3,12 @@
 
 #include <string>
 #include <utility>
+#include "mongo_connection.h"
 
 using namespace std;
 
+struct BatchConfig;
+
 /**
  * @brief CLI interface functions for user interaction
  */
@@ -28,11 +31,11 @@ namespace CLIInterface {
     pair<string, string> getPokemonSelection();
     
     /**
-     * @brief Test MongoDB connection and display result
-     * @param connection_string MongoDB connection string
+     * @brief Ping MongoDB and display result
+     * @param connection Shared connection the app will use afterwards
      * @return true if connection successful
      */
-    bool testMongoDBConnection(const string& connection_string);
+    bool testMongoDBConnection(MongoConnection& connection);
     
     /**
      * @brief Display application instructions
@@ -44,6 +47,19 @@ namespace CLIInterface {
      * @param pokemon_name Name of the selected Pokémon
      */
     void displayGoodbye(const string& pokemon_name);
+    
+    /**
+     * @brief Parse "--batch <input> --output <path> [options]"
+     * @param config Filled from the arguments
+     * @return false if the arguments are incomplete or invalid
+     */
+    bool parseBatchArguments(int argc, char** argv, BatchConfig& config);
+    
+    /**
+     * @brief Display the batch mode options
+     * @param program Executable name
+     */
+    void displayBatchUsage(const string& program);
 }
 
 #endif // CLI_INTERFACE_H
@@ -0,0 +1,55 @@
+#ifndef DNN_FACE_DETECTOR_H
+#define DNN_FACE_DETECTOR_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+#include <opencv2/objdetect.hpp>
+#include <string>
+#include <vector>
+#include "face_detector.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Face detector running an OpenCV DNN model on the color frame
+ *
+ * Supports the ResNet-10 SSD (Caffe) through cv::dnn::Net and YuNet (ONNX)
+ * through cv::FaceDetectorYN. The frame is resized into a reused buffer at
+ * the configured input size, and the SSD input blob and output are reused
+ * too, so steady-state detection does not allocate.
+ */
+class DnnFaceDetector : public FaceDetector {
+private:
+    enum class Model { ResNetSsd, YuNet };
+    
+    DnnDetectorConfig config;       // Model files, input size and threshold
+    Model model;                    // Which network was loaded
+    dnn::Net net;                   // ResNet-SSD network
+    Ptr<FaceDetectorYN> yunet;      // YuNet detector
+    Mat resized;                    // Reused network-sized frame
+    Mat blob;                       // Reused SSD input blob
+    Mat output;                     // Reused network output
+    bool loaded;                    // Whether a model was loaded
+    
+public:
+    explicit DnnFaceDetector(const DnnDetectorConfig& config = DnnDetectorConfig());
+    
+    /**
+     * @brief Load the configured model files
+     * @return true if the network is ready
+     */
+    bool load();
+    
+    void detect(const Mat& image, const Mat& gray, vector<Rect>& faces, const Rect* previous) override;
+    bool isLoaded() const override;
+    string name() const override;
+    
+    const DnnDetectorConfig& getConfig() const;
+    
+private:
+    void detectSsd(const Mat& image, vector<Rect>& faces);
+    void detectYuNet(const Mat& image, vector<Rect>& faces);
+};
+
+#endif // DNN_FACE_DETECTOR_H
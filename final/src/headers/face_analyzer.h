@@ -0,0 +1,200 @@
+#ifndef FACE_ANALYZER_H
+#define FACE_ANALYZER_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "cascade_face_detector.h"
+#include "face_detector.h"
+#include "face_tracker.h"
+#include "face_smoother.h"
+#include "face_types.h"
+#include "mouth_detector.h"
+#include "thread_pool.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Finds and describes every face in a frame
+ *
+ * Each face gets its own track with a FaceTracker and a stable ID. Tracks
+ * are matched to detector output by overlap (IoU). Between detector runs
+ * all tracks are followed by template matching. Each track's box and angle
+ * go through a One-Euro filter before landmarks are generated, so the mask
+ * does not jitter with the raw detections. Per-face work (tracking,
+ * landmarks, mouth state) is spread across a shared ThreadPool.
+ */
+class FaceAnalyzer {
+public:
+    /**
+     * @brief One followed face
+     */
+    struct FaceTrack {
+        int id = -1;                 // Stable face ID reported in DetectedFace::face_id
+        FaceTracker tracker;         // Template tracker for this face
+        Rect rect;                   // Latest face rectangle
+        int missed_detections = 0;   // Cascade runs in a row that did not find this face
+        bool tracked = false;        // Whether the last frame found the face
+        MouthState mouth;            // Debounced mouth state
+        FaceSmoother smoother;       // Temporal filter for rect and angle
+    };
+    
+private:
+    unique_ptr<FaceDetector> detector;       // Active detection backend (null until one is set)
+    MouthDetector mouth_detector;            // Open/closed decision with hysteresis
+    ThreadPool& pool;                        // Workers for per-face work
+    vector<FaceTrack> tracks;                // Faces currently followed
+    int next_face_id;                        // ID for the next new face
+    bool tracking_enabled;                   // Detect every N frames and track in between
+    bool smoothing_enabled;                  // Filter rect and angle over time
+    OneEuroParams smoothing;                 // Latency/jitter tradeoff
+    double frame_time;                       // Capture time of the current frame (seconds)
+    
+    // Tuning
+    size_t max_faces;                        // Faces followed at most
+    float match_iou;                         // Minimum overlap to keep a face's ID
+    int max_missed_detections;               // Cascade misses before a track is dropped
+    int full_scan_interval;                  // Every Nth cascade run ignores the ROI hint
+    
+    // Reused per-frame buffers
+    Mat luma;                                // Grayscale frame
+    Mat luma_sum;                            // Integral of luma, shared by all faces' mouth checks
+    Mat gray;                                // Equalized grayscale frame
+    vector<Rect> detections;                 // Cascade output
+    vector<char> track_ok;                   // Per-track tracking result
+    vector<FaceTrack*> visible_tracks;       // Tracks reported this frame
+    
+    // Statistics
+    uint64_t cascade_runs;                   // Frames that ran the detector
+    uint64_t tracked_frames;                 // Frames served by template tracking only
+    uint64_t lost_count;                     // Tracks whose template match failed
+    uint64_t faces_created;                  // IDs handed out
+    SmoothingStats retired_smoothing;        // Smoothing stats of dropped tracks
+    
+public:
+    /**
+     * @param pool Shared workers for per-face work
+     * @param max_faces Faces followed at most (capped at MAX_FACES)
+     */
+    explicit FaceAnalyzer(ThreadPool& pool, size_t max_faces = MAX_FACES);
+    
+    /**
+     * @brief Use a Haar cascade loaded from the first path that works
+     * @return Loaded path, or empty if none could be loaded
+     */
+    string loadCascade(const vector<string>& paths);
+    
+    /**
+     * @brief Switch detection backend (forgets all faces)
+     */
+    void setDetector(unique_ptr<FaceDetector> new_detector);
+    
+    bool isReady() const;
+    
+    /**
+     * @brief Detect/track all faces and describe them (landmarks, mesh, mouth)
+     * @param image BGR frame
+     * @param faces Filled with one DetectedFace per tracked face, with its stable face_id
+     */
+    void analyze(const Mat& image, FaceList& faces);
+    
+    /**
+     * @brief Like analyze, with the frame's capture time instead of the clock
+     *
+     * Replays of a recording pass the recorded timestamps so smoothing
+     * behaves exactly as it did live, independent of replay speed.
+     */
+    void analyze(const Mat& image, double time_s, FaceList& faces);
+    
+    /**
+     * @brief Like analyze, but with detections found elsewhere
+     *
+     * Skips the detector and the template tracker: the given rectangles are
+     * matched to the tracks, then the faces are smoothed and described as
+     * usual. Batch processing runs the detectors for many frames in parallel
+     * and feeds their output through here in frame order.
+     * @param time_s Frame timestamp in seconds; drives the smoothing filters
+     *        so results do not depend on how fast frames are processed
+     */
+    void analyze(const Mat& image, const vector<Rect>& found, double time_s, FaceList& faces);
+    
+    /**
+     * @brief Forget all faces (the next frame runs the cascade)
+     */
+    void reset();
+    
+    void setTrackingEnabled(bool enabled);
+    bool isTrackingEnabled() const;
+    int getDetectInterval() const;
+    FaceDetector* getDetector();
+    
+    /**
+     * @brief The active backend if it is the Haar cascade, else nullptr
+     */
+    CascadeFaceDetector* getCascadeDetector();
+    MouthDetector& getMouthDetector();
+    
+    /**
+     * @brief Turn temporal smoothing on or off (filters restart when turned on)
+     */
+    void setSmoothingEnabled(bool enabled);
+    bool isSmoothingEnabled() const;
+    void setSmoothingParams(const OneEuroParams& params);
+    const OneEuroParams& getSmoothingParams() const;
+    
+    size_t getTrackCount() const;
+    uint64_t getCascadeRuns() const;
+    uint64_t getTrackedFrames() const;
+    uint64_t getLostCount() const;
+    uint64_t getFacesCreated() const;
+    
+    /**
+     * @brief Filter cost and jitter summed over current and dropped faces
+     */
+    SmoothingStats getSmoothingStats() const;
+    
+    // Per-face analysis
+    static void generateFacialLandmarks(const Rect& face_rect, FaceLandmarks& landmarks);
+    static void createFaceMesh(const FaceLandmarks& landmarks, FaceMesh& mesh);
+    static double calculateFaceAngle(const FaceLandmarks& landmarks);
+    static Point2f getMouthCenter(const FaceLandmarks& landmarks);
+    
+private:
+    /**
+     * @brief Follow every track into the new frame
+     * @return false if any track was lost and the cascade should run
+     */
+    bool trackAll();
+    
+    /**
+     * @brief Run the detector and match its detections to the tracks
+     */
+    void detectAndMatch(const Mat& image);
+    
+    /**
+     * @brief Match the rectangles in detections to the tracks (creates and drops tracks)
+     */
+    void matchDetections();
+    
+    /**
+     * @brief Grayscale buffers and timestamp for a new frame
+     */
+    void prepareFrame(const Mat& image, double time_s);
+    
+    /**
+     * @brief Describe every track that was found this frame
+     */
+    void describeVisible(const Mat& image, FaceList& faces);
+    
+    /**
+     * @brief Landmarks, mesh, angle and mouth state for one tracked face
+     */
+    void describeFace(const Mat& image, FaceTrack& track, DetectedFace& face) const;
+    
+    static float intersectionOverUnion(const Rect& a, const Rect& b);
+};
+
+#endif // FACE_ANALYZER_H
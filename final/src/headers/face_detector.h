@@ -0,0 +1,96 @@
+#ifndef FACE_DETECTOR_H
+#define FACE_DETECTOR_H
+
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Face detection backend used by FaceAnalyzer
+ *
+ * Implementations keep their scratch buffers between calls, so detect() is
+ * called from one thread at a time.
+ */
+class FaceDetector {
+public:
+    virtual ~FaceDetector() = default;
+    
+    /**
+     * @brief Find faces in a frame
+     * @param image BGR frame
+     * @param gray Equalized grayscale version of image
+     * @param faces Output rectangles in frame coordinates
+     * @param previous Last known face; a search hint that backends may ignore
+     */
+    virtual void detect(const Mat& image, const Mat& gray, vector<Rect>& faces, const Rect* previous) = 0;
+    
+    virtual bool isLoaded() const = 0;
+    
+    /**
+     * @brief Human-readable backend name, e.g. "cascade (roi-pyramid)"
+     */
+    virtual string name() const = 0;
+};
+
+/**
+ * @brief Available detector backends
+ */
+enum class FaceDetectorBackend {
+    Cascade,        // Haar cascade (CascadeFaceDetector)
+    Dnn             // OpenCV DNN model (DnnFaceDetector)
+};
+
+/**
+ * @brief Model files and tuning for the DNN backend
+ *
+ * The model type follows the weights file: .onnx is loaded as YuNet,
+ * anything else as the Caffe ResNet-10 SSD (which also needs config_path).
+ */
+struct DnnDetectorConfig {
+    string model_path = "models/res10_300x300_ssd_iter_140000.caffemodel";
+    string config_path = "models/deploy.prototxt";
+    Size input_size = Size(300, 300);   // Network input; smaller is faster but misses small faces
+    float confidence = 0.5f;            // Minimum score of a reported face
+};
+
+/**
+ * @brief Which detector to build at startup
+ */
+struct FaceDetectorSettings {
+    FaceDetectorBackend backend = FaceDetectorBackend::Cascade;
+    DnnDetectorConfig dnn;
+    
+    /**
+     * @brief Read FACE_DETECTOR, FACE_DNN_MODEL, FACE_DNN_CONFIG,
+     *        FACE_DNN_INPUT (e.g. 300x300) and FACE_DNN_CONFIDENCE
+     */
+    static FaceDetectorSettings fromEnv(const unordered_map<string, string>& env);
+};
+
+/**
+ * @brief Backend name as written in .env ("cascade" or "dnn")
+ */
+string backendName(FaceDetectorBackend backend);
+
+/**
+ * @brief Candidate locations of the frontal face Haar cascade
+ */
+vector<string> defaultCascadePaths();
+
+/**
+ * @brief Build and load the configured backend
+ * @param settings Backend selection and DNN model files
+ * @param cascade_paths Candidate Haar cascade files (cascade backend)
+ * @param loaded_from Set to the model file that was loaded
+ * @return The loaded detector, or nullptr if its model could not be loaded
+ */
+unique_ptr<FaceDetector> createFaceDetector(const FaceDetectorSettings& settings,
+                                            const vector<string>& cascade_paths,
+                                            string& loaded_from);
+
+#endif // FACE_DETECTOR_H
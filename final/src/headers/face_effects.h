@@ -0,0 +1,95 @@
+#ifndef FACE_EFFECTS_H
+#define FACE_EFFECTS_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "face_types.h"
+#include "mask_asset.h"
+#include "mask_renderer.h"
+#include "particle_system.h"
+#include "thread_pool.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Totals over all faces' effects
+ */
+struct FaceEffectsStats {
+    size_t faces = 0;                        // Faces with effects, including ones fading out
+    size_t particles = 0;                    // Live particles
+    uint64_t sprite_hits = 0;                // Mask sprite cache hits
+    uint64_t sprite_misses = 0;              // Mask sprite cache misses
+    size_t mip_levels = 0;                   // Most mip levels any renderer built
+    ParticleAllocatorStats particle_alloc;   // Summed particle allocator counters
+};
+
+/**
+ * @brief Draws the mask and particles for every face of a frame
+ *
+ * Each face ID gets its own MaskRenderer and ParticleSystem, kept for a
+ * while after the face leaves so its particles can fade out. Used by the
+ * live app and by batch processing, so both render identically.
+ */
+class FaceEffectsCompositor {
+private:
+    /**
+     * @brief Mask and particles that follow one face ID
+     */
+    struct FaceEffects {
+        MaskRenderer mask;                      // Per-face sprite cache
+        ParticleSystem particles;               // Per-face particle emitter
+        MaskRenderer::Placement placement;      // Sprite prepared for the current frame
+        const DetectedFace* face = nullptr;     // Face in the current frame (null once it left)
+    };
+    
+    ThreadPool& pool;                           // Workers for sprite preparation
+    unordered_map<int, FaceEffects> effects;    // Effects by face ID
+    vector<FaceEffects*> active;                // Reused list of effects drawn this frame
+    MaskAsset mask_asset;                       // Preprocessed mask shared by all faces
+    ParticleKind particle_kind;                 // Kind emitted by every face
+    uint64_t seed;                              // Particle seed; each face ID gets its own stream
+    float horizontal_offset;                    // Mask offset (fraction of face width)
+    float vertical_offset;                      // Mask offset (fraction of face height)
+    
+public:
+    explicit FaceEffectsCompositor(ThreadPool& pool);
+    
+    /**
+     * @brief Mask drawn on every face (an empty asset draws no mask)
+     */
+    void setMask(const MaskAsset& asset);
+    void setParticleKind(ParticleKind kind);
+    void setOffsets(float horizontal, float vertical);
+    
+    /**
+     * @brief Seed for particle systems created from now on
+     *
+     * A face's particles only depend on the seed, its ID and its mouth
+     * over time, so replaying the same faces reproduces the same frames.
+     */
+    void setSeed(uint64_t new_seed);
+    
+    /**
+     * @brief Draw masks and particles for one frame
+     * @param frame BGR frame drawn on in place
+     * @param faces Faces of this frame (pointers into it are kept until the next call)
+     * @param dirty Filled with the areas that were drawn on
+     */
+    void compose(Mat& frame, const FaceList& faces, vector<Rect>& dirty);
+    
+    /**
+     * @brief Drop all faces' effects and particles
+     */
+    void clear();
+    
+    FaceEffectsStats getStats() const;
+    
+private:
+    FaceEffects& effectsFor(int face_id);
+    static Rect updateParticles(Mat& frame, ParticleSystem& particles, const DetectedFace* face);
+};
+
+#endif // FACE_EFFECTS_H
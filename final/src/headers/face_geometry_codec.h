@@ -0,0 +1,62 @@
+#ifndef FACE_GEOMETRY_CODEC_H
+#define FACE_GEOMETRY_CODEC_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "face_types.h"
+
+using namespace std;
+
+/**
+ * @brief How each face's landmarks and mesh are stored in MongoDB
+ */
+enum class FaceDocumentFormat {
+    Expanded,   // One sub-document per landmark (id, name, x, y) and mesh point (x, y)
+    Compact     // One "geometry" binary per face (FaceGeometryCodec)
+};
+
+/**
+ * @brief Parse "expanded" or "compact"
+ * @return false if the name is not a known format (format is left unchanged)
+ */
+bool faceDocumentFormatFromName(const string& name, FaceDocumentFormat& format);
+
+const char* faceDocumentFormatName(FaceDocumentFormat format);
+
+/**
+ * @brief Packs a face's landmarks and mesh into a small binary blob
+ *
+ * Layout (little-endian, 12-byte header):
+ *   u8 encoding, u8 landmark count, u8 mesh point count, u8 fraction bits,
+ *   f32 origin x, f32 origin y,
+ *   then the landmarks followed by the mesh points as (x, y) pairs.
+ *
+ * Int16: each coordinate is its offset from the origin (the face rectangle's
+ * top-left corner) in 1/16 pixel steps, so 4 bytes per point and at most
+ * 1/32 pixel of rounding error. Float32: absolute coordinates, 8 bytes per
+ * point, used when a point is more than 2047 pixels from the origin.
+ * Landmark names are implied by the index (landmarkName(id)).
+ */
+namespace FaceGeometryCodec {
+    enum Encoding : uint8_t {
+        INT16_OFFSET = 1,
+        FLOAT32 = 2
+    };
+    
+    const size_t HEADER_SIZE = 12;
+    const int FRACTION_BITS = 4;
+    
+    /**
+     * @brief Encode a face's landmarks and mesh (only the header if it has none)
+     */
+    void encode(const DetectedFace& face, vector<uint8_t>& out);
+    
+    /**
+     * @brief Decode a blob written by encode() into face.landmarks and face.face_mesh
+     * @return false if the blob is truncated or not a known encoding
+     */
+    bool decode(const uint8_t* data, size_t size, DetectedFace& face);
+}
+
+#endif // FACE_GEOMETRY_CODEC_H
@@ -2,12 +2,29 @@
 #define FACE_MESH_APP_H
 
 #include <opencv2/opencv.hpp>
-#include <opencv2/objdetect.hpp>
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
+#include "capture_spool.h"
+#include "face_analyzer.h"
+#include "face_detector.h"
+#include "face_effects.h"
 #include "face_types.h"
+#include "frame_pipeline.h"
+#include "frame_pool.h"
+#include "mask_asset.h"
+#include "mask_renderer.h"
 #include "particle_system.h"
+#include "mongo_connection.h"
+#include "mongo_write_behind.h"
 #include "mongodb_handler.h"
+#include "photo_writer.h"
+#include "session_recording.h"
+#include "spool_replayer.h"
+#include "thread_pool.h"
 
 using namespace cv;
 using namespace std;
@@ -19,15 +36,23 @@ class FaceMeshApp {
 private:
     // Core components
     VideoCapture camera;                    // Camera for video capture
-    CascadeClassifier face_cascade;         // Face detection classifier
-    Mat mask_image;                         // Current Pokémon mask image
-    ParticleSystem particle_system;         // Particle effects system
+    ThreadPool face_pool;                   // Workers for per-face analysis and effects
+    FaceAnalyzer face_analyzer;             // Multi-face detection, tracking and landmarks
+    FaceEffectsCompositor face_effects;     // Per-face masks and particles
+    MaskAsset mask_asset;                   // Preprocessed mask shared by all faces
     unique_ptr<MongoDBHandler> mongo_handler; // MongoDB handler
+    unique_ptr<MongoWriteBehind> write_behind; // Batched capture inserts (flushed on shutdown)
+    unique_ptr<CaptureSpool> capture_spool; // Local copy of capture metadata until MongoDB has it
+    unique_ptr<SpoolReplayer> spool_replayer; // Sends the spool to MongoDB
+    unique_ptr<PhotoWriter> photo_writer;   // Saves captures off the UI thread (destroyed before mongo_handler)
+    thread index_builder;                   // Creates the MongoDB indexes off the UI thread
     
     // App state
+    FaceDetectorSettings detector_settings; // Detection backend chosen at startup
     string selected_mask_file;              // Current mask file (e.g., "mudkip_mask.png")
     string pokemon_name;                    // Current Pokémon name
     int photo_counter;                      // Counter for photo naming
+    int database_page;                      // Next page of captures the 'i' key lists
     bool use_real_camera;                   // Whether real camera is available
     bool face_detection_enabled;            // Whether face detection is working
     bool mask_loaded;                       // Whether mask image is loaded
@@ -36,19 +61,47 @@ private:
     float mask_vertical_offset;             // Adjustable vertical offset
     float mask_horizontal_offset;           // Adjustable horizontal offset
     
-    // Landmark names
-    vector<string> landmark_names;          // Names for the 68 facial landmarks
+    // Frame pipeline (capture thread -> detection worker -> render thread)
+    FrameQueue<FramePacket> detect_queue;     // Frames waiting for detection
+    FrameQueue<FramePacket> display_queue;    // Frames waiting to be displayed
+    FrameQueue<DetectionPacket> result_queue; // Detection results for the renderer
+    PipelineStats pipeline_stats;             // Per-stage latency counters
+    atomic<bool> pipeline_running;            // Cleared to stop the worker threads
+    mutex detection_mutex;                    // Serializes use of face_analyzer
+    SessionRecorder recorder;                 // Optional recording of captured frames for replay
+    
+    // Reused frame buffers (no per-frame allocations in steady state)
+    FramePool capture_pool;                   // Buffers the camera reads into
+    Mat display_buffer;                       // Composited frame shown on screen
+    vector<Rect> dirty_rects;                 // Areas touched by the last composition
+    
+    // Photo capture
+    FramePool photo_pool;                     // Buffers for frames waiting in the photo writer
+    FrameQueue<PhotoResult> photo_results;    // Finished photos, reported by the render thread
+    bool capture_requested;                   // Save the next composed frame
+    string photo_status;                      // Short on-screen note about the last photo
+    chrono::steady_clock::time_point photo_status_until; // When the note disappears
     
 public:
     /**
      * @brief Constructor
-     * @param connection_string MongoDB connection string
+     * @param connection Shared MongoDB connection (must outlive the app)
      * @param mask_file Pokémon mask file to use
      * @param pokemon Pokémon name
+     * @param detector Face detection backend (Haar cascade by default)
+     * @param writes Batching and write concern for saved captures
+     * @param face_format How landmarks and mesh are stored in saved captures
+     * @param spool Local spool captures are written to before MongoDB (disabled if its path is empty)
+     * @param mongo_reachable Whether the startup ping succeeded (indexes are skipped if not)
      */
-    FaceMeshApp(const string& connection_string, 
+    FaceMeshApp(MongoConnection& connection, 
                 const string& mask_file, 
-                const string& pokemon);
+                const string& pokemon,
+                const FaceDetectorSettings& detector = FaceDetectorSettings(),
+                const WriteBehindConfig& writes = WriteBehindConfig(),
+                FaceDocumentFormat face_format = FaceDocumentFormat::Expanded,
+                const SpoolConfig& spool = SpoolConfig(),
+                bool mongo_reachable = true);
     
     /**
      * @brief Destructor - cleanup resources
@@ -61,47 +114,73 @@ public:
     void run();
     
     /**
-     * @brief Process a single frame (detect faces, apply effects)
-     * @param image Input image to process
-     * @param source_type Description of image source
+     * @brief Show application statistics
      */
-    void processFrame(const Mat& image, const string& source_type);
+    void showAppStats();
     
     /**
-     * @brief Show application statistics
+     * @brief Show per-stage latency, queue depth and drop counters
      */
-    void showAppStats();
+    void showPipelineStats();
     
 private:
     // Initialization methods
-    void initializeLandmarkNames();
     void loadFaceDetectionModels();
     void initializeCamera();
     void setupParticleSystem();
     void loadMaskImage();
-    void downloadFaceModel();
     
-    // Face detection and analysis
-    vector<DetectedFace> detectFacesWithMesh(const Mat& image);
-    vector<FaceLandmark> generateFacialLandmarks(const Rect& face_rect);
-    vector<Point2f> createFaceMesh(const vector<FaceLandmark>& landmarks);
-    double calculateFaceAngle(const vector<FaceLandmark>& landmarks);
+    /**
+     * @brief Report configured DNN model files that are missing (make models fetches the defaults)
+     * @return true if every file the model needs exists
+     */
+    bool checkFaceModel();
+    
+    // Pipeline stages
+    void captureLoop();
+    void detectionLoop();
+    void renderLoop();
+    bool handleKey(int key);
+    
+    /**
+     * @brief Start or stop writing captured frames to recordings/
+     */
+    void toggleRecording();
     
-    // Mouth detection
-    bool detectMouthOpen(const vector<FaceLandmark>& landmarks);
-    bool detectMouthOpenSimple(const Mat& face_roi);
-    Point2f getMouthCenter(const vector<FaceLandmark>& landmarks);
-    Point2f calculateRealMouthCenter(const Rect& face_rect);
+    /**
+     * @brief Get queued and spooled captures into MongoDB before reading it back
+     *
+     * Waits a short while at most; whatever is still in flight shows up later.
+     */
+    void flushCaptureWrites();
+    
+    /**
+     * @brief Whether a query from the render thread is likely to get an answer
+     *
+     * Trusts the spool replayer's connection state; without one, a failed
+     * last ping is re-checked with a ping of at most half a second.
+     */
+    bool mongoReachable();
+    
+    /**
+     * @brief Hand a composed frame and its faces to the photo writer (UI thread, no I/O)
+     */
+    void capturePhoto(const Mat& composed, const FaceList& faces);
+    
+    /**
+     * @brief Print finished photos and keep the on-screen note up to date
+     */
+    void reportPhotos(Mat& display_frame);
+    
+    // Face detection and analysis
+    void detectFacesWithMesh(const Mat& image, FaceList& faces);
     
     // Mask and particle effects
     Mat createMaskOverlay(const Mat& image, const DetectedFace& face);
-    Mat applyCustomMask(const Mat& image, const DetectedFace& face);
     Mat createDefaultMask(const Mat& image, const DetectedFace& face);
-    Mat updateWaterParticles(const Mat& image, const Point2f& mouth_center, bool mouth_open);
     
     // Drawing and visualization
-    Mat drawFaceMeshOverlay(const Mat& image, const vector<DetectedFace>& faces);
-    Mat drawFaceWithMouthEmoji(const Mat& image, const vector<DetectedFace>& faces);
+    void composeFrame(Mat& frame, const FaceList& faces, vector<Rect>& dirty);
     
     // UI and interaction
     void displayInstructions();
@@ -0,0 +1,100 @@
+#ifndef FACE_SMOOTHER_H
+#define FACE_SMOOTHER_H
+
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <cstdint>
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief One-Euro filter tuning
+ *
+ * min_cutoff sets the smoothing of a still face (lower = less jitter, more
+ * lag); beta raises the cutoff with speed so fast motion is followed with
+ * little lag. Positions are in pixels, so beta is per pixel/second.
+ */
+struct OneEuroParams {
+    float min_cutoff = 1.0f;         // Hz at zero speed
+    float beta = 0.01f;              // Cutoff increase per unit/second of speed
+    float derivative_cutoff = 1.0f;  // Hz for the speed estimate
+};
+
+/**
+ * @brief Smoothing counters, summed over faces
+ */
+struct SmoothingStats {
+    uint64_t filtered = 0;           // Face-frames filtered (filterRect calls)
+    uint64_t samples = 0;            // Face-frames with a jitter sample (third and later of a face)
+    double filter_us = 0.0;          // Time spent filtering rectangles and angles
+    double raw_jitter = 0.0;         // Summed |second difference| of the raw face center (px)
+    double smoothed_jitter = 0.0;    // Same for the filtered face center
+    
+    void add(const SmoothingStats& other);
+    double averageFilterUs() const;
+    double averageRawJitter() const;
+    double averageSmoothedJitter() const;
+};
+
+/**
+ * @brief Single-value One-Euro low-pass filter
+ */
+class OneEuroChannel {
+private:
+    float value;
+    float derivative;
+    bool initialized;
+    
+public:
+    OneEuroChannel();
+    
+    /**
+     * @param x New raw sample
+     * @param dt Seconds since the previous sample
+     */
+    float filter(float x, float dt, const OneEuroParams& params);
+    float last() const { return value; }
+    void reset();
+};
+
+/**
+ * @brief Per-face temporal filter between detection and rendering
+ *
+ * Smooths the face box (center and size) and the face angle. Landmarks,
+ * mesh and mouth position are generated from the smoothed box, so they
+ * are smoothed along with it and the mask sprite cache sees steady sizes.
+ * Jitter is measured as the frame-to-frame acceleration of the box center,
+ * which steady motion does not contribute to.
+ */
+class FaceSmoother {
+private:
+    enum { CENTER_X, CENTER_Y, WIDTH, HEIGHT, ANGLE, CHANNEL_COUNT };
+    
+    array<OneEuroChannel, CHANNEL_COUNT> channels;
+    double last_time;                // Timestamp of the previous sample (seconds)
+    float last_dt;                   // Seconds between the last two samples
+    Point2f raw_history[2];          // Previous two raw centers
+    Point2f smoothed_history[2];     // Previous two smoothed centers
+    int history;                     // Valid history entries
+    SmoothingStats stats;
+    
+public:
+    FaceSmoother();
+    
+    /**
+     * @brief Filter a new face box
+     * @param time_s Capture time in seconds (any monotonic origin)
+     */
+    Rect filterRect(const Rect& raw, double time_s, const OneEuroParams& params);
+    
+    /**
+     * @brief Filter the face angle (degrees) of the sample passed to filterRect
+     */
+    double filterAngle(double raw_degrees, const OneEuroParams& params);
+    
+    void reset();
+    const SmoothingStats& getStats() const { return stats; }
+};
+
+#endif // FACE_SMOOTHER_H
@@ -0,0 +1,90 @@
+#ifndef FACE_TRACKER_H
+#define FACE_TRACKER_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Lightweight single-face tracker used between full cascade detections
+ *
+ * After a cascade hit the face patch is stored as a small grayscale template.
+ * On the following frames the template is matched inside an expanded region
+ * around the previous box at reduced resolution, which costs a tiny fraction
+ * of a full-frame detectMultiScale. The caller falls back to the cascade every
+ * N frames or as soon as the match score drops below the confidence threshold.
+ */
+class FaceTracker {
+private:
+    Mat face_template;           // Downscaled grayscale patch of the last detected face
+    Mat search_patch;            // Reused downscaled search region
+    Mat match_result;            // Reused matchTemplate output
+    Rect last_rect;              // Last known face rectangle (full resolution)
+    float confidence;            // Score of the last match (0.0 - 1.0)
+    bool tracking;               // Whether a face is currently being followed
+    int frames_since_detection;  // Frames tracked since the last cascade run
+    
+    // Tuning
+    int detect_interval;         // Run the full cascade every N frames
+    float min_confidence;        // Re-detect when the match score drops below this
+    float search_margin;         // Search region expansion (fraction of face size)
+    int template_width;          // Template width in pixels after downscaling
+    
+    // Statistics
+    uint64_t full_detections;    // Frames that ran the cascade
+    uint64_t tracked_frames;     // Frames served by template matching
+    uint64_t lost_count;         // Times tracking confidence fell too low
+    
+public:
+    static constexpr int DEFAULT_DETECT_INTERVAL = 5;  // Cascade runs every Nth frame unless configured
+    
+    /**
+     * @brief Constructor
+     * @param interval Run the full cascade every N frames
+     * @param min_score Minimum normalized correlation to keep tracking
+     * @param margin Search region expansion around the previous box
+     */
+    explicit FaceTracker(int interval = DEFAULT_DETECT_INTERVAL, float min_score = 0.6f, float margin = 0.5f);
+    
+    /**
+     * @brief Whether the next frame should run the full cascade
+     */
+    bool needsDetection() const;
+    
+    /**
+     * @brief Restart tracking from a fresh cascade detection
+     * @param gray Equalized grayscale frame the face was found in
+     * @param face_rect Detected face rectangle
+     */
+    void reset(const Mat& gray, const Rect& face_rect);
+    
+    /**
+     * @brief Follow the face into a new frame with a local template search
+     * @param gray Equalized grayscale frame
+     * @param face_rect Updated face rectangle on success
+     * @return false if the face was lost and the cascade should run
+     */
+    bool track(const Mat& gray, Rect& face_rect);
+    
+    /**
+     * @brief Drop the current track (no face found by the cascade)
+     */
+    void lose();
+    
+    /**
+     * @brief Record that the cascade ran for this frame
+     */
+    void countDetection();
+    
+    void setDetectInterval(int interval);
+    int getDetectInterval() const;
+    float getConfidence() const;
+    bool isTracking() const;
+    uint64_t getFullDetections() const;
+    uint64_t getTrackedFrames() const;
+    uint64_t getLostCount() const;
+};
+
+#endif // FACE_TRACKER_H
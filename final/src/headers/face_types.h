@@ -2,34 +2,91 @@
 #define FACE_TYPES_H
 
 #include <opencv2/opencv.hpp>
-#include <vector>
-#include <string>
+#include <array>
+#include <cstddef>
+#include <type_traits>
 
 using namespace cv;
 using namespace std;
 
+const int FACE_LANDMARK_COUNT = 68;
+const int FACE_MESH_POINT_COUNT = FACE_LANDMARK_COUNT + 16;   // Landmarks + jaw midpoints
+const int MAX_FACES = 8;                                        // Faces reported per frame at most
+
 /**
- * @brief Represents a single facial landmark point
+ * @brief IDs of the landmarks the app looks up directly
  */
-struct FaceLandmark {
-    Point2f point;           // 2D position of the landmark
-    int landmark_id;         // Unique identifier for the landmark
-    string landmark_name;    // Human-readable name of the landmark
+enum FaceLandmarkId {
+    LANDMARK_NOSE_TIP = 30,
+    LANDMARK_RIGHT_EYE_CENTER = 36,
+    LANDMARK_LEFT_EYE_CENTER = 42,
+    LANDMARK_MOUTH_CENTER = 48
 };
 
+/**
+ * @brief The 68 facial landmark points, indexed by landmark ID
+ *
+ * Names are not stored per face; landmarkName(id) (landmark_template.h)
+ * looks them up in a shared table.
+ */
+using FaceLandmarks = array<Point2f, FACE_LANDMARK_COUNT>;
+
+/**
+ * @brief Landmarks followed by the midpoints of the 16 jaw segments
+ */
+using FaceMesh = array<Point2f, FACE_MESH_POINT_COUNT>;
+
 /**
  * @brief Represents a detected face with all its features
+ *
+ * Fixed size and trivially copyable: copying a face never touches the heap.
  */
 struct DetectedFace {
+    int face_id = -1;                   // Stable ID while the face stays tracked
     Rect rect;                          // Bounding rectangle of the face
-    double confidence;                  // Detection confidence score
+    double confidence = 0.0;            // Detection confidence score
     Point2f center;                     // Center point of the face
-    vector<FaceLandmark> landmarks;     // 68 facial landmark points
-    vector<Point2f> face_mesh;          // Face mesh points for overlay
-    Mat mask_overlay;                   // Generated mask overlay
-    double face_angle;                  // Face rotation angle
-    bool mouth_open;                    // Mouth state (open/closed)
+    FaceLandmarks landmarks;            // 68 facial landmark points
+    bool has_landmarks = false;         // Whether landmarks and mesh were filled in
+    FaceMesh face_mesh;                 // Face mesh points for overlay
+    double face_angle = 0.0;            // Face rotation angle
+    bool mouth_open = false;            // Mouth state (open/closed)
     Point2f mouth_center;               // Center point of the mouth
 };
 
+static_assert(is_trivially_copyable<DetectedFace>::value,
+              "DetectedFace is copied through the frame pipeline and must stay trivially copyable");
+
+/**
+ * @brief The faces found in one frame, in a fixed-capacity buffer
+ *
+ * Also trivially copyable, so it can be reused frame after frame and passed
+ * through the pipeline queues without allocating.
+ */
+struct FaceList {
+    array<DetectedFace, MAX_FACES> items;   // Storage; only the first count are valid
+    size_t count = 0;                       // Faces in this frame
+    
+    /**
+     * @brief Append a default face
+     * @return The new face, or nullptr if the list is full
+     */
+    DetectedFace* add() {
+        if (count >= items.size()) return nullptr;
+        items[count] = DetectedFace();
+        return &items[count++];
+    }
+    
+    void clear() { count = 0; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    
+    DetectedFace& operator[](size_t i) { return items[i]; }
+    const DetectedFace& operator[](size_t i) const { return items[i]; }
+    DetectedFace* begin() { return items.data(); }
+    DetectedFace* end() { return items.data() + count; }
+    const DetectedFace* begin() const { return items.data(); }
+    const DetectedFace* end() const { return items.data() + count; }
+};
+
 #endif // FACE_TYPES_H
@@ -0,0 +1,198 @@
+#ifndef FRAME_PIPELINE_H
+#define FRAME_PIPELINE_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "face_types.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief A captured camera frame travelling through the pipeline
+ */
+struct FramePacket {
+    Mat frame;                                   // Captured BGR frame
+    uint64_t sequence = 0;                       // Monotonic frame number
+    chrono::steady_clock::time_point captured_at; // When the frame was grabbed
+};
+
+/**
+ * @brief Faces found by the detection stage for one frame
+ *
+ * Fixed size, so queueing a packet is a plain copy into a preallocated slot.
+ */
+struct DetectionPacket {
+    FaceList faces;                              // Detected faces
+    uint64_t sequence = 0;                       // Frame the faces belong to
+};
+
+/**
+ * @brief Bounded single-producer/single-consumer queue with "drop oldest" policy
+ *
+ * The slots are allocated once up front. When the queue is full a push
+ * evicts the oldest item so the consumer always sees the freshest frames.
+ */
+template <typename T>
+class FrameQueue {
+private:
+    vector<T> slots;                 // Ring buffer storage
+    size_t head;                     // Index of the oldest item
+    size_t count;                    // Number of queued items
+    uint64_t dropped;                // Items evicted because the queue was full
+    uint64_t pushed;                 // Items pushed in total
+    bool closed;                     // Set once the pipeline shuts down
+    mutable mutex lock;
+    condition_variable not_empty;
+
+public:
+    explicit FrameQueue(size_t capacity)
+        : slots(capacity > 0 ? capacity : 1), head(0), count(0),
+          dropped(0), pushed(0), closed(false) {}
+
+    /**
+     * @brief Push an item, evicting the oldest one if the queue is full
+     * @return false if an item had to be dropped
+     */
+    bool push(T item) {
+        bool evicted = false;
+        {
+            lock_guard<mutex> guard(lock);
+            if (count == slots.size()) {
+                head = (head + 1) % slots.size();
+                count--;
+                dropped++;
+                evicted = true;
+            }
+            slots[(head + count) % slots.size()] = std::move(item);
+            count++;
+            pushed++;
+        }
+        not_empty.notify_one();
+        return !evicted;
+    }
+
+    /**
+     * @brief Push an item only if there is room (never evicts)
+     *
+     * For work that must not be lost, such as photo captures: the producer
+     * learns the consumer is behind and can tell the user instead.
+     * @return false if the queue was full or closed
+     */
+    bool tryPush(T item) {
+        {
+            lock_guard<mutex> guard(lock);
+            if (count == slots.size() || closed) return false;
+            slots[(head + count) % slots.size()] = std::move(item);
+            count++;
+            pushed++;
+        }
+        not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Pop the oldest item, waiting up to timeout for one to arrive
+     * @return false on timeout or when the queue has been closed and drained
+     */
+    bool pop(T& out, chrono::milliseconds timeout) {
+        unique_lock<mutex> guard(lock);
+        if (!not_empty.wait_for(guard, timeout, [this] { return count > 0 || closed; })) {
+            return false;
+        }
+        if (count == 0) return false;
+        out = std::move(slots[head]);
+        head = (head + 1) % slots.size();
+        count--;
+        return true;
+    }
+
+    /**
+     * @brief Pop without waiting
+     */
+    bool tryPop(T& out) {
+        return pop(out, chrono::milliseconds(0));
+    }
+
+    /**
+     * @brief Wake up any waiting consumer and refuse to block again
+     */
+    void close() {
+        {
+            lock_guard<mutex> guard(lock);
+            closed = true;
+        }
+        not_empty.notify_all();
+    }
+
+    /**
+     * @brief Closed and empty: nothing will ever be popped again
+     */
+    bool drained() const {
+        lock_guard<mutex> guard(lock);
+        return closed && count == 0;
+    }
+
+    size_t size() const {
+        lock_guard<mutex> guard(lock);
+        return count;
+    }
+
+    size_t capacity() const { return slots.size(); }
+
+    uint64_t droppedCount() const {
+        lock_guard<mutex> guard(lock);
+        return dropped;
+    }
+
+    uint64_t pushedCount() const {
+        lock_guard<mutex> guard(lock);
+        return pushed;
+    }
+};
+
+/**
+ * @brief Latency counters for one pipeline stage (lock-free, safe to read any time)
+ */
+struct StageStats {
+    atomic<uint64_t> frames{0};      // Frames processed by the stage
+    atomic<uint64_t> total_us{0};    // Accumulated processing time
+    atomic<uint64_t> last_us{0};     // Most recent processing time
+    atomic<uint64_t> max_us{0};      // Worst processing time seen
+
+    void record(chrono::steady_clock::duration elapsed) {
+        uint64_t us = static_cast<uint64_t>(
+            chrono::duration_cast<chrono::microseconds>(elapsed).count());
+        frames++;
+        total_us += us;
+        last_us = us;
+        uint64_t prev = max_us.load();
+        while (us > prev && !max_us.compare_exchange_weak(prev, us)) {}
+    }
+
+    double averageMs() const {
+        uint64_t n = frames.load();
+        return n > 0 ? total_us.load() / 1000.0 / n : 0.0;
+    }
+
+    double lastMs() const { return last_us.load() / 1000.0; }
+    double maxMs() const { return max_us.load() / 1000.0; }
+};
+
+/**
+ * @brief Per-stage counters for the capture -> detect -> render pipeline
+ */
+struct PipelineStats {
+    StageStats capture;              // camera >> frame
+    StageStats detect;               // detectFacesWithMesh
+    StageStats render;               // compose + imshow
+    StageStats frame_age;            // capture-to-display latency
+    StageStats photo;                // UI-thread time to hand a photo to the writer
+};
+
+#endif // FRAME_PIPELINE_H
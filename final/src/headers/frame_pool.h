@@ -0,0 +1,42 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Fixed set of reusable frame buffers
+ *
+ * A buffer is handed out again once every Mat header that referenced it
+ * downstream has been released, so in steady state capture never touches
+ * the heap. Only the owning (producer) thread may call acquire().
+ */
+class FramePool {
+private:
+    vector<Mat> buffers;        // Pooled buffers (the pool keeps one reference each)
+    size_t max_buffers;         // Upper bound on pooled buffers
+    size_t next;                // Round-robin start index
+    uint64_t allocations;       // Buffers allocated (pooled or overflow)
+    uint64_t overflows;         // Acquires that found every buffer busy
+    
+public:
+    explicit FramePool(size_t capacity = 8);
+    
+    /**
+     * @brief Get a buffer that nothing else is using
+     * @param size Frame size
+     * @param type OpenCV matrix type (e.g. CV_8UC3)
+     * @return Mat sharing a pooled buffer; it returns to the pool when released
+     */
+    Mat acquire(Size size, int type);
+    
+    size_t size() const;
+    uint64_t getAllocationCount() const;
+    uint64_t getOverflowCount() const;
+};
+
+#endif // FRAME_POOL_H
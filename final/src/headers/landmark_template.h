@@ -0,0 +1,47 @@
+#ifndef LANDMARK_TEMPLATE_H
+#define LANDMARK_TEMPLATE_H
+
+#include <opencv2/opencv.hpp>
+#include "face_types.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Normalized layout of the 68 facial landmarks
+ *
+ * Every landmark is a fixed (u, v) position in the unit face square, so
+ * the landmarks for a face are x = rect.x + u * width, y = rect.y + v * height.
+ * The table (with all the sin/cos of the eye and mouth outlines) is built
+ * once; apply() is a single multiply-add pass over 136 interleaved floats.
+ */
+class LandmarkTemplate {
+private:
+    alignas(16) float uv[FACE_LANDMARK_COUNT * 2];   // u0, v0, u1, v1, ...
+
+public:
+    LandmarkTemplate();
+    
+    /**
+     * @brief The process-wide template (built on first use)
+     */
+    static const LandmarkTemplate& shared();
+    
+    /**
+     * @brief Place the template on a face rectangle
+     */
+    void apply(const Rect& face_rect, FaceLandmarks& landmarks) const;
+    
+    /**
+     * @brief Normalized position of one landmark
+     */
+    Point2f normalized(int landmark_id) const;
+};
+
+/**
+ * @brief Shared name of a landmark ID ("jaw_1", "right_eye_center", ...)
+ * @return "unknown" for IDs outside [0, FACE_LANDMARK_COUNT)
+ */
+const char* landmarkName(int landmark_id);
+
+#endif // LANDMARK_TEMPLATE_H
@@ -0,0 +1,89 @@
+#ifndef MASK_ASSET_H
+#define MASK_ASSET_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "blend_kernels.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief A mask image normalized for blending
+ *
+ * The opacity rules that used to run per pixel per frame (70% PNG alpha,
+ * opaque 3-channel masks, skipping near-black pixels) are applied once:
+ * pixels holds premultiplied BGRA cropped to the non-transparent area.
+ */
+struct MaskAsset {
+    string name;                     // Source file name (e.g. "mudkip_mask.png")
+    Size original_size;              // Size of the source image
+    Rect bounds;                     // Non-transparent area within the source image
+    Mat pixels;                      // Premultiplied BGRA, bounds.size()
+    vector<OpaqueSpan> spans;        // Non-transparent runs, relative to bounds
+    uint64_t source_bytes = 0;       // Size of the PNG it was made from (cache staleness check)
+    int64_t source_mtime = 0;        // Modification time of that PNG, in file clock ticks
+
+    bool empty() const { return pixels.empty(); }
+};
+
+/**
+ * @brief Mask preprocessing and the binary asset cache
+ */
+namespace MaskAssets {
+    /**
+     * @brief Convert a mask (BGRA, BGR or grayscale) into a premultiplied asset
+     * @param mask Source image as loaded with IMREAD_UNCHANGED
+     * @param name Name stored with the asset
+     * @param alpha_scale Opacity for masks with an alpha channel
+     * @param dark_threshold Pixels whose B + G + R is not above this are dropped
+     */
+    MaskAsset prepare(const Mat& mask, const string& name,
+                      float alpha_scale = 0.7f, int dark_threshold = 30);
+
+    /**
+     * @brief Write assets to a binary cache file
+     * @return true on success
+     */
+    bool saveCache(const string& path, const vector<MaskAsset>& assets);
+
+    /**
+     * @brief Read a binary cache file written by saveCache
+     * @return true if the file exists and is a valid cache
+     */
+    bool loadCache(const string& path, vector<MaskAsset>& assets);
+    
+    /**
+     * @brief Read one asset from a cache file, skipping over the others' pixels
+     * @return false if the cache is missing, invalid or has no asset of that name
+     */
+    bool loadCached(const string& path, const string& name, MaskAsset& asset);
+    
+    /**
+     * @brief Record a source file's size and modification time in the asset
+     * @return false if the file cannot be examined
+     */
+    bool stampSource(const string& source_path, MaskAsset& asset);
+
+    /**
+     * @brief Find an asset by name in a loaded cache
+     * @return nullptr if not present
+     */
+    const MaskAsset* find(const vector<MaskAsset>& assets, const string& name);
+    
+    /**
+     * @brief Load a mask by file name from the asset cache or images/
+     *
+     * A cached asset is only used while its source PNG still has the size
+     * and modification time recorded in the cache; an edited mask is
+     * converted from the PNG until `make assets` runs again.
+     * @param mask_file File name, e.g. "mudkip_mask.png" (or a path)
+     * @param loaded_from Set to the cache or image file that was used
+     * @return false if neither has the mask
+     */
+    bool load(const string& mask_file, MaskAsset& asset, string& loaded_from);
+}
+
+#endif // MASK_ASSET_H
@@ -0,0 +1,136 @@
+#ifndef MASK_RENDERER_H
+#define MASK_RENDERER_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+#include "face_types.h"
+#include "mask_asset.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Composites the Pokémon mask onto a frame in place
+ *
+ * Prepared (resized + rotated) sprites are cached under a quantized
+ * (width, height, angle) key, so small face movements reuse an existing
+ * sprite and resize/warpAffine only run when the face size or angle
+ * really changes. Resizing starts from the closest level of a mip chain
+ * built when the mask is set.
+ *
+ * The mask is held as a premultiplied, cropped MaskAsset; each prepared
+ * sprite keeps its opaque spans so blending skips transparent pixels.
+ */
+class MaskRenderer {
+public:
+    /**
+     * @brief One prepared sprite in the cache
+     */
+    struct SpriteCacheEntry {
+        int width_bucket = -1;       // Quantized sprite width
+        int height_bucket = -1;      // Quantized sprite height
+        int angle_bucket = 0;        // Quantized rotation angle
+        uint64_t last_used = 0;      // LRU stamp
+        Mat sprite;                  // Resized and rotated premultiplied BGRA mask
+        vector<OpaqueSpan> spans;    // Non-transparent runs of sprite
+    };
+    
+    /**
+     * @brief Where a prepared sprite goes for one face
+     *
+     * The entry stays valid until the next place() call on the same renderer.
+     */
+    struct Placement {
+        const SpriteCacheEntry* entry = nullptr;   // Sprite to blend (null if nothing to draw)
+        Point origin;                              // Frame position of the sprite's top-left corner
+    };
+    
+private:
+    MaskAsset mask_asset;        // Premultiplied mask cropped to its opaque area
+    vector<Mat> mip_chain;       // mask_asset.pixels followed by successive pyrDown levels
+    Mat resized_backing;         // Backing store for the unrotated sprite canvas
+    double rotation_data[6];     // 2x3 affine rotation matrix storage
+    
+    // Sprite cache
+    vector<SpriteCacheEntry> sprite_cache;   // Small LRU of prepared sprites
+    int size_step;               // Sprite size quantization (pixels)
+    double angle_step;           // Rotation quantization (degrees)
+    uint64_t use_clock;          // LRU clock
+    uint64_t cache_hits;         // Frames served from the cache
+    uint64_t cache_misses;       // Frames that had to resize/warp
+    
+    float vertical_offset;       // User adjustable vertical offset (fraction of face height)
+    float horizontal_offset;     // User adjustable horizontal offset (fraction of face width)
+    
+public:
+    MaskRenderer();
+    
+    /**
+     * @brief Set the mask image (BGR, BGRA or grayscale); it is preprocessed once
+     */
+    void setMask(const Mat& mask);
+    
+    /**
+     * @brief Set an already preprocessed mask (e.g. from the asset cache)
+     */
+    void setAsset(const MaskAsset& asset);
+    
+    /**
+     * @brief Whether a mask image is available
+     */
+    bool hasMask() const;
+    
+    /**
+     * @brief Set the user mask offsets
+     * @param horizontal Offset as a fraction of face width
+     * @param vertical Offset as a fraction of face height
+     */
+    void setOffsets(float horizontal, float vertical);
+    
+    /**
+     * @brief Configure sprite quantization
+     * @param size_pixels Width/height bucket size in pixels
+     * @param angle_degrees Rotation bucket size in degrees
+     */
+    void setCacheQuantization(int size_pixels, double angle_degrees);
+    
+    uint64_t getCacheHits() const;
+    uint64_t getCacheMisses() const;
+    size_t getMipLevels() const;
+    
+    /**
+     * @brief Blend the mask over a face, modifying frame in place
+     * @param frame BGR frame to draw on
+     * @param face Face to place the mask on
+     * @return Rectangle of frame pixels that may have changed (empty if none)
+     */
+    Rect apply(Mat& frame, const DetectedFace& face);
+    
+    /**
+     * @brief Size, rotate and position the sprite for a face without touching a frame
+     *
+     * Split from blend() so sprites for several faces can be prepared in
+     * parallel (one renderer per face) and then blended one after another.
+     */
+    Placement place(const DetectedFace& face);
+    
+    /**
+     * @brief Blend a placed sprite into frame
+     * @return Rectangle of frame pixels that may have changed (empty if none)
+     */
+    Rect blend(Mat& frame, const Placement& placement) const;
+    
+private:
+    /**
+     * @brief Return the cached sprite for a size/angle, preparing it on a miss
+     */
+    const SpriteCacheEntry& preparedSprite(int width, int height, double angle);
+    
+    /**
+     * @brief View of a growing backing buffer with the requested size and type
+     */
+    static Mat backedView(Mat& backing, Size size, int type);
+};
+
+#endif // MASK_RENDERER_H
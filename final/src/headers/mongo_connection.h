@@ -0,0 +1,85 @@
+#ifndef MONGO_CONNECTION_H
+#define MONGO_CONNECTION_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <mongocxx/pool.hpp>
+
+using namespace std;
+
+/**
+ * @brief Result of a ping
+ */
+struct MongoPingResult {
+    bool ok = false;
+    double round_trip_ms = 0.0;   // Includes the handshake if no pooled client was connected yet
+    string error;                 // Driver message when ok is false
+    chrono::steady_clock::time_point sent_at;
+};
+
+/**
+ * @brief Counters for the shared connection pool
+ */
+struct MongoConnectionStats {
+    uint64_t checkouts = 0;       // Clients handed out by acquire()
+    uint64_t pings = 0;
+    uint64_t failed_pings = 0;
+    bool pool_created = false;
+    MongoPingResult last_ping;    // Most recent ping from any thread (pings == 0: none yet)
+};
+
+/**
+ * @brief One mongocxx::pool shared by everything that talks to MongoDB
+ *
+ * The pool is created on first use, so constructing a connection never
+ * blocks. Clients keep their server connection when they go back to the
+ * pool: the startup ping pays the only handshake, and the UI, the photo
+ * writer and the write-behind thread each check out a client for the
+ * duration of one operation instead of sharing one behind a lock. The
+ * pool size comes from the URI (maxPoolSize, 100 by default).
+ */
+class MongoConnection {
+public:
+    using Client = mongocxx::pool::entry;   // Returned to the pool when destroyed
+
+private:
+    string connection_string;
+    unique_ptr<mongocxx::pool> client_pool; // Created by the first acquire()
+    mutable mutex lock;                     // Guards client_pool creation and stats
+    MongoConnectionStats stats;
+
+public:
+    /**
+     * @brief Remember the connection string (nothing is connected yet)
+     */
+    explicit MongoConnection(const string& connection_string);
+
+    MongoConnection(const MongoConnection&) = delete;
+    MongoConnection& operator=(const MongoConnection&) = delete;
+
+    /**
+     * @brief Check out a client (thread-safe; blocks while the pool is exhausted)
+     * @throws mongocxx::exception if the connection string is invalid
+     */
+    Client acquire();
+
+    /**
+     * @brief Run the "ping" command on the admin database
+     *
+     * Cheaper than a query: no collection, no cursor, nothing returned but
+     * { ok: 1 }. Blocks for up to the server selection timeout when
+     * MongoDB is down; the result is kept in getStats().last_ping for
+     * callers that must not wait.
+     * @param timeout If non-zero, ping over a one-off client that gives up
+     *        after this long instead of a pooled one (e.g. on shutdown)
+     */
+    MongoPingResult ping(chrono::milliseconds timeout = chrono::milliseconds(0));
+
+    MongoConnectionStats getStats() const;
+    const string& getConnectionString() const;
+};
+
+#endif // MONGO_CONNECTION_H
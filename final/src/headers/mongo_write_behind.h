@@ -0,0 +1,134 @@
+#ifndef MONGO_WRITE_BEHIND_H
+#define MONGO_WRITE_BEHIND_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <bsoncxx/document/value.hpp>
+#include <mongocxx/options/insert.hpp>
+#include <mongocxx/write_concern.hpp>
+#include "mongodb_handler.h"
+
+using namespace std;
+
+/**
+ * @brief Batching and durability settings for MongoWriteBehind
+ */
+struct WriteBehindConfig {
+    size_t batch_size = 64;                              // Flush once this many documents wait
+    chrono::milliseconds flush_interval{250};            // ...or once the oldest has waited this long
+    size_t queue_capacity = 1024;                        // Documents buffered at most
+    chrono::milliseconds enqueue_timeout{1000};          // How long enqueue() waits for room
+    string write_concern = "1";                          // "majority", "0" (unacknowledged) or a node count
+    bool journal = false;                                // Wait for the journal before acknowledging
+    chrono::milliseconds write_timeout{5000};            // Server-side write concern timeout
+    
+    /**
+     * @brief Read MONGODB_BATCH_SIZE, MONGODB_FLUSH_MS, MONGODB_QUEUE_CAPACITY,
+     *        MONGODB_WRITE_CONCERN and MONGODB_JOURNAL (missing keys keep the defaults)
+     */
+    static WriteBehindConfig fromEnv(const unordered_map<string, string>& env);
+};
+
+/**
+ * @brief Counters for the write-behind queue
+ */
+struct WriteBehindStats {
+    uint64_t enqueued = 0;                   // Documents accepted
+    uint64_t written = 0;                    // Documents the server acknowledged
+    uint64_t failed = 0;                     // Documents in batches that failed
+    uint64_t rejected = 0;                   // Documents refused because the queue stayed full
+    uint64_t batches = 0;                    // insert_many calls
+    size_t pending = 0;                      // Documents waiting right now
+    double average_batch = 0.0;              // Documents per insert_many
+    double average_flush_ms = 0.0;           // insert_many latency
+    double max_flush_ms = 0.0;
+    double documents_per_second = 0.0;       // written over the time since the first document
+};
+
+/**
+ * @brief Buffers documents and writes them to MongoDB in batches
+ *
+ * Callers hand over finished documents and return immediately. A
+ * background thread sends them with one unordered insert_many whenever
+ * batch_size documents are waiting or the oldest has waited
+ * flush_interval, so a burst of captures costs one round trip instead of
+ * one per document. The queue is bounded: when it is full, enqueue()
+ * waits up to enqueue_timeout for the writer and then refuses the
+ * document. Everything still queued is sent by flush() and stop().
+ */
+class MongoWriteBehind {
+private:
+    MongoDBHandler& database;                // Collection the documents go to
+    WriteBehindConfig config;
+    mongocxx::options::insert insert_options; // Unordered, with the configured write concern
+    
+    struct PendingDocument {
+        bsoncxx::document::value document;
+        chrono::steady_clock::time_point queued_at;
+    };
+    
+    deque<PendingDocument> queue;            // Documents waiting to be written
+    vector<bsoncxx::document::value> batch;  // Documents being written (writer thread only)
+    mutable mutex lock;
+    condition_variable wake_writer;          // New documents, flush request or stop
+    condition_variable room_or_flushed;      // Space freed or a flush finished
+    uint64_t attempted;                      // Documents the writer has sent (written or failed)
+    uint64_t flush_through;                  // Documents a flush() is waiting to see attempted
+    bool writing;                            // A batch is in flight
+    bool stopping;
+    thread writer;
+    
+    // Statistics (guarded by lock)
+    WriteBehindStats stats;
+    double total_flush_ms;
+    chrono::steady_clock::time_point first_enqueue;
+    chrono::steady_clock::time_point last_write;
+
+public:
+    MongoWriteBehind(MongoDBHandler& database, const WriteBehindConfig& config = WriteBehindConfig());
+    ~MongoWriteBehind();
+    
+    MongoWriteBehind(const MongoWriteBehind&) = delete;
+    MongoWriteBehind& operator=(const MongoWriteBehind&) = delete;
+    
+    /**
+     * @brief Queue a document for the next batch
+     * @return false if the queue stayed full for enqueue_timeout (the document is dropped)
+     */
+    bool enqueue(bsoncxx::document::value document);
+    
+    /**
+     * @brief Send everything queued so far and wait for it, at most timeout
+     *
+     * Documents queued after the call do not hold it up, and a batch that
+     * fails counts as done (it is reported in the stats, not retried).
+     * @return false if the timeout ran out first
+     */
+    bool flush(chrono::milliseconds timeout);
+    
+    /**
+     * @brief Flush and stop the writer thread (called by the destructor)
+     */
+    void stop();
+    
+    WriteBehindStats getStats() const;
+    const WriteBehindConfig& getConfig() const;
+    
+    /**
+     * @brief The configured write concern as a mongocxx object
+     */
+    static mongocxx::write_concern makeWriteConcern(const WriteBehindConfig& config);
+
+private:
+    void writeLoop();
+};
+
+#endif // MONGO_WRITE_BEHIND_H
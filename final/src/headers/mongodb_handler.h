@@ -1,58 +1,160 @@
 #ifndef MONGODB_HANDLER_H
 #define MONGODB_HANDLER_H
 
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
-#include <mongocxx/client.hpp>
-#include <mongocxx/database.hpp>
 #include <mongocxx/collection.hpp>
+#include <mongocxx/options/insert.hpp>
+#include <bsoncxx/document/value.hpp>
+#include "face_geometry_codec.h"
+#include "capture_spool.h"
 #include "face_types.h"
+#include "mongo_connection.h"
 
 using namespace std;
 using namespace mongocxx;
 
 /**
  * @brief Handles all MongoDB operations for the face mesh app
+ *
+ * A mongocxx client may only be used by one thread at a time, so every
+ * operation checks a client out of the shared MongoConnection pool and
+ * returns it when done. The UI, the photo writer and the write-behind
+ * thread can call into one handler at the same time.
  */
 class MongoDBHandler {
 private:
-    client db_client;           // MongoDB client instance
-    database db;                // Face mesh database
-    collection face_collection; // Face analysis collection
+    unique_ptr<MongoConnection> owned_connection; // Set when built from a connection string
+    MongoConnection& connection;    // Pool the clients come from
+    string database_name;           // Face mesh database
+    string collection_name;         // Face analysis collection
+    FaceDocumentFormat face_format; // How landmarks and mesh are stored
+    CaptureSpool* spool;            // Local spool captures go to first (optional)
     
 public:
     /**
-     * @brief Constructor - connects to MongoDB
+     * @brief Constructor - uses clients from a shared connection (nothing is connected here)
+     * @param connection Pool shared with the rest of the app; must outlive the handler
+     * @param database_name Database holding the captures
+     * @param collection_name Collection holding the captures
+     */
+    explicit MongoDBHandler(MongoConnection& connection,
+                            const string& database_name = "facemesh_app",
+                            const string& collection_name = "face_analysis");
+    
+    /**
+     * @brief Constructor - with a connection of its own
      * @param connection_string MongoDB connection string
+     * @param database_name Database holding the captures
+     * @param collection_name Collection holding the captures
      */
-    explicit MongoDBHandler(const string& connection_string);
+    explicit MongoDBHandler(const string& connection_string,
+                            const string& database_name = "facemesh_app",
+                            const string& collection_name = "face_analysis");
     
     /**
-     * @brief Test the MongoDB connection
+     * @brief Test the MongoDB connection with a ping
+     * @param timeout If non-zero, give up after this long (see MongoConnection::ping)
      * @return true if connection is working
      */
-    bool testConnection();
+    bool testConnection(chrono::milliseconds timeout = chrono::milliseconds(0));
+    
+    MongoConnection& getConnection();
+    
+    /**
+     * @brief Write captures to a local spool first (a SpoolReplayer sends them on)
+     * @param spool Open spool, or nullptr to write to MongoDB directly; must outlive the handler
+     */
+    void attachSpool(CaptureSpool* spool);
+    bool hasSpool() const;
     
     /**
-     * @brief Save face analysis data to MongoDB
+     * @brief Append a built capture document to the attached spool
+     * @return false if no spool is attached or the append failed
+     */
+    bool spoolFaceDocument(bsoncxx::document::view document);
+    
+    /**
+     * @brief Save face analysis data (to the spool if one is attached, else MongoDB)
      * @param faces Vector of detected faces
      * @param filename Name of the captured image file
      * @param pokemon_name Name of the selected Pokémon
      * @param mask_file Name of the mask file used
-     * @return true if save was successful
+     * @return true if the data was stored in MongoDB or the spool
      */
-    bool saveFaceData(const vector<DetectedFace>& faces, 
+    bool saveFaceData(const FaceList& faces, 
                       const string& filename,
                       const string& pokemon_name,
                       const string& mask_file);
     
     /**
-     * @brief Display all saved face capture data
+     * @brief Build the document saveFaceData would insert, without inserting it
+     *
+     * Landmarks and mesh are written in the handler's face format; the
+     * document's "face_format" field says which one.
+     */
+    bsoncxx::document::value buildFaceDocument(const FaceList& faces,
+                                               const string& filename,
+                                               const string& pokemon_name,
+                                               const string& mask_file);
+    
+    /**
+     * @brief Read a stored face's landmarks and mesh back (either face format)
+     * @param face_document One entry of a capture's "faces" array
+     * @param face Receives landmarks, face_mesh and has_landmarks
+     * @return false if the geometry is missing or malformed
+     */
+    static bool readFaceGeometry(bsoncxx::document::view face_document, DetectedFace& face);
+    
+    /**
+     * @brief Choose how landmarks and mesh are stored in new documents
+     *        (set before documents are built on other threads)
+     */
+    void setFaceFormat(FaceDocumentFormat format);
+    FaceDocumentFormat getFaceFormat() const;
+    
+    /**
+     * @brief Insert several documents with one round trip
+     * @param documents Documents to insert
+     * @param options Ordering and write concern
+     * @param inserted Set to the number of documents written (all of them
+     *        for an unacknowledged write that raised no error); documents
+     *        whose _id is already stored count as written
+     * @param rejected If given, receives the indexes of documents the server
+     *        refused outright (validation, size limit, ...). Retrying those
+     *        cannot succeed; a failure with none listed (no server, network,
+     *        write concern) can.
+     * @return false if the server reported an error other than duplicate _ids
      */
-    void showFaceDatabase();
+    bool insertMany(const vector<bsoncxx::document::value>& documents,
+                    const mongocxx::options::insert& options,
+                    size_t& inserted,
+                    vector<size_t>* rejected = nullptr);
     
     /**
-     * @brief Get statistics about saved data
+     * @brief Drop the capture collection (used by the benchmarks on their scratch collection)
+     * @return true if the collection was dropped
+     */
+    bool dropCollection();
+    
+    /**
+     * @brief Create the capture_time and pokemon_name indexes (no-op if they exist)
+     * @return true if the indexes are in place
+     */
+    bool createIndexes();
+    
+    /**
+     * @brief Display one page of saved captures, newest first
+     * @param page Zero-based page number
+     * @param page_size Captures per page
+     * @return Number of captures shown (fewer than page_size on the last page)
+     */
+    int showFaceDatabase(int page = 0, int page_size = 10);
+    
+    /**
+     * @brief Get statistics about saved data (aggregated on the server)
      * @return pair<total_captures, total_faces>
      */
     pair<int, int> getStatistics();
@@ -64,7 +166,10 @@ public:
     string getCurrentTimestamp();
     
 private:
-    // Removed getCurrentTimestamp from private section since it's now public
+    /**
+     * @brief The capture collection, on a client checked out by the caller
+     */
+    mongocxx::collection captures(MongoConnection::Client& client);
 };
 
 #endif // MONGODB_HANDLER_H
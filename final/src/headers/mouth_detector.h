@@ -0,0 +1,73 @@
+#ifndef MOUTH_DETECTOR_H
+#define MOUTH_DETECTOR_H
+
+#include <opencv2/opencv.hpp>
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Per-face mouth state carried from frame to frame
+ */
+struct MouthState {
+    bool open = false;               // Reported (debounced) state
+    int pending_frames = 0;          // Frames in a row the raw state disagreed with open
+    float dark_ratio = 0.0f;         // Last measured share of dark samples
+    float very_dark_ratio = 0.0f;    // Last measured share of very dark samples
+};
+
+/**
+ * @brief Decides whether a mouth is open from an integral image of the frame
+ *
+ * The cheek brightness is a single box query. The mouth strip is sampled
+ * every other row like before, but each sample is a 3x3 box mean (also a
+ * box query), which replaces the GaussianBlur over the whole face. The
+ * integral is computed once per frame and shared by all faces.
+ *
+ * The open/closed decision has hysteresis: an open mouth stays open at
+ * lower dark ratios than it takes to open it, and a new state must hold for
+ * confirm_frames frames before it is reported.
+ */
+class MouthDetector {
+private:
+    // Tuning
+    float threshold_scale;       // Dark = below this fraction of cheek brightness
+    float very_dark_scale;       // Very dark = below this fraction of the dark threshold
+    float open_very_dark;        // Very dark ratio that opens the mouth on its own
+    float open_dark;             // Dark ratio that opens it together with open_very_dark_min
+    float open_very_dark_min;    // Very dark ratio required alongside open_dark
+    float hold_factor;           // Open mouths stay open down to this fraction of the thresholds
+    int confirm_frames;          // Frames a changed state must persist
+
+public:
+    MouthDetector();
+    
+    /**
+     * @brief Measure the dark sample ratios in a face's mouth strip
+     * @param sum Integral image (CV_32S) of the grayscale frame
+     * @param face_rect Face rectangle in frame coordinates
+     * @return false if the face is too small or the cheek is outside the frame
+     */
+    bool measure(const Mat& sum, const Rect& face_rect, float& dark_ratio, float& very_dark_ratio) const;
+    
+    /**
+     * @brief Measure a face and advance its debounced state
+     * @return The reported state (state.open)
+     */
+    bool update(const Mat& sum, const Rect& face_rect, MouthState& state) const;
+    
+    void setConfirmFrames(int frames);
+
+private:
+    /**
+     * @brief Raw decision for one frame, with lower thresholds while open
+     */
+    bool looksOpen(float dark_ratio, float very_dark_ratio, bool currently_open) const;
+    
+    /**
+     * @brief Sum of the pixels in r (r must lie inside the integral's image)
+     */
+    static int boxSum(const Mat& sum, const Rect& r);
+};
+
+#endif // MOUTH_DETECTOR_H
@@ -0,0 +1,66 @@
+#ifndef PARTICLE_ATLAS_H
+#define PARTICLE_ATLAS_H
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <vector>
+#include "blend_kernels.h"
+#include "particle_kinds.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Pre-rasterized particle sprites, stamped onto frames in one pass
+ *
+ * Every stamped kind is drawn once per size and variant with its regular
+ * draw function onto a small canvas, and the covered pixels become an
+ * opaque premultiplied BGRA sprite with its opaque spans. Drawing a buffer
+ * then blends one sprite per particle through the clipped SIMD kernel
+ * instead of issuing several OpenCV primitives.
+ */
+class ParticleAtlas {
+public:
+    /**
+     * @brief One pre-rasterized particle
+     */
+    struct Sprite {
+        Mat pixels;                  // Premultiplied BGRA canvas
+        vector<OpaqueSpan> spans;    // Covered runs of pixels
+        Point center;                // Canvas position of the particle center
+    };
+    
+private:
+    vector<vector<Sprite>> kind_sprites;   // [kind][(size - min_size) * variants + variant]
+    
+public:
+    ParticleAtlas();
+    
+    /**
+     * @brief Atlas shared by all particle systems (built on first use)
+     */
+    static const ParticleAtlas& shared();
+    
+    /**
+     * @brief Number of sprites in the atlas
+     */
+    size_t getSpriteCount() const;
+    
+    /**
+     * @brief Stamp every live particle of a stamped kind onto image
+     */
+    template <typename Traits>
+    void stamp(const ParticleBuffer& buffer, Mat& image) const {
+        const vector<Sprite>& sprites = kind_sprites[static_cast<int>(Traits::kind)];
+        for (size_t i = 0; i < buffer.count; i++) {
+            if (buffer.life[i] <= 0.0f) continue;
+            int size = min(Traits::max_size, max(Traits::min_size, static_cast<int>(buffer.size[i])));
+            const Sprite& sprite = sprites[(size - Traits::min_size) * Traits::variants + Traits::variant(buffer, i)];
+            
+            Point origin(cvRound(buffer.pos_x[i]) - sprite.center.x, cvRound(buffer.pos_y[i]) - sprite.center.y);
+            BlendKernels::blendPremultiplied(image, sprite.pixels, origin, &sprite.spans);
+        }
+    }
+};
+
+#endif // PARTICLE_ATLAS_H
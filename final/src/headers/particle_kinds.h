@@ -0,0 +1,157 @@
+#ifndef PARTICLE_KINDS_H
+#define PARTICLE_KINDS_H
+
+#include "particle_system.h"
+
+/**
+ * @brief Compile-time description of one particle kind
+ *
+ * Every kind specializes this with its name, physics constants and
+ * spawn/draw functions. To add a kind: add a ParticleKind value, write its
+ * spawn/draw functions, specialize ParticleTraits and append the kind to
+ * RegisteredParticleKinds.
+ *
+ * Kinds with stamped = true are drawn from ParticleAtlas sprites: one per
+ * integer size in [min_size, max_size] and variant (color or angle bucket).
+ */
+template <ParticleKind K>
+struct ParticleTraits;
+
+template <>
+struct ParticleTraits<ParticleKind::Water> {
+    static constexpr ParticleKind kind = ParticleKind::Water;
+    static constexpr const char* name = "water";
+    static constexpr float gravity = 0.7f;
+    static constexpr float decay = 0.015f;
+    static constexpr float spin = 0.0f;
+    static constexpr int emit_frequency = 4;
+    static constexpr bool has_path = false;
+    static void spawn(ParticleBuffer& buffer, int index, ParticleRandom& random) { Particles::spawnWater(buffer, index, random); }
+    static void draw(const ParticleBuffer& buffer, Mat& image) { Particles::drawWater(buffer, image); }
+    static constexpr bool stamped = true;
+    static constexpr int min_size = 5;
+    static constexpr int max_size = 8;
+    static constexpr int variants = 11;
+    static int variant(const ParticleBuffer& buffer, size_t index) { return Particles::waterVariant(buffer, index); }
+    static void setVariant(ParticleBuffer& buffer, int index, int v) { Particles::setWaterVariant(buffer, index, v); }
+};
+
+template <>
+struct ParticleTraits<ParticleKind::Coin> {
+    static constexpr ParticleKind kind = ParticleKind::Coin;
+    static constexpr const char* name = "coin";
+    static constexpr float gravity = 0.5f;
+    static constexpr float decay = 0.012f;
+    static constexpr float spin = 0.2f;
+    static constexpr int emit_frequency = 4;
+    static constexpr bool has_path = false;
+    static void spawn(ParticleBuffer& buffer, int index, ParticleRandom& random) { Particles::spawnCoin(buffer, index, random); }
+    static void draw(const ParticleBuffer& buffer, Mat& image) { Particles::drawCoin(buffer, image); }
+    static constexpr bool stamped = true;
+    static constexpr int min_size = 6;
+    static constexpr int max_size = 8;
+    static constexpr int variants = 16;
+    static int variant(const ParticleBuffer& buffer, size_t index) { return Particles::coinVariant(buffer, index); }
+    static void setVariant(ParticleBuffer& buffer, int index, int v) { Particles::setCoinVariant(buffer, index, v); }
+};
+
+template <>
+struct ParticleTraits<ParticleKind::Gem> {
+    static constexpr ParticleKind kind = ParticleKind::Gem;
+    static constexpr const char* name = "gem";
+    static constexpr float gravity = 0.4f;
+    static constexpr float decay = 0.010f;
+    static constexpr float spin = 0.0f;
+    static constexpr int emit_frequency = 4;
+    static constexpr bool has_path = false;
+    static void spawn(ParticleBuffer& buffer, int index, ParticleRandom& random) { Particles::spawnGem(buffer, index, random); }
+    static void draw(const ParticleBuffer& buffer, Mat& image) { Particles::drawGem(buffer, image); }
+    static constexpr bool stamped = true;
+    static constexpr int min_size = 4;
+    static constexpr int max_size = 6;
+    static constexpr int variants = 6;
+    static int variant(const ParticleBuffer& buffer, size_t index) { return Particles::gemVariant(buffer, index); }
+    static void setVariant(ParticleBuffer& buffer, int index, int v) { Particles::setGemVariant(buffer, index, v); }
+};
+
+template <>
+struct ParticleTraits<ParticleKind::Heart> {
+    static constexpr ParticleKind kind = ParticleKind::Heart;
+    static constexpr const char* name = "heart";
+    static constexpr float gravity = 0.3f;
+    static constexpr float decay = 0.008f;     // Longer life
+    static constexpr float spin = 0.0f;
+    static constexpr int emit_frequency = 4;
+    static constexpr bool has_path = false;
+    static void spawn(ParticleBuffer& buffer, int index, ParticleRandom& random) { Particles::spawnHeart(buffer, index, random); }
+    static void draw(const ParticleBuffer& buffer, Mat& image) { Particles::drawHeart(buffer, image); }
+    static constexpr bool stamped = true;
+    static constexpr int min_size = 5;
+    static constexpr int max_size = 7;
+    static constexpr int variants = 1;
+    static int variant(const ParticleBuffer& buffer, size_t index) { return Particles::heartVariant(buffer, index); }
+    static void setVariant(ParticleBuffer& buffer, int index, int v) { Particles::setHeartVariant(buffer, index, v); }
+};
+
+template <>
+struct ParticleTraits<ParticleKind::Lightning> {
+    static constexpr ParticleKind kind = ParticleKind::Lightning;
+    static constexpr const char* name = "lightning";
+    static constexpr float gravity = 0.6f;
+    static constexpr float decay = 0.020f;     // Fast decay
+    static constexpr float spin = 0.0f;
+    static constexpr int emit_frequency = 6;   // Lightning less frequent
+    static constexpr bool has_path = true;
+    static void spawn(ParticleBuffer& buffer, int index, ParticleRandom& random) { Particles::spawnLightning(buffer, index, random); }
+    static void draw(const ParticleBuffer& buffer, Mat& image) { Particles::drawLightning(buffer, image); }
+    static constexpr bool stamped = false;     // Per-particle zigzag, drawn as lines
+};
+
+/**
+ * @brief Ordered list of kinds known to ParticleSystem
+ *
+ * forEach calls f(ParticleTraits<K>{}) for every kind; the calls are
+ * expanded at compile time, so per-kind loops have no runtime dispatch.
+ */
+template <ParticleKind... Kinds>
+struct ParticleKindList {
+    static constexpr int size = sizeof...(Kinds);
+
+    template <typename F>
+    static void forEach(F&& f) {
+        (f(ParticleTraits<Kinds>{}), ...);
+    }
+};
+
+using RegisteredParticleKinds = ParticleKindList<
+    ParticleKind::Water,
+    ParticleKind::Coin,
+    ParticleKind::Gem,
+    ParticleKind::Heart,
+    ParticleKind::Lightning>;
+
+static_assert(RegisteredParticleKinds::size == PARTICLE_KIND_COUNT,
+              "every ParticleKind must be registered");
+
+/**
+ * @brief Runtime view of a kind's traits, resolved once per type change
+ */
+struct ParticleKindOps {
+    ParticleKind kind;
+    const char* name;
+    int emit_frequency;
+    void (*spawn)(ParticleBuffer&, int, ParticleRandom&);
+};
+
+/**
+ * @brief Emission operations for a kind
+ */
+const ParticleKindOps& particleKindOps(ParticleKind kind);
+
+/**
+ * @brief Look up a kind by its name ("water", "coin", ...)
+ * @return false if the name is not registered
+ */
+bool particleKindFromName(const string& name, ParticleKind& kind);
+
+#endif // PARTICLE_KINDS_H
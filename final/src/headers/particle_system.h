@@ -2,123 +2,256 @@
 #define PARTICLE_SYSTEM_H
 
 #include <opencv2/opencv.hpp>
-#include <vector>
+#include <cstdint>
 #include <memory>
+#include <vector>
 #include <string>
 
 using namespace cv;
 using namespace std;
 
 /**
- * @brief Base class for all particle types
+ * @brief The particle behaviors the system can emit
  */
-class BaseParticle {
-public:
-    Point2f position;    // Current position of the particle
-    Point2f velocity;    // Velocity vector (x, y)
-    float life;          // Life value (0.0 to 1.0, 1.0 = just created)
-    float size;          // Size of the particle
-    Scalar color;        // Color of the particle
-
-    virtual ~BaseParticle() = default;
-    
-    /**
-     * @brief Update particle physics (position, velocity, life)
-     */
-    virtual void update() = 0;
-    
-    /**
-     * @brief Draw the particle on the given image
-     * @param image The image to draw on
-     */
-    virtual void draw(Mat& image) = 0;
-    
-    /**
-     * @brief Check if particle is still alive
-     * @return true if particle should continue existing
-     */
-    bool isAlive() const;
+enum class ParticleKind {
+    Water,       // Mudkip water droplets
+    Coin,        // Meowth spinning coins
+    Gem,         // Eevee multicolored gems
+    Heart,       // Sylveon hearts
+    Lightning    // Pikachu lightning bolts
 };
 
+const int PARTICLE_KIND_COUNT = 5;
+const int LIGHTNING_PATH_POINTS = 5;
+
 /**
- * @brief Water droplet particle for Mudkip
+ * @brief Allocation counters for a ParticleSystem
  */
-class WaterParticle : public BaseParticle {
-public:
-    explicit WaterParticle(Point2f start_pos);
-    void update() override;
-    void draw(Mat& image) override;
+struct ParticleAllocatorStats {
+    uint64_t arena_blocks = 0;       // Heap blocks the arena has requested
+    uint64_t arena_bytes = 0;        // Bytes reserved from the heap
+    uint64_t bytes_in_use = 0;       // Bytes handed out to particle buffers
+    uint64_t spawned = 0;            // Particles created
+    uint64_t recycled = 0;           // Dead particle slots returned for reuse
+    uint64_t rejected = 0;           // Spawns dropped because a buffer was full
+    uint64_t peak_live = 0;          // Most particles alive at once
 };
 
 /**
- * @brief Spinning coin particle for Meowth
+ * @brief Small seedable random generator owned by each ParticleSystem
+ *
+ * Replaces the global rand() so every system draws from its own stream:
+ * a given seed always produces the same particles, no matter how many
+ * other systems (or threads) are spawning at the same time. xorshift64*,
+ * seeded through splitmix64 so nearby seeds give unrelated streams.
  */
-class CoinParticle : public BaseParticle {
+class ParticleRandom {
 private:
-    float rotation;      // Current rotation angle
+    uint64_t state;                          // Never zero
     
 public:
-    explicit CoinParticle(Point2f start_pos);
-    void update() override;
-    void draw(Mat& image) override;
+    explicit ParticleRandom(uint64_t seed = 1) { reseed(seed); }
+    
+    void reseed(uint64_t seed) {
+        uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        state = (z ^ (z >> 31)) | 1;
+    }
+    
+    uint32_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return static_cast<uint32_t>((state * 0x2545F4914F6CDD1Dull) >> 32);
+    }
+    
+    /**
+     * @brief Uniform integer in [0, n), the replacement for rand() % n
+     */
+    int below(int n) {
+        return static_cast<int>((static_cast<uint64_t>(next()) * static_cast<uint32_t>(n)) >> 32);
+    }
 };
 
 /**
- * @brief Multicolored gem particle for Eevee
+ * @brief Bump allocator that backs the particle buffers
+ *
+ * Memory is taken from the heap in large blocks and only handed out, never
+ * freed individually; everything is released with the arena. Buffers carve
+ * their arrays out of it the first time a kind is spawned, so steady-state
+ * emission never reaches the heap allocator.
  */
-class GemParticle : public BaseParticle {
+class ParticleArena {
 private:
-    Scalar gem_color;    // Specific gem color
+    vector<unique_ptr<uint8_t[]>> blocks;     // Owned heap blocks
+    uint8_t* block_base;                      // 64-byte aligned start of the newest block
+    size_t block_size;                        // Default block size in bytes
+    size_t block_used;                        // Bytes used in the newest block
+    size_t block_capacity;                    // Usable size of the newest block
+    uint64_t bytes_reserved;                  // Total bytes in all blocks
+    uint64_t bytes_in_use;                    // Total bytes handed out
     
 public:
-    explicit GemParticle(Point2f start_pos);
-    void update() override;
-    void draw(Mat& image) override;
+    explicit ParticleArena(size_t block_size = 1 << 20);
+    
+    /**
+     * @brief Hand out aligned storage (up to 64 bytes) that lives as long as the arena
+     */
+    void* allocate(size_t bytes, size_t alignment = 16);
+    
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T) > 16 ? alignof(T) : 16));
+    }
+    
+    uint64_t getBlockCount() const { return blocks.size(); }
+    uint64_t getBytesReserved() const { return bytes_reserved; }
+    uint64_t getBytesInUse() const { return bytes_in_use; }
 };
 
 /**
- * @brief Heart-shaped particle for Sylveon
+ * @brief Structure-of-arrays storage for the live particles of one kind
+ *
+ * The arrays live in a ParticleArena and are sized to the capacity once;
+ * live particles occupy indices [0, count) and dead ones are removed by
+ * swapping in the last.
  */
-class HeartParticle : public BaseParticle {
-public:
-    explicit HeartParticle(Point2f start_pos);
-    void update() override;
-    void draw(Mat& image) override;
+struct ParticleBuffer {
+    size_t count = 0;                // Live particles
+    size_t capacity = 0;             // Maximum live particles (0 until bound)
+    float* pos_x = nullptr;          // Current positions
+    float* pos_y = nullptr;
+    float* vel_x = nullptr;          // Velocities
+    float* vel_y = nullptr;
+    float* life = nullptr;           // Life value (0.0 to 1.0, 1.0 = just created)
+    float* size = nullptr;           // Particle sizes
+    float* rotation = nullptr;       // Spin angle (coins)
+    Vec3b* color = nullptr;          // BGR colors
+    float* path_dx = nullptr;        // Lightning zigzag x offsets, LIGHTNING_PATH_POINTS per particle
+    
+    /**
+     * @brief Carve the arrays for capacity particles out of an arena
+     */
+    void bind(ParticleArena& arena, size_t capacity);
+    
+    bool isBound() const { return capacity > 0; }
+    
+    /**
+     * @brief Append a particle at pos with life 1.0 and everything else zeroed
+     * @return Index of the new particle, or -1 if the buffer is full
+     */
+    int add(Point2f pos);
+    
+    /**
+     * @brief Advance every particle one frame (gravity, motion, spin, life decay)
+     */
+    void integrate(float gravity, float decay, float spin);
+    
+    /**
+     * @brief Swap-remove all particles whose life reached zero
+     * @return Number of particles removed
+     */
+    size_t removeDead();
+    
+    /**
+     * @brief Remove all particles (storage is kept)
+     */
+    void clear();
 };
 
 /**
- * @brief Lightning bolt particle for Pikachu
+ * @brief Per-kind spawn and draw functions (src/particles/)
+ *
+ * spawn* fills in velocity, size, color and any kind-specific state for
+ * a particle already added to the buffer, drawing from the owning
+ * system's generator; draw* renders the whole buffer with OpenCV
+ * primitives.
+ *
+ * Kinds drawn from the sprite atlas also have *Variant, which maps a
+ * particle to a sprite variant (color/angle bucket), and set*Variant,
+ * which sets up a particle so it draws as that variant.
  */
-class LightningParticle : public BaseParticle {
-private:
-    vector<Point2f> lightning_path;    // Zigzag path points
+namespace Particles {
+    void spawnWater(ParticleBuffer& buffer, int index, ParticleRandom& random);
+    void drawWater(const ParticleBuffer& buffer, Mat& image);
+    int waterVariant(const ParticleBuffer& buffer, size_t index);
+    void setWaterVariant(ParticleBuffer& buffer, int index, int variant);
     
-public:
-    explicit LightningParticle(Point2f start_pos);
-    void update() override;
-    void draw(Mat& image) override;
-};
+    void spawnCoin(ParticleBuffer& buffer, int index, ParticleRandom& random);
+    void drawCoin(const ParticleBuffer& buffer, Mat& image);
+    int coinVariant(const ParticleBuffer& buffer, size_t index);
+    void setCoinVariant(ParticleBuffer& buffer, int index, int variant);
+    
+    void spawnGem(ParticleBuffer& buffer, int index, ParticleRandom& random);
+    void drawGem(const ParticleBuffer& buffer, Mat& image);
+    int gemVariant(const ParticleBuffer& buffer, size_t index);
+    void setGemVariant(ParticleBuffer& buffer, int index, int variant);
+    
+    void spawnHeart(ParticleBuffer& buffer, int index, ParticleRandom& random);
+    void drawHeart(const ParticleBuffer& buffer, Mat& image);
+    int heartVariant(const ParticleBuffer& buffer, size_t index);
+    void setHeartVariant(ParticleBuffer& buffer, int index, int variant);
+    
+    void spawnLightning(ParticleBuffer& buffer, int index, ParticleRandom& random);
+    void drawLightning(const ParticleBuffer& buffer, Mat& image);
+    
+    /**
+     * @brief Screen area covered by all particles in a buffer
+     * @param include_path Also cover the lightning zigzag path
+     */
+    Rect bufferBounds(const ParticleBuffer& buffer, bool include_path);
+}
 
 /**
  * @brief Manages all particles and their emission
  */
 class ParticleSystem {
 private:
-    vector<unique_ptr<BaseParticle>> particles;    // All active particles
+    ParticleArena arena;                           // Backing storage for all buffers
+    vector<ParticleBuffer> buffers;                // One SoA buffer per ParticleKind
+    size_t capacity_per_kind;                      // Buffer size once a kind is first spawned
+    ParticleAllocatorStats allocator_stats;        // Spawn/recycle counters
+    ParticleRandom random;                         // Spawn jitter and per-particle variation
     Point2f emit_position;                         // Where to emit new particles
     bool is_emitting;                              // Whether to emit new particles
     int emission_counter;                          // Frame counter for emission timing
-    string particle_type;                          // Type of particles to emit
+    ParticleKind current_kind;                     // Kind of particles to emit
+    bool batched_drawing;                          // Stamp atlas sprites instead of drawing primitives
     
 public:
-    ParticleSystem();
+    /**
+     * @param capacity_per_kind Maximum live particles of each kind
+     */
+    explicit ParticleSystem(size_t capacity_per_kind = 4096);
+    
+    // Buffers point into the arena, so systems can be moved but not copied
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+    ParticleSystem(ParticleSystem&&) = default;
+    ParticleSystem& operator=(ParticleSystem&&) = default;
     
     /**
      * @brief Set the type of particles to emit
-     * @param type "water", "coin", "gem", "heart", or "lightning"
+     * @param type "water", "coin", "gem", "heart", or "lightning" (unknown names are ignored)
      */
     void setParticleType(const string& type);
     
+    /**
+     * @brief Set the kind of particles to emit
+     */
+    void setParticleKind(ParticleKind kind);
+    
+    /**
+     * @brief Get the kind of particles being emitted
+     */
+    ParticleKind getParticleKind() const;
+    
+    /**
+     * @brief Restart the random stream (same seed, same particles)
+     */
+    void setSeed(uint64_t seed);
+    
     /**
      * @brief Set where new particles should be emitted
      * @param pos Position to emit particles from
@@ -140,12 +273,31 @@ public:
      */
     void update();
     
+    /**
+     * @brief Spawn several particles of the current type at once
+     * @param pos Position to spawn at (jittered like regular emission)
+     * @param count Number of particles (limited by free capacity)
+     * @return Number of particles actually spawned
+     */
+    size_t burst(Point2f pos, size_t count);
+    
     /**
      * @brief Draw all active particles
-     * @param image Image to draw particles on
+     * @param image BGR image to draw particles on
      */
     void draw(Mat& image);
     
+    /**
+     * @brief Choose between atlas sprite stamping (default) and per-particle OpenCV primitives
+     */
+    void setBatchedDrawing(bool enabled);
+    
+    /**
+     * @brief Area covered by all live particles
+     * @return Union of particle bounds (empty if there are none)
+     */
+    Rect getBounds() const;
+    
     /**
      * @brief Clear all particles
      */
@@ -162,6 +314,11 @@ public:
      * @return Current particle type string
      */
     string getParticleType() const;
+    
+    /**
+     * @brief Arena and spawn/recycle counters
+     */
+    ParticleAllocatorStats getAllocatorStats() const;
 };
 
 #endif // PARTICLE_SYSTEM_H
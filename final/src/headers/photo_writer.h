@@ -0,0 +1,109 @@
+#ifndef PHOTO_WRITER_H
+#define PHOTO_WRITER_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include "face_types.h"
+#include "frame_pipeline.h"
+#include "mongo_write_behind.h"
+#include "mongodb_handler.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief One photo waiting to be saved
+ */
+struct PhotoJob {
+    Mat image;                                   // Composed frame (owned by the job)
+    FaceList faces;                              // Faces shown in the frame
+    string filename;                             // JPEG file to write
+    string pokemon_name;                         // Saved with the metadata
+    string mask_file;
+    chrono::steady_clock::time_point queued_at;  // When the UI handed it over
+};
+
+/**
+ * @brief Outcome of a saved photo, reported through the completion callback
+ */
+struct PhotoResult {
+    string filename;
+    size_t faces = 0;
+    bool image_saved = false;                    // JPEG written
+    bool data_queued = false;                    // Metadata in the spool or the MongoDB write-behind queue
+    double encode_ms = 0.0;                      // JPEG encode + write
+    double persist_ms = 0.0;                     // Building and queueing the MongoDB document
+    double total_ms = 0.0;                       // Queued to finished
+};
+
+/**
+ * @brief Saves photo captures on a background thread
+ *
+ * The UI only moves an already-composed frame and its faces into a small
+ * bounded queue; JPEG encoding and building the MongoDB document happen
+ * here, and the document goes to the capture spool (or, without one, the
+ * batched write-behind queue). When the queue is full submit() refuses the
+ * photo instead of blocking, so a burst of captures can never stall the
+ * preview. Each finished photo is reported
+ * to the completion callback, which runs on the writer thread.
+ */
+class PhotoWriter {
+public:
+    using CompletionCallback = function<void(const PhotoResult&)>;
+
+private:
+    MongoDBHandler& database;                    // Builds the metadata documents
+    MongoWriteBehind& writes;                    // Batches the documents into MongoDB (no spool)
+    FrameQueue<PhotoJob> queue;                  // Photos waiting to be written
+    CompletionCallback on_complete;              // Called after each photo
+    thread writer;                               // Encodes and persists photos
+    atomic<bool> running;                        // Cleared by stop()
+    
+    // Statistics
+    StageStats encode_stats;                     // JPEG encode + write
+    StageStats persist_stats;                    // Document build + enqueue
+    atomic<uint64_t> completed;                  // Photos finished (saved or failed)
+    atomic<uint64_t> rejected;                   // Photos refused because the queue was full
+
+public:
+    /**
+     * @param database Builds the photo metadata documents
+     * @param writes Queue the documents are written through when the database has no spool
+     * @param capacity Photos that may wait at once before submit() refuses more
+     * @param on_complete Called on the writer thread after each photo
+     */
+    PhotoWriter(MongoDBHandler& database, MongoWriteBehind& writes, size_t capacity,
+                CompletionCallback on_complete);
+    ~PhotoWriter();
+    
+    PhotoWriter(const PhotoWriter&) = delete;
+    PhotoWriter& operator=(const PhotoWriter&) = delete;
+    
+    /**
+     * @brief Hand a photo to the writer without waiting
+     * @return false if the queue is full (or the writer stopped); the photo is not saved
+     */
+    bool submit(PhotoJob job);
+    
+    /**
+     * @brief Finish every queued photo, then stop the writer thread
+     */
+    void stop();
+    
+    size_t getPending() const;
+    size_t getCapacity() const;
+    uint64_t getCompleted() const;
+    uint64_t getRejected() const;
+    const StageStats& getEncodeStats() const;
+    const StageStats& getPersistStats() const;
+
+private:
+    void writeLoop();
+};
+
+#endif // PHOTO_WRITER_H
@@ -0,0 +1,134 @@
+#ifndef SESSION_RECORDING_H
+#define SESSION_RECORDING_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "frame_pipeline.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Recorded camera session: JPEG frames with their capture times
+ *
+ * File layout (native byte order):
+ *   "FMRC" u32 version i32 width i32 height, then per frame:
+ *   i64 microseconds since the first frame, u32 size, size JPEG bytes
+ *
+ * Timestamps are the capture times, so a replay feeds the smoothing
+ * filters and tracker exactly what the live run saw, however fast or
+ * slow the replay itself runs.
+ */
+namespace SessionRecording {
+    const char FILE_EXTENSION[] = ".fmrec";
+}
+
+/**
+ * @brief Writes captured frames to a recording without blocking capture
+ *
+ * The capture thread only queues a reference to the frame; JPEG encoding
+ * and file writes happen on the recorder's own thread. If encoding falls
+ * behind, the oldest queued frames are dropped (and counted) rather than
+ * stalling the camera.
+ */
+class SessionRecorder {
+private:
+    FrameQueue<FramePacket> queue;           // Frames waiting to be encoded
+    thread writer;                           // Encodes and appends frames
+    atomic<bool> recording;                  // Accepting frames
+    ofstream out;                            // Recording file
+    string path;                             // File being written
+    int jpeg_quality;                        // Encoder quality
+    chrono::steady_clock::time_point first_capture; // Capture time of the first frame
+    bool has_first_capture;                  // first_capture is set
+    
+    // Statistics (written by the writer thread)
+    atomic<uint64_t> frames_written;
+    atomic<uint64_t> bytes_written;
+    StageStats encode;                       // JPEG encode + write per frame
+
+public:
+    explicit SessionRecorder(size_t queue_capacity = 4, int jpeg_quality = 90);
+    ~SessionRecorder();
+    
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+    
+    /**
+     * @brief Start a new recording (stops any current one)
+     * @return false if the file could not be created
+     */
+    bool start(const string& file_path, Size frame_size);
+    
+    /**
+     * @brief Finish writing queued frames and close the file
+     */
+    void stop();
+    
+    bool isRecording() const;
+    
+    /**
+     * @brief Queue a captured frame (cheap: shares the pixels, never copies)
+     *
+     * The frame must not be written to afterwards; the pipeline's captured
+     * frames are read-only, so they can be passed straight in.
+     */
+    void add(const FramePacket& packet);
+    
+    const string& getPath() const;
+    uint64_t getFramesWritten() const;
+    uint64_t getBytesWritten() const;
+    uint64_t getDroppedFrames() const;
+    const StageStats& getEncodeStats() const;
+
+private:
+    void writeLoop();
+};
+
+/**
+ * @brief Reads a recording frame by frame
+ */
+class SessionReader {
+private:
+    ifstream in;
+    Size frame_size;
+    vector<uchar> encoded;                   // Reused compressed frame
+
+public:
+    /**
+     * @return false if the file is missing or not a recording
+     */
+    bool open(const string& path);
+    
+    /**
+     * @brief Next compressed frame, without decoding it
+     * @param data JPEG bytes (reused between calls)
+     * @param time_s Capture time in seconds since the first frame
+     * @return false at the end of the recording
+     */
+    bool readEncoded(vector<uchar>& data, double& time_s);
+    
+    /**
+     * @brief Next frame, decoded into frame (its buffer is reused)
+     */
+    bool read(Mat& frame, double& time_s);
+    
+    /**
+     * @brief Go back to the first frame
+     */
+    void rewind();
+    
+    Size getFrameSize() const;
+    
+    /**
+     * @brief Whether a path names a recording (by extension)
+     */
+    static bool isRecording(const string& path);
+};
+
+#endif // SESSION_RECORDING_H
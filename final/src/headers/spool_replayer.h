@@ -0,0 +1,118 @@
+#ifndef SPOOL_REPLAYER_H
+#define SPOOL_REPLAYER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <bsoncxx/document/value.hpp>
+#include <mongocxx/options/insert.hpp>
+#include "capture_spool.h"
+#include "mongo_write_behind.h"
+#include "mongodb_handler.h"
+
+using namespace std;
+
+/**
+ * @brief Counters for the spool replayer
+ */
+struct SpoolReplayStats {
+    uint64_t replayed = 0;              // Documents MongoDB acknowledged
+    uint64_t rejected = 0;              // Documents MongoDB refused (moved to "<spool>.rejected")
+    uint64_t batches = 0;               // insert_many calls that succeeded
+    uint64_t failed_batches = 0;        // insert_many calls that failed (retried later)
+    uint64_t reconnect_pings = 0;       // Pings sent while MongoDB was unreachable
+    bool online = true;                 // Last contact with MongoDB succeeded
+    bool stalled = false;               // The spool itself failed; replay waits for the next run
+    double average_batch = 0.0;         // Documents per successful insert_many
+    double average_batch_ms = 0.0;      // insert_many latency
+    double max_batch_ms = 0.0;
+    double documents_per_second = 0.0;  // Over the time spent sending
+};
+
+/**
+ * @brief Drains the capture spool into MongoDB in the background
+ *
+ * Wakes every sync_interval (or on flush()), fsyncs the spool if a sync is
+ * due, and sends unreplayed records with one unordered insert_many per
+ * batch (batch size and write concern from WriteBehindConfig). A batch
+ * only leaves the spool once MongoDB acknowledged it, so a write concern
+ * of "0" is raised to 1 for the replay. When a batch fails,
+ * the replayer goes offline and pings with exponential backoff
+ * (retry_min doubling up to retry_max); the first successful ping resumes
+ * the replay. Captures keep going to the spool the whole time, so the
+ * capture path never waits for the database.
+ *
+ * Only failures that a retry can fix (no server, network, write concern)
+ * keep a batch in the spool. Documents the server refuses are moved to
+ * "<spool>.rejected" and unreadable records to "<spool>.corrupt", so they
+ * never hold up the captures behind them.
+ */
+class SpoolReplayer {
+private:
+    CaptureSpool& spool;
+    MongoDBHandler& database;
+    WriteBehindConfig write_config;          // Batch size and write concern
+    mongocxx::options::insert insert_options;
+    vector<bsoncxx::document::value> batch;  // Documents being sent (replayer thread only)
+    
+    mutable mutex lock;
+    condition_variable wake_replayer;        // flush() or stop()
+    condition_variable flushed;              // A flush request finished
+    uint64_t flush_requests;
+    uint64_t flushes_done;
+    bool stopping;
+    thread replayer;
+    
+    // Connection state and statistics (guarded by lock)
+    SpoolReplayStats stats;
+    chrono::milliseconds retry_delay;
+    chrono::steady_clock::time_point retry_at;
+    double total_batch_ms;
+
+public:
+    SpoolReplayer(CaptureSpool& spool, MongoDBHandler& database,
+                  const WriteBehindConfig& write_config = WriteBehindConfig());
+    ~SpoolReplayer();
+    
+    SpoolReplayer(const SpoolReplayer&) = delete;
+    SpoolReplayer& operator=(const SpoolReplayer&) = delete;
+    
+    /**
+     * @brief Replay everything spooled so far and wait, unless MongoDB is unreachable
+     *
+     * Returns at once while the replayer is offline.
+     * @param timeout Longest wait (a batch sent to a server that just went away can take longer)
+     * @return true if the spool is empty afterwards
+     */
+    bool flush(chrono::milliseconds timeout);
+    
+    /**
+     * @brief Replay what MongoDB will take, sync the spool and stop the thread
+     *
+     * While offline this costs one ping of at most SpoolConfig::final_ping.
+     * Whatever could not be sent stays in the spool for the next run.
+     */
+    void stop();
+    
+    SpoolReplayStats getStats() const;
+
+private:
+    void replayLoop();
+    
+    /**
+     * @brief Send batches until the spool is empty or a batch fails
+     * @return false if MongoDB could not be reached
+     */
+    bool drain();
+    
+    /**
+     * @brief Stop replaying for the rest of the run (the spool cannot be moved past)
+     */
+    void stall(const string& reason);
+};
+
+#endif // SPOOL_REPLAYER_H
@@ -0,0 +1,82 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Fixed set of worker threads for fanning out per-face work
+ *
+ * parallelFor may be called from several threads at once (the detection
+ * worker and the render loop share one pool). The calling thread works on
+ * the range too, so a call always makes progress even when every worker is
+ * busy with another caller's items.
+ *
+ * A call does not allocate: the range lives on the caller's stack, the body
+ * is passed by pointer instead of being wrapped in a std::function, and the
+ * task list only holds pointers to ranges.
+ */
+class ThreadPool {
+private:
+    /**
+     * @brief Progress of one parallelFor call
+     */
+    struct Range {
+        atomic<size_t> next{0};                      // Next unclaimed item
+        size_t count = 0;                            // Items in the range
+        void (*invoke)(const void*, size_t) = nullptr; // Calls the body for one item
+        const void* body = nullptr;                  // The caller's body
+        size_t completed = 0;                        // Items finished (guarded by lock)
+        int running_helpers = 0;                     // Workers inside this range (guarded by lock)
+        condition_variable done;                     // Signalled when the last item finishes
+    };
+    
+    vector<thread> workers;                  // Worker threads
+    vector<Range*> tasks;                    // One entry per helper a range asked for
+    mutex lock;
+    condition_variable work_ready;
+    bool stopping;                           // Set by the destructor
+    
+public:
+    /**
+     * @param threads Worker count (0 = hardware threads - 1, at least 1)
+     */
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    /**
+     * @brief Run body(i) for every i in [0, count) and wait for all of them
+     *
+     * Items may run in any order and on any thread, including the caller's.
+     */
+    template <typename Body>
+    void parallelFor(size_t count, const Body& body) {
+        run(count, [](const void* b, size_t i) { (*static_cast<const Body*>(b))(i); }, &body);
+    }
+    
+    /**
+     * @brief Number of worker threads (not counting callers)
+     */
+    size_t size() const;
+    
+private:
+    void run(size_t count, void (*invoke)(const void*, size_t), const void* body);
+    
+    /**
+     * @brief Claim and run items until none are left
+     * @return Number of items this thread ran
+     */
+    static size_t drain(Range& range);
+    
+    void workerLoop();
+};
+
+#endif // THREAD_POOL_H
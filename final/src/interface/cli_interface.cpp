@@ -1,8 +1,9 @@
 #include "../headers/cli_interface.h"
+#include "../headers/batch_processor.h"
+#include "../headers/particle_kinds.h"
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
-#include <mongocxx/client.hpp>
-#include <mongocxx/instance.hpp>
-#include <mongocxx/uri.hpp>
 
 using namespace std;
 
@@ -76,19 +77,20 @@ namespace CLIInterface {
         }
     }
 
-    bool testMongoDBConnection(const string& connection_string) {
+    bool testMongoDBConnection(MongoConnection& connection) {
         cout << "\n🔌 Testing MongoDB connection..." << endl;
         
-        try {
-            mongocxx::client client{mongocxx::uri{connection_string}};
-            client["test"]["test"].find_one({});
-            cout << "✅ MongoDB connection successful!" << endl;
+        // The pooled client keeps this connection for the app to reuse
+        MongoPingResult ping = connection.ping();
+        if (ping.ok) {
+            cout << "✅ MongoDB connection successful! (" << fixed << setprecision(0)
+                 << ping.round_trip_ms << " ms)" << endl;
+            cout.unsetf(ios::floatfield);
             return true;
-        } catch (const std::exception& e) {
-            cout << "❌ MongoDB connection failed: " << e.what() << endl;
-            cout << "⚠️  The app will continue but photos won't be saved to database." << endl;
-            return false;
         }
+        cout << "❌ MongoDB connection failed: " << ping.error << endl;
+        cout << "⚠️  The app will continue but photos won't be saved to database." << endl;
+        return false;
     }
 
     void displayInstructions() {
@@ -98,12 +100,17 @@ namespace CLIInterface {
         cout << "🎥 REAL CAMERA MODE:" << endl;
         cout << "   SPACE or ENTER - Take photo with mask overlay" << endl;
         cout << "📋 INFO:" << endl;
-        cout << "   'i' or 'I' - Show captured faces database" << endl;
-        cout << "   'S' - Show app statistics" << endl;
+        cout << "   'i' or 'I' - Show captured faces database (10 per press, newest first)" << endl;
+        cout << "   'g' or 'G' - Show app and MongoDB statistics" << endl;
+        cout << "   'p' or 'P' - Show pipeline latency and dropped frames" << endl;
+        cout << "   'v' or 'V' - Start/stop recording the camera for replay" << endl;
         cout << "🎭 MASK CONTROLS:" << endl;
         cout << "   w/s - Move mask up/down" << endl;
         cout << "   a/d - Move mask left/right" << endl;
         cout << "   r - Reset mask position" << endl;
+        cout << "   t - Toggle face tracking between cascade detections" << endl;
+        cout << "   c - Switch cascade search (full-frame / ROI + downscaled)" << endl;
+        cout << "   f - Toggle face smoothing, [ / ] - steadier / more responsive" << endl;
         cout << "😮 MOUTH DETECTION:" << endl;
         cout << "   Open/close mouth to see emoji changes" << endl;
         cout << "❌ EXIT:" << endl;
@@ -117,4 +124,64 @@ namespace CLIInterface {
         cout << "Thanks for playing with " << pokemon_name << "! 🎮" << endl;
     }
 
+    bool parseBatchArguments(int argc, char** argv, BatchConfig& config) {
+        for (int i = 1; i < argc; i++) {
+            string option = argv[i];
+            if (i + 1 >= argc) {
+                cerr << "❌ Missing value for " << option << endl;
+                return false;
+            }
+            string value = argv[++i];
+            
+            if (option == "--batch") {
+                config.input = value;
+            } else if (option == "--output") {
+                config.output = value;
+            } else if (option == "--faces") {
+                config.faces_csv = value;
+            } else if (option == "--mask") {
+                config.mask_file = value == "none" ? "" : value;
+            } else if (option == "--particles") {
+                if (!particleKindFromName(value, config.particle_kind)) {
+                    cerr << "❌ Unknown particle kind: " << value << endl;
+                    return false;
+                }
+            } else if (option == "--detector") {
+                if (value == "dnn") {
+                    config.detector.backend = FaceDetectorBackend::Dnn;
+                } else if (value == "cascade") {
+                    config.detector.backend = FaceDetectorBackend::Cascade;
+                } else {
+                    cerr << "❌ Unknown detector: " << value << endl;
+                    return false;
+                }
+            } else if (option == "--seed") {
+                config.seed = strtoull(value.c_str(), nullptr, 10);
+            } else if (option == "--max-frames") {
+                config.max_frames = static_cast<size_t>(strtoull(value.c_str(), nullptr, 10));
+            } else if (option == "--workers") {
+                config.workers = static_cast<size_t>(strtoull(value.c_str(), nullptr, 10));
+            } else if (option == "--fps") {
+                config.fps = atof(value.c_str());
+            } else {
+                cerr << "❌ Unknown option: " << option << endl;
+                return false;
+            }
+        }
+        
+        return !config.input.empty() && !config.output.empty();
+    }
+
+    void displayBatchUsage(const string& program) {
+        cout << "Usage: " << program << " --batch <video | image directory> --output <video | directory> [options]" << endl;
+        cout << "   --faces <file.csv>       Write every frame's faces" << endl;
+        cout << "   --mask <file | none>     Mask image (default pikachu_mask.png)" << endl;
+        cout << "   --particles <kind>       water, coin, gem, heart or lightning" << endl;
+        cout << "   --detector <backend>     cascade or dnn (default from .env)" << endl;
+        cout << "   --seed <n>               Particle random seed (default 1)" << endl;
+        cout << "   --max-frames <n>         Stop after n frames" << endl;
+        cout << "   --workers <n>            Worker threads (default: all cores)" << endl;
+        cout << "   --fps <f>                Frame rate of image directories" << endl;
+    }
+
 } // namespace CLIInterface
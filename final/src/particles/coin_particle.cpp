@@ -1,29 +1,46 @@
 #include "../headers/particle_system.h"
-#include <cstdlib>
+#include "../headers/particle_kinds.h"
+#include <cmath>
 
-CoinParticle::CoinParticle(Point2f start_pos) {
-    position = start_pos;
-    velocity.x = (rand() % 40 - 20) / 10.0f;    // -2 to 2 horizontal speed
-    velocity.y = (rand() % 20 - 40) / 10.0f;    // -4 to -2 (upward)
-    life = 1.0f;
-    size = 6 + (rand() % 3);  // Size 6-8
-    color = Scalar(0, 215, 255); // Gold color
-    rotation = 0;
+namespace {
+    const Vec3b COIN_COLOR(0, 215, 255);   // Gold color
+    
+    // A coin ellipse repeats every 180 degrees; the atlas keeps one sprite per angle bucket
+    const int COIN_ANGLES = ParticleTraits<ParticleKind::Coin>::variants;
+    const double COIN_ANGLE_STEP = 180.0 / COIN_ANGLES;
 }
 
-void CoinParticle::update() {
-    velocity.y += 0.5f;  // Gravity
-    position.x += velocity.x;
-    position.y += velocity.y;
-    rotation += 0.2f;
-    life -= 0.012f;
-    if (life < 0) life = 0;
-}
-
-void CoinParticle::draw(Mat& image) {
-    if (isAlive()) {
-        // Draw spinning coin as ellipse
-        ellipse(image, position, Size(size, size * 0.7), rotation * 57.3, 0, 360, color, -1);
-        ellipse(image, position, Size(size * 0.6, size * 0.4), rotation * 57.3, 0, 360, Scalar(0, 255, 255), 2);
+namespace Particles {
+    void spawnCoin(ParticleBuffer& buffer, int index, ParticleRandom& random) {
+        buffer.vel_x[index] = (random.below(40) - 20) / 10.0f;    // -2 to 2 horizontal speed
+        buffer.vel_y[index] = (random.below(20) - 40) / 10.0f;    // -4 to -2 (upward)
+        buffer.size[index] = 6 + random.below(3);  // Size 6-8
+        buffer.color[index] = COIN_COLOR;
+        buffer.rotation[index] = 0;
+    }
+    
+    void drawCoin(const ParticleBuffer& buffer, Mat& image) {
+        for (size_t i = 0; i < buffer.count; i++) {
+            if (buffer.life[i] <= 0.0f) continue;
+            Point2f position(buffer.pos_x[i], buffer.pos_y[i]);
+            float size = buffer.size[i];
+            double angle = buffer.rotation[i] * 57.3;
+            Vec3b color = buffer.color[i];
+            
+            // Draw spinning coin as ellipse
+            ellipse(image, position, Size(size, size * 0.7), angle, 0, 360, Scalar(color[0], color[1], color[2]), -1);
+            ellipse(image, position, Size(size * 0.6, size * 0.4), angle, 0, 360, Scalar(0, 255, 255), 2);
+        }
+    }
+    
+    int coinVariant(const ParticleBuffer& buffer, size_t index) {
+        double angle = fmod(buffer.rotation[index] * 57.3, 180.0);
+        if (angle < 0) angle += 180.0;
+        return static_cast<int>(lround(angle / COIN_ANGLE_STEP)) % COIN_ANGLES;
+    }
+    
+    void setCoinVariant(ParticleBuffer& buffer, int index, int variant) {
+        buffer.color[index] = COIN_COLOR;
+        buffer.rotation[index] = static_cast<float>(variant * COIN_ANGLE_STEP / 57.3);
     }
 }
@@ -1,44 +1,58 @@
 #include "../headers/particle_system.h"
-#include <cstdlib>
+#include "../headers/particle_kinds.h"
 
-GemParticle::GemParticle(Point2f start_pos) {
-    position = start_pos;
-    velocity.x = (rand() % 50 - 25) / 10.0f;    // -2.5 to 2.5 horizontal speed
-    velocity.y = (rand() % 30 - 40) / 10.0f;    // -4 to -1 (upward)
-    life = 1.0f;
-    size = 4 + (rand() % 3);  // Size 4-6
-    
+namespace {
     // Random gem colors (multicolored)
-    int color_choice = rand() % 6;
-    switch (color_choice) {
-        case 0: gem_color = Scalar(255, 0, 0); break;     // Red
-        case 1: gem_color = Scalar(0, 255, 0); break;     // Green  
-        case 2: gem_color = Scalar(0, 0, 255); break;     // Blue
-        case 3: gem_color = Scalar(255, 0, 255); break;   // Magenta
-        case 4: gem_color = Scalar(255, 255, 0); break;   // Cyan
-        default: gem_color = Scalar(128, 0, 255); break;  // Purple
-    }
-    color = gem_color;
+    const Vec3b GEM_COLORS[] = {
+        Vec3b(255, 0, 0),      // Red
+        Vec3b(0, 255, 0),      // Green
+        Vec3b(0, 0, 255),      // Blue
+        Vec3b(255, 0, 255),    // Magenta
+        Vec3b(255, 255, 0),    // Cyan
+        Vec3b(128, 0, 255),    // Purple
+    };
+    const int GEM_COLOR_COUNT = sizeof(GEM_COLORS) / sizeof(GEM_COLORS[0]);
+    static_assert(GEM_COLOR_COUNT == ParticleTraits<ParticleKind::Gem>::variants, "one gem sprite per color");
 }
 
-void GemParticle::update() {
-    velocity.y += 0.4f;  // Light gravity
-    position.x += velocity.x;
-    position.y += velocity.y;
-    life -= 0.010f;
-    if (life < 0) life = 0;
-}
-
-void GemParticle::draw(Mat& image) {
-    if (isAlive()) {
-        // Draw gem as diamond shape
-        vector<Point> diamond = {
-            Point(position.x, position.y - size),
-            Point(position.x + size, position.y),
-            Point(position.x, position.y + size),
-            Point(position.x - size, position.y)
-        };
-        fillPoly(image, vector<vector<Point>>{diamond}, color);
-        polylines(image, vector<vector<Point>>{diamond}, true, Scalar(255, 255, 255), 1);
+namespace Particles {
+    void spawnGem(ParticleBuffer& buffer, int index, ParticleRandom& random) {
+        buffer.vel_x[index] = (random.below(50) - 25) / 10.0f;    // -2.5 to 2.5 horizontal speed
+        buffer.vel_y[index] = (random.below(30) - 40) / 10.0f;    // -4 to -1 (upward)
+        buffer.size[index] = 4 + random.below(3);  // Size 4-6
+        buffer.color[index] = GEM_COLORS[random.below(GEM_COLOR_COUNT)];
+    }
+    
+    void drawGem(const ParticleBuffer& buffer, Mat& image) {
+        const int corners = 4;
+        Point diamond[corners];
+        const Point* outline = diamond;
+        
+        for (size_t i = 0; i < buffer.count; i++) {
+            if (buffer.life[i] <= 0.0f) continue;
+            float x = buffer.pos_x[i];
+            float y = buffer.pos_y[i];
+            float size = buffer.size[i];
+            Vec3b color = buffer.color[i];
+            
+            // Draw gem as diamond shape
+            diamond[0] = Point(x, y - size);
+            diamond[1] = Point(x + size, y);
+            diamond[2] = Point(x, y + size);
+            diamond[3] = Point(x - size, y);
+            fillConvexPoly(image, diamond, corners, Scalar(color[0], color[1], color[2]));
+            polylines(image, &outline, &corners, 1, true, Scalar(255, 255, 255), 1);
+        }
+    }
+    
+    int gemVariant(const ParticleBuffer& buffer, size_t index) {
+        for (int c = 0; c < GEM_COLOR_COUNT; c++) {
+            if (buffer.color[index] == GEM_COLORS[c]) return c;
+        }
+        return 0;
+    }
+    
+    void setGemVariant(ParticleBuffer& buffer, int index, int variant) {
+        buffer.color[index] = GEM_COLORS[variant % GEM_COLOR_COUNT];
     }
 }
@@ -1,48 +1,40 @@
 #include "../headers/particle_system.h"
-#include <cstdlib>
 
-LightningParticle::LightningParticle(Point2f start_pos) {
-    position = start_pos;
-    velocity.x = (rand() % 40 - 20) / 10.0f;    // -2 to 2 horizontal speed
-    velocity.y = (rand() % 10 - 30) / 10.0f;    // -3 to -2 (upward)
-    life = 1.0f;
-    size = 3 + (rand() % 2);  // Size 3-4
-    color = Scalar(0, 255, 255); // Yellow color
-    
-    // Generate zigzag lightning path
-    lightning_path.clear();
-    for (int i = 0; i < 5; i++) {
-        Point2f point = start_pos;
-        point.x += (rand() % 20 - 10);
-        point.y += i * 8;
-        lightning_path.push_back(point);
-    }
-}
-
-void LightningParticle::update() {
-    velocity.y += 0.6f;  // Medium gravity
-    position.x += velocity.x;
-    position.y += velocity.y;
-    
-    // Update lightning path
-    for (auto& point : lightning_path) {
-        point.x += velocity.x;
-        point.y += velocity.y;
+namespace Particles {
+    void spawnLightning(ParticleBuffer& buffer, int index, ParticleRandom& random) {
+        buffer.vel_x[index] = (random.below(40) - 20) / 10.0f;    // -2 to 2 horizontal speed
+        buffer.vel_y[index] = (random.below(10) - 30) / 10.0f;    // -3 to -2 (upward)
+        buffer.size[index] = 3 + random.below(2);  // Size 3-4
+        buffer.color[index] = Vec3b(0, 255, 255); // Yellow color
+        
+        // Zigzag path: the points move rigidly with the particle, so only
+        // their x jitter is stored; point i sits 8 * i pixels below it
+        float* path = &buffer.path_dx[index * LIGHTNING_PATH_POINTS];
+        for (int i = 0; i < LIGHTNING_PATH_POINTS; i++) {
+            path[i] = random.below(20) - 10;
+        }
     }
     
-    life -= 0.020f;  // Fast decay
-    if (life < 0) life = 0;
-}
-
-void LightningParticle::draw(Mat& image) {
-    if (isAlive()) {
-        // Draw lightning bolt
-        for (size_t i = 0; i < lightning_path.size() - 1; i++) {
-            line(image, lightning_path[i], lightning_path[i + 1], color, size);
-        }
-        // Add glow effect
-        for (size_t i = 0; i < lightning_path.size() - 1; i++) {
-            line(image, lightning_path[i], lightning_path[i + 1], Scalar(150, 255, 255), 1);
+    void drawLightning(const ParticleBuffer& buffer, Mat& image) {
+        Point2f path[LIGHTNING_PATH_POINTS];
+        
+        for (size_t i = 0; i < buffer.count; i++) {
+            if (buffer.life[i] <= 0.0f) continue;
+            const float* dx = &buffer.path_dx[i * LIGHTNING_PATH_POINTS];
+            for (int p = 0; p < LIGHTNING_PATH_POINTS; p++) {
+                path[p] = Point2f(buffer.pos_x[i] + dx[p], buffer.pos_y[i] + p * 8);
+            }
+            Vec3b color = buffer.color[i];
+            int thickness = static_cast<int>(buffer.size[i]);
+            
+            // Draw lightning bolt
+            for (int p = 0; p < LIGHTNING_PATH_POINTS - 1; p++) {
+                line(image, path[p], path[p + 1], Scalar(color[0], color[1], color[2]), thickness);
+            }
+            // Add glow effect
+            for (int p = 0; p < LIGHTNING_PATH_POINTS - 1; p++) {
+                line(image, path[p], path[p + 1], Scalar(150, 255, 255), 1);
+            }
         }
     }
 }
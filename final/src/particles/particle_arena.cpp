@@ -0,0 +1,30 @@
+#include "../headers/particle_system.h"
+#include <algorithm>
+
+namespace {
+    const size_t BLOCK_ALIGNMENT = 64;
+}
+
+ParticleArena::ParticleArena(size_t block_size)
+    : block_base(nullptr), block_size(block_size), block_used(0), block_capacity(0),
+      bytes_reserved(0), bytes_in_use(0) {
+}
+
+void* ParticleArena::allocate(size_t bytes, size_t alignment) {
+    alignment = min(max<size_t>(alignment, 1), BLOCK_ALIGNMENT);
+    size_t offset = (block_used + alignment - 1) / alignment * alignment;
+    
+    if (block_base == nullptr || offset + bytes > block_capacity) {
+        block_capacity = max(block_size, bytes);
+        blocks.emplace_back(new uint8_t[block_capacity + BLOCK_ALIGNMENT]);
+        bytes_reserved += block_capacity;
+        
+        uintptr_t raw = reinterpret_cast<uintptr_t>(blocks.back().get());
+        block_base = blocks.back().get() + (BLOCK_ALIGNMENT - raw % BLOCK_ALIGNMENT) % BLOCK_ALIGNMENT;
+        offset = 0;
+    }
+    
+    block_used = offset + bytes;
+    bytes_in_use += bytes;
+    return block_base + offset;
+}
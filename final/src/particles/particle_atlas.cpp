@@ -0,0 +1,69 @@
+#include "../headers/particle_atlas.h"
+
+namespace {
+    // Two different backgrounds: a pixel the particle covers has the same color on both
+    const Vec3b BACKGROUND_A(0, 0, 0);
+    const Vec3b BACKGROUND_B(1, 2, 3);
+    
+    ParticleAtlas::Sprite rasterize(const ParticleBuffer& particle, void (*draw)(const ParticleBuffer&, Mat&),
+                                    int canvas_size, Point center) {
+        Mat canvas_a(canvas_size, canvas_size, CV_8UC3, Scalar(BACKGROUND_A[0], BACKGROUND_A[1], BACKGROUND_A[2]));
+        Mat canvas_b(canvas_size, canvas_size, CV_8UC3, Scalar(BACKGROUND_B[0], BACKGROUND_B[1], BACKGROUND_B[2]));
+        draw(particle, canvas_a);
+        draw(particle, canvas_b);
+        
+        ParticleAtlas::Sprite sprite;
+        sprite.center = center;
+        sprite.pixels.create(canvas_size, canvas_size, CV_8UC4);
+        for (int y = 0; y < canvas_size; y++) {
+            const Vec3b* a = canvas_a.ptr<Vec3b>(y);
+            const Vec3b* b = canvas_b.ptr<Vec3b>(y);
+            Vec4b* out = sprite.pixels.ptr<Vec4b>(y);
+            for (int x = 0; x < canvas_size; x++) {
+                out[x] = a[x] == b[x] ? Vec4b(a[x][0], a[x][1], a[x][2], 255) : Vec4b(0, 0, 0, 0);
+            }
+        }
+        BlendKernels::findOpaqueSpans(sprite.pixels, sprite.spans);
+        return sprite;
+    }
+}
+
+ParticleAtlas::ParticleAtlas() : kind_sprites(PARTICLE_KIND_COUNT) {
+    // A one-particle buffer is placed at the canvas center and drawn per size/variant
+    ParticleArena arena(4096);
+    ParticleBuffer particle;
+    particle.bind(arena, 1);
+    
+    RegisteredParticleKinds::forEach([&](auto traits) {
+        using Traits = decltype(traits);
+        if constexpr (Traits::stamped) {
+            // Shapes reach size pixels from the center plus a 2 pixel outline
+            int radius = Traits::max_size + 3;
+            int canvas_size = 2 * radius + 1;
+            vector<Sprite>& sprites = kind_sprites[static_cast<int>(Traits::kind)];
+            
+            for (int size = Traits::min_size; size <= Traits::max_size; size++) {
+                for (int variant = 0; variant < Traits::variants; variant++) {
+                    particle.clear();
+                    int index = particle.add(Point2f(static_cast<float>(radius), static_cast<float>(radius)));
+                    particle.size[index] = static_cast<float>(size);
+                    Traits::setVariant(particle, index, variant);
+                    sprites.push_back(rasterize(particle, Traits::draw, canvas_size, Point(radius, radius)));
+                }
+            }
+        }
+    });
+}
+
+const ParticleAtlas& ParticleAtlas::shared() {
+    static const ParticleAtlas atlas;
+    return atlas;
+}
+
+size_t ParticleAtlas::getSpriteCount() const {
+    size_t total = 0;
+    for (const auto& sprites : kind_sprites) {
+        total += sprites.size();
+    }
+    return total;
+}
@@ -0,0 +1,121 @@
+#include "../headers/particle_system.h"
+#include <algorithm>
+#include <opencv2/core/hal/intrin.hpp>
+
+void ParticleBuffer::bind(ParticleArena& arena, size_t new_capacity) {
+    count = 0;
+    capacity = new_capacity;
+    pos_x = arena.allocateArray<float>(capacity);
+    pos_y = arena.allocateArray<float>(capacity);
+    vel_x = arena.allocateArray<float>(capacity);
+    vel_y = arena.allocateArray<float>(capacity);
+    life = arena.allocateArray<float>(capacity);
+    size = arena.allocateArray<float>(capacity);
+    rotation = arena.allocateArray<float>(capacity);
+    color = arena.allocateArray<Vec3b>(capacity);
+    path_dx = arena.allocateArray<float>(capacity * LIGHTNING_PATH_POINTS);
+}
+
+int ParticleBuffer::add(Point2f pos) {
+    if (count >= capacity) return -1;
+    size_t i = count++;
+    pos_x[i] = pos.x;
+    pos_y[i] = pos.y;
+    vel_x[i] = 0.0f;
+    vel_y[i] = 0.0f;
+    life[i] = 1.0f;
+    size[i] = 1.0f;
+    rotation[i] = 0.0f;
+    color[i] = Vec3b(255, 255, 255);
+    return static_cast<int>(i);
+}
+
+void ParticleBuffer::integrate(float gravity, float decay, float spin) {
+    float* px = pos_x;
+    float* py = pos_y;
+    const float* vx = vel_x;
+    float* vy = vel_y;
+    float* l = life;
+    float* r = rotation;
+    size_t n = count;
+    size_t i = 0;
+    
+#if CV_SIMD128
+    const v_float32x4 g = v_setall_f32(gravity);
+    const v_float32x4 d = v_setall_f32(decay);
+    const v_float32x4 s = v_setall_f32(spin);
+    const v_float32x4 zero = v_setall_f32(0.0f);
+    for (; i + v_float32x4::nlanes <= n; i += v_float32x4::nlanes) {
+        v_float32x4 new_vy = v_add(v_load(vy + i), g);
+        v_store(vy + i, new_vy);
+        v_store(px + i, v_add(v_load(px + i), v_load(vx + i)));
+        v_store(py + i, v_add(v_load(py + i), new_vy));
+        v_store(r + i, v_add(v_load(r + i), s));
+        v_store(l + i, v_max(v_sub(v_load(l + i), d), zero));
+    }
+#endif
+    
+    for (; i < n; i++) {
+        vy[i] += gravity;
+        px[i] += vx[i];
+        py[i] += vy[i];
+        r[i] += spin;
+        l[i] = max(0.0f, l[i] - decay);
+    }
+}
+
+size_t ParticleBuffer::removeDead() {
+    size_t removed = 0;
+    size_t i = 0;
+    while (i < count) {
+        if (life[i] > 0.0f) {
+            i++;
+            continue;
+        }
+        // Move the last live particle into the hole; order is not preserved
+        size_t last = --count;
+        removed++;
+        pos_x[i] = pos_x[last];
+        pos_y[i] = pos_y[last];
+        vel_x[i] = vel_x[last];
+        vel_y[i] = vel_y[last];
+        life[i] = life[last];
+        size[i] = size[last];
+        rotation[i] = rotation[last];
+        color[i] = color[last];
+        copy_n(path_dx + last * LIGHTNING_PATH_POINTS, LIGHTNING_PATH_POINTS,
+               path_dx + i * LIGHTNING_PATH_POINTS);
+    }
+    return removed;
+}
+
+void ParticleBuffer::clear() {
+    count = 0;
+}
+
+namespace Particles {
+    Rect bufferBounds(const ParticleBuffer& buffer, bool include_path) {
+        Rect area;
+        for (size_t i = 0; i < buffer.count; i++) {
+            if (buffer.life[i] <= 0.0f) continue;
+            
+            // Shapes are drawn up to size pixels from the center plus an outline
+            int x = static_cast<int>(buffer.pos_x[i]);
+            int y = static_cast<int>(buffer.pos_y[i]);
+            int radius = static_cast<int>(buffer.size[i]) + 3;
+            Rect particle_area(x - radius, y - radius, 2 * radius + 1, 2 * radius + 1);
+            
+            if (include_path) {
+                int pad = static_cast<int>(buffer.size[i]) + 1;
+                const float* dx = &buffer.path_dx[i * LIGHTNING_PATH_POINTS];
+                for (int p = 0; p < LIGHTNING_PATH_POINTS; p++) {
+                    particle_area |= Rect(static_cast<int>(buffer.pos_x[i] + dx[p]) - pad,
+                                          static_cast<int>(buffer.pos_y[i] + p * 8) - pad,
+                                          2 * pad + 1, 2 * pad + 1);
+                }
+            }
+            area = area.empty() ? particle_area : (area | particle_area);
+        }
+        return area;
+    }
+}
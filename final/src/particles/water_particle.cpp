@@ -1,28 +1,41 @@
 #include "../headers/particle_system.h"
-#include <cstdlib>
+#include "../headers/particle_kinds.h"
+#include <algorithm>
 
-WaterParticle::WaterParticle(Point2f start_pos) {
-    position = start_pos;
-    velocity.x = (rand() % 60 - 30) / 10.0f;    // -3 to 3 horizontal speed
-    velocity.y = (rand() % 20 - 30) / 10.0f;    // -3 to -1 (slight upward)
-    life = 1.0f;
-    size = 5 + (rand() % 4);  // Size 5-8
-    color = Scalar(255, 150 + rand() % 50, 0); // Blue variations
+namespace {
+    // Droplet color is 150 + life * 50 in green; the atlas keeps one sprite per 5 steps
+    const int WATER_COLOR_STEP = 5;
+    const int WATER_VARIANTS = ParticleTraits<ParticleKind::Water>::variants;
+    static_assert(WATER_VARIANTS == 50 / WATER_COLOR_STEP + 1, "one water sprite per color step");
 }
 
-void WaterParticle::update() {
-    velocity.y += 0.7f;  // Gravity
-    position.x += velocity.x;
-    position.y += velocity.y;
-    life -= 0.015f;
-    if (life < 0) life = 0;
-    color = Scalar(255, 150 + (int)(life * 50), 0);
-}
-
-void WaterParticle::draw(Mat& image) {
-    if (isAlive()) {
-        circle(image, position, size, color, -1);
-        circle(image, Point(position.x - 1, position.y - 1), 
-               max(1, (int)(size * 0.5)), Scalar(255, 255, 200), -1);
+namespace Particles {
+    void spawnWater(ParticleBuffer& buffer, int index, ParticleRandom& random) {
+        buffer.vel_x[index] = (random.below(60) - 30) / 10.0f;    // -3 to 3 horizontal speed
+        buffer.vel_y[index] = (random.below(20) - 30) / 10.0f;    // -3 to -1 (slight upward)
+        buffer.size[index] = 5 + random.below(4);  // Size 5-8
+        buffer.color[index] = Vec3b(255, static_cast<uchar>(150 + random.below(50)), 0); // Blue variations
+    }
+    
+    void drawWater(const ParticleBuffer& buffer, Mat& image) {
+        for (size_t i = 0; i < buffer.count; i++) {
+            if (buffer.life[i] <= 0.0f) continue;
+            Point2f position(buffer.pos_x[i], buffer.pos_y[i]);
+            float size = buffer.size[i];
+            
+            // Droplets fade from light to deep blue as they age
+            Scalar color(255, 150 + (int)(buffer.life[i] * 50), 0);
+            circle(image, position, size, color, -1);
+            circle(image, Point(position.x - 1, position.y - 1), 
+                   max(1, (int)(size * 0.5)), Scalar(255, 255, 200), -1);
+        }
+    }
+    
+    int waterVariant(const ParticleBuffer& buffer, size_t index) {
+        return min(WATER_VARIANTS - 1, (int)(buffer.life[index] * 50) / WATER_COLOR_STEP);
+    }
+    
+    void setWaterVariant(ParticleBuffer& buffer, int index, int variant) {
+        buffer.life[index] = (variant * WATER_COLOR_STEP + 0.5f) / 50.0f;
     }
 }
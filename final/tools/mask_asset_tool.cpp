@@ -0,0 +1,60 @@
+/**
+ * @file mask_asset_tool.cpp
+ * @brief Offline mask preprocessing into the binary asset cache
+ *
+ * Usage: mask_asset_tool [images dir] [output file]
+ *
+ * Converts every *_mask.png in the images directory into a premultiplied,
+ * cropped sprite with its opaque spans and writes them all to one cache
+ * file (default images/mask_assets.bin) that the app reads at startup.
+ */
+
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include "../src/headers/mask_asset.h"
+
+int main(int argc, char** argv) {
+    string images_dir = argc > 1 ? argv[1] : "images";
+    string output = argc > 2 ? argv[2] : images_dir + "/mask_assets.bin";
+    
+    vector<string> files;
+    glob(images_dir + "/*_mask.png", files, false);
+    if (files.empty()) {
+        cerr << "❌ No *_mask.png files found in " << images_dir << endl;
+        return 1;
+    }
+    
+    vector<MaskAsset> assets;
+    size_t source_pixels = 0, opaque_pixels = 0;
+    for (const auto& file : files) {
+        Mat mask = imread(file, IMREAD_UNCHANGED);
+        if (mask.empty()) {
+            cerr << "⚠️  Could not read " << file << endl;
+            continue;
+        }
+        
+        string name = file.substr(file.find_last_of("/\\") + 1);
+        MaskAsset asset = MaskAssets::prepare(mask, name);
+        MaskAssets::stampSource(file, asset);   // The app rebuilds from the PNG once it changes
+        
+        size_t covered = 0;
+        for (const auto& span : asset.spans) covered += span.x_end - span.x_begin;
+        source_pixels += mask.total();
+        opaque_pixels += covered;
+        
+        cout << "🎭 " << name << ": " << mask.cols << "x" << mask.rows
+             << " -> bounds " << asset.bounds.width << "x" << asset.bounds.height
+             << ", " << asset.spans.size() << " spans, "
+             << covered * 100 / max<size_t>(1, mask.total()) << "% opaque" << endl;
+        assets.push_back(std::move(asset));
+    }
+    
+    if (!MaskAssets::saveCache(output, assets)) {
+        cerr << "❌ Failed to write " << output << endl;
+        return 1;
+    }
+    
+    cout << "✅ Wrote " << assets.size() << " masks to " << output
+         << " (" << opaque_pixels << " of " << source_pixels << " pixels blended)" << endl;
+    return 0;
+}